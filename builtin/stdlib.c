@@ -23,48 +23,21 @@
 #undef isprint
 #undef tolower
 
-/* Context for snprintf() */
-struct snprintf_context {
-	char *str;
-	int size;
-};
-
-/**
- * Add a character to the string context.
- *
- * @param context	Context receiving character
- * @param c		Character to add
- * @return 0 if character added, 1 if character dropped because no space.
- */
-static int snprintf_addchar(void *context, int c)
-{
-	struct snprintf_context *ctx = (struct snprintf_context *)context;
-
-	if (!ctx->size)
-		return 1;
-
-	*(ctx->str++) = c;
-	ctx->size--;
-	return 0;
-}
-
 int crec_vsnprintf(char *str, size_t size, const char *format, va_list args)
 {
-	struct snprintf_context ctx;
+	char *end = str;
 	int rv;
 
 	if (!str || !format || size <= 0)
 		return -EC_ERROR_INVAL;
 
-	ctx.str = str;
-	ctx.size = size - 1; /* Reserve space for terminating '\0' */
-
-	rv = vfnprintf(snprintf_addchar, &ctx, format, args);
+	size--; /* Reserve space for terminating '\0' */
+	rv = vfnprintf_buf(&end, &size, format, args);
 
 	/* Terminate string */
-	*ctx.str = '\0';
+	*end = '\0';
 
-	return (rv == EC_SUCCESS) ? (ctx.str - str) : -rv;
+	return (rv == EC_SUCCESS) ? (end - str) : -rv;
 }
 #ifndef CONFIG_ZEPHYR
 int vsnprintf(char *str, size_t size, const char *format, va_list args)
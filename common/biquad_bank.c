@@ -0,0 +1,125 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Bank of fixed point biquad filters */
+
+#include "biquad_bank.h"
+#include "common.h"
+
+#include <stddef.h>
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+
+/* acc + lo(x) * lo(y) + hi(x) * hi(y) */
+static inline int32_t smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+	int32_t r;
+
+	asm("smlad %0, %1, %2, %3" : "=r"(r) : "r"(x), "r"(y), "r"(acc));
+	return r;
+}
+
+static inline int32_t ssat16(int32_t v)
+{
+	int32_t r;
+
+	asm("ssat %0, #16, %1" : "=r"(r) : "r"(v));
+	return r;
+}
+
+#else
+
+static inline int32_t smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+	return acc + (int16_t)x * (int16_t)y +
+	       (int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
+
+static inline int32_t ssat16(int32_t v)
+{
+	if (v > INT16_MAX)
+		return INT16_MAX;
+	if (v < INT16_MIN)
+		return INT16_MIN;
+	return v;
+}
+
+#endif
+
+static inline uint32_t pack(int32_t lo, int32_t hi)
+{
+	return (uint16_t)lo | ((uint32_t)hi << 16);
+}
+
+void biquad_bank_set(struct biquad_bank *bank, int ch,
+		     const struct biquad_coeff *coeff)
+{
+	static const struct biquad_coeff pass = BIQUAD_COEFF_PASS;
+
+	if (ch < 0 || ch >= bank->count)
+		return;
+	if (!coeff)
+		coeff = &pass;
+
+	bank->b0[ch] = coeff->b0;
+	bank->b12[ch] = pack(coeff->b1, coeff->b2);
+	/* Negated so both pairs accumulate; -INT16_MIN doesn't fit. */
+	bank->a12[ch] = pack(ssat16(-coeff->a1), ssat16(-coeff->a2));
+}
+
+void biquad_bank_reset(struct biquad_bank *bank)
+{
+	bank->primed = 0;
+}
+
+void biquad_bank_update(struct biquad_bank *bank, const int *in,
+			uint32_t valid)
+{
+	int32_t x, y, acc;
+	int ch;
+
+	for (ch = 0; ch < bank->count; ch++) {
+		if (!(valid & BIT(ch)))
+			continue;
+
+		x = in[ch];
+		if (x > INT16_MAX >> BIQUAD_IN_SCALE)
+			x = INT16_MAX >> BIQUAD_IN_SCALE;
+		else if (x < INT16_MIN >> BIQUAD_IN_SCALE)
+			x = INT16_MIN >> BIQUAD_IN_SCALE;
+		x *= 1 << BIQUAD_IN_SCALE;
+
+		/* The first sample after a reset is taken as the history. */
+		if (!(bank->primed & BIT(ch))) {
+			bank->x12[ch] = pack(x, x);
+			bank->y12[ch] = pack(x, x);
+			bank->err[ch] = 0;
+			bank->primed |= BIT(ch);
+			continue;
+		}
+
+		acc = bank->b0[ch] * x + bank->err[ch];
+		acc = smlad(bank->b12[ch], bank->x12[ch], acc);
+		acc = smlad(bank->a12[ch], bank->y12[ch], acc);
+		y = ssat16(acc >> BIQUAD_Q);
+		bank->err[ch] = acc & ((1 << BIQUAD_Q) - 1);
+
+		/* Shift the delay lines: the old n-1 becomes n-2. */
+		bank->x12[ch] = pack(x, bank->x12[ch]);
+		bank->y12[ch] = pack(y, bank->y12[ch]);
+	}
+}
+
+int biquad_bank_get_scaled(const struct biquad_bank *bank, int ch)
+{
+	if (ch < 0 || ch >= bank->count)
+		return 0;
+	return (int16_t)bank->y12[ch];
+}
+
+int biquad_bank_get(const struct biquad_bank *bank, int ch)
+{
+	return biquad_bank_get_scaled(bank, ch) >> BIQUAD_IN_SCALE;
+}
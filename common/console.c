@@ -118,6 +118,50 @@ static int split_words(char *input, int *argc, const char **argv)
 	return EC_SUCCESS;
 }
 
+/**
+ * Find the commands whose names start with a prefix.
+ *
+ * The linker sorts __cmds by name, so all matches are contiguous and can be
+ * located with two binary searches.  This relies on command names being
+ * lowercase, so that the link order agrees with strncasecmp().
+ *
+ * @param prefix	Prefix to match.
+ * @param len		Length of prefix.
+ * @param end		Set to one past the last match.
+ *
+ * @return The first match, or *end if there are no matches.
+ */
+static const struct console_command *
+find_command_range(const char *prefix, int len,
+		   const struct console_command **end)
+{
+	const struct console_command *lo = __cmds, *hi = __cmds_end;
+	const struct console_command *first, *mid;
+
+	/* First name not sorting before the prefix */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strncasecmp(mid->name, prefix, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	first = lo;
+
+	/* First name sorting after the prefix */
+	hi = __cmds_end;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strncasecmp(mid->name, prefix, len) > 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	*end = lo;
+
+	return first;
+}
+
 /**
  * Find a command by name.
  *
@@ -131,24 +175,21 @@ static int split_words(char *input, int *argc, const char **argv)
  */
 static const struct console_command *find_command(const char *name)
 {
-	const struct console_command *cmd, *match = NULL;
+	const struct console_command *cmd, *end;
 	int match_length = strlen(name);
 
-	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
-		if (!strncasecmp(name, cmd->name, match_length)) {
-			if (match)
-				return NULL;
-			/*
-			 * Check if 'cmd->name' is of the same length as
-			 * 'name'. If yes, then we have a full match.
-			 */
-			if (cmd->name[match_length] == '\0')
-				return cmd;
-			match = cmd;
-		}
-	}
+	cmd = find_command_range(name, match_length, &end);
+	if (cmd == end)
+		return NULL;
 
-	return match;
+	/*
+	 * A full match sorts ahead of any longer names sharing its prefix,
+	 * so it wins even if the partial match is ambiguous.
+	 */
+	if (cmd->name[match_length] == '\0' || end - cmd == 1)
+		return cmd;
+
+	return NULL;
 }
 
 static const char *const errmsgs[] = {
@@ -386,6 +427,63 @@ static void handle_backspace(void)
 	input_pos--;
 }
 
+#ifdef CONFIG_CONSOLE_TAB_COMPLETION
+static void append_char(char c)
+{
+	/* Leave room for terminating null */
+	if (input_len >= sizeof(input_buf) - 1)
+		return;
+
+	console_putc(c);
+	input_buf[input_len++] = c;
+	input_buf[input_len] = '\0';
+	input_pos = input_len;
+}
+
+/**
+ * Complete the command name being typed.
+ *
+ * Extends the input to the longest prefix shared by all matching commands,
+ * and adds a space once the match is unique.  If the input can't be extended,
+ * the candidates are listed and the line is reprinted.
+ */
+static void handle_tab(void)
+{
+	const struct console_command *first, *last, *end, *cmd;
+	int len;
+
+	/* Only complete the command name, with the cursor at end of line */
+	if (input_pos != input_len || strchr(input_buf, ' '))
+		return;
+
+	first = find_command_range(input_buf, input_len, &end);
+	if (first == end)
+		return;
+	last = end - 1;
+
+	/* Matches are sorted, so the first and last bound the common prefix */
+	len = input_len;
+	while (first->name[len] &&
+	       tolower(first->name[len]) == tolower(last->name[len]))
+		len++;
+
+	if (first == last) {
+		while (input_len < len)
+			append_char(first->name[input_len]);
+		append_char(' ');
+	} else if (len > input_len) {
+		while (input_len < len)
+			append_char(first->name[input_len]);
+	} else {
+		console_putc('\n');
+		for (cmd = first; cmd < end; cmd++)
+			ccprintf(" %s", cmd->name);
+		ccputs("\n" PROMPT);
+		ccputs(input_buf);
+	}
+}
+#endif /* CONFIG_CONSOLE_TAB_COMPLETION */
+
 /**
  * Escape code handler
  *
@@ -524,6 +622,12 @@ static void console_handle_char(int c)
 		/* Reprint prompt */
 		ccputs(PROMPT);
 		break;
+
+#ifdef CONFIG_CONSOLE_TAB_COMPLETION
+	case '\t':
+		handle_tab();
+		break;
+#endif /* CONFIG_CONSOLE_TAB_COMPLETION */
 #endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
 	case '\n':
@@ -0,0 +1,264 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Binary console log: cprints() calls are stored as the address of their
+ * format string plus the raw arguments, and formatted on the host by
+ * util/ec_binlog_decode.py.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "host_command.h"
+#include "task.h"
+#include "timer.h"
+#include "util.h"
+
+#define BINLOG_SIZE CONFIG_CONSOLE_BINLOG_BUF_SIZE
+BUILD_ASSERT(POWER_OF_TWO(BINLOG_SIZE));
+
+/* Largest record; calls with more argument data are printed as text. */
+#define RECORD_MAX 96
+BUILD_ASSERT(RECORD_MAX <= UINT8_MAX && RECORD_MAX <= BINLOG_SIZE);
+
+static uint8_t binlog_buf[BINLOG_SIZE];
+/* Offsets, in bytes logged since boot, of the oldest record and the end */
+static uint32_t binlog_oldest;
+static uint32_t binlog_end;
+static int binlog_enabled = 1;
+
+struct record_writer {
+	uint8_t buf[RECORD_MAX];
+	int len;
+};
+
+static bool put(struct record_writer *w, const void *data, int size)
+{
+	if (w->len + size > RECORD_MAX)
+		return false;
+	memcpy(w->buf + w->len, data, size);
+	w->len += size;
+	return true;
+}
+
+static bool put_u32(struct record_writer *w, uint32_t v)
+{
+	return put(w, &v, sizeof(v));
+}
+
+/*
+ * Append the arguments used by format. This only walks the format the way
+ * vfnprintf() does to know the type of each argument; nothing is converted.
+ */
+static bool put_args(struct record_writer *w, const char *format,
+		     va_list args)
+{
+	int c, precision;
+	bool wide;
+	uint64_t v;
+	const char *s;
+
+	while ((c = *format++)) {
+		if (c != '%')
+			continue;
+
+		c = *format++;
+		if (c == '%')
+			continue;
+		if (c == '\0')
+			break;
+
+		/* Flags and width */
+		while (c == '-' || c == '+' || c == '0')
+			c = *format++;
+		if (c == '*') {
+			if (!put_u32(w, va_arg(args, int)))
+				return false;
+			c = *format++;
+		}
+		while (c >= '0' && c <= '9')
+			c = *format++;
+
+		/* Precision, which limits the length of strings */
+		precision = -1;
+		if (c == '.') {
+			c = *format++;
+			if (c == '*') {
+				precision = va_arg(args, int);
+				if (!put_u32(w, precision))
+					return false;
+				c = *format++;
+			} else {
+				precision = 0;
+				while (c >= '0' && c <= '9') {
+					precision = 10 * precision + c - '0';
+					c = *format++;
+				}
+			}
+		}
+
+		if (c == 's') {
+			s = va_arg(args, const char *);
+			if (s == NULL)
+				s = "(NULL)";
+			if (precision < 0)
+				precision = RECORD_MAX;
+			if (!put(w, s, strnlen(s, precision)) || !put(w, "", 1))
+				return false;
+			continue;
+		}
+
+		/* Length */
+		wide = false;
+		if (c == 'l') {
+			wide = sizeof(long) == sizeof(uint64_t);
+			c = *format++;
+			if (c == 'l') {
+				wide = true;
+				c = *format++;
+			}
+		} else if (c == 'z') {
+			wide = sizeof(size_t) == sizeof(uint64_t);
+			c = *format++;
+		}
+
+		if (c == 'p') {
+			wide = sizeof(void *) == sizeof(uint64_t);
+			v = (uintptr_t)va_arg(args, void *);
+		} else if (wide) {
+			v = va_arg(args, uint64_t);
+		} else {
+			v = va_arg(args, uint32_t);
+		}
+		if (!put(w, &v, wide ? sizeof(uint64_t) : sizeof(uint32_t)))
+			return false;
+	}
+
+	return true;
+}
+
+static void ring_write(uint32_t offset, const void *src, int size)
+{
+	int i = offset & (BINLOG_SIZE - 1);
+	int n = MIN(size, BINLOG_SIZE - i);
+
+	memcpy(binlog_buf + i, src, n);
+	memcpy(binlog_buf, (const uint8_t *)src + n, size - n);
+}
+
+static void ring_read(void *dest, uint32_t offset, int size)
+{
+	int i = offset & (BINLOG_SIZE - 1);
+	int n = MIN(size, BINLOG_SIZE - i);
+
+	memcpy(dest, binlog_buf + i, n);
+	memcpy((uint8_t *)dest + n, binlog_buf, size - n);
+}
+
+static uint8_t record_size(uint32_t offset)
+{
+	return binlog_buf[offset & (BINLOG_SIZE - 1)];
+}
+
+int console_binlog_vprints(enum console_channel channel, const char *format,
+			   va_list args)
+{
+	struct record_writer w;
+	struct ec_binlog_record *r = (struct ec_binlog_record *)w.buf;
+	uint64_t now = get_time().val;
+	uint32_t key;
+
+	/* Console commands print for whoever typed them. */
+	if (!binlog_enabled || channel == CC_COMMAND)
+		return EC_ERROR_NOT_HANDLED;
+
+	w.len = sizeof(*r);
+	if (!put_args(&w, format, args))
+		return EC_ERROR_OVERFLOW;
+
+	r->size = w.len;
+	r->channel = channel;
+	r->time_hi = now >> 32;
+	r->time_lo = now;
+	r->format = (uintptr_t)format;
+
+	key = irq_lock();
+	while (BINLOG_SIZE - (binlog_end - binlog_oldest) < w.len)
+		binlog_oldest += record_size(binlog_oldest);
+	ring_write(binlog_end, w.buf, w.len);
+	binlog_end += w.len;
+	irq_unlock(key);
+
+	return EC_SUCCESS;
+}
+
+/* Whether offset is the start of a buffered record, or the end. */
+static bool is_record_start(uint32_t offset)
+{
+	uint32_t pos = binlog_oldest;
+
+	while ((int32_t)(pos - offset) < 0 && pos != binlog_end)
+		pos += record_size(pos);
+
+	return pos == offset;
+}
+
+static enum ec_status binlog_read(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_console_stream *p = args->params;
+	struct ec_response_console_stream *r = args->response;
+	uint32_t pos, end, key;
+	int max;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+	max = args->response_max - sizeof(*r);
+
+	key = irq_lock();
+
+	pos = (p->flags & EC_CONSOLE_STREAM_OLDEST) ? binlog_oldest : p->offset;
+	r->lost = 0;
+	if ((int32_t)(pos - binlog_oldest) < 0) {
+		r->lost = binlog_oldest - pos;
+		pos = binlog_oldest;
+	} else if (!is_record_start(pos)) {
+		irq_unlock(key);
+		return EC_RES_INVALID_PARAM;
+	}
+
+	/* Only whole records */
+	for (end = pos; end != binlog_end; end += record_size(end)) {
+		if (end + record_size(end) - pos > max)
+			break;
+	}
+	ring_read(r->data, pos, end - pos);
+
+	irq_unlock(key);
+
+	r->next_offset = end;
+	r->size = end - pos;
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + r->size;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_CONSOLE_BINLOG, binlog_read,
+			     EC_VER_MASK(0));
+
+static int command_binlog(int argc, const char **argv)
+{
+	if (argc > 1 && !parse_bool(argv[1], &binlog_enabled))
+		return EC_ERROR_PARAM1;
+
+	ccprintf("Binary log %s, %d of %d bytes used\n",
+		 binlog_enabled ? "on" : "off", binlog_end - binlog_oldest,
+		 BINLOG_SIZE);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(binlog, command_binlog, "[on|off]",
+			"Log cprints() output in binary for the host");
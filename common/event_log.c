@@ -3,6 +3,8 @@
  * found in the LICENSE file.
  */
 
+#include "atomic.h"
+#include "atomic_bit.h"
 #include "common.h"
 #include "console.h"
 #include "event_log.h"
@@ -27,48 +29,105 @@ BUILD_ASSERT(POWER_OF_TWO(UNIT_COUNT));
  * The pointers are not wrapped until they are used, so we don't need an extra
  * entry to disambiguate between full and empty FIFO.
  *
- * For concurrency, several tasks might try to enqueue events in parallel with
- * log_add_event(). Only one task is dequeuing events (host commands, VDM,
- * TPM command handler). When the FIFO is full, log_add_event() will discard
- * the oldest events, so "log_head" is incremented/decremented in a critical
- * section since it is accessed from both log_add_event() and
- * log_dequeue_event(). log_tail_next is also protected as several writers can
- * race to add an event to the queue.
- * When a writer is done adding its event, it is updating log_tail,
- * so the event can be consumed by log_dequeue_event().
+ * For concurrency, several tasks or interrupts might try to enqueue events in
+ * parallel with log_add_event(). Only one task is dequeuing events (host
+ * commands, VDM, TPM command handler). No lock is taken on either side:
+ * - a writer reserves its space by moving log_tail_next forward with a
+ *   compare-and-swap, after discarding the oldest events if the FIFO is full.
+ * - "log_head" is only moved with a compare-and-swap as both the writers
+ *   (discarding) and the reader (dequeuing) race on it.
+ * - once its event is copied, a writer sets the commit bit of its first unit.
+ *   Whoever finds the commit bit set at "log_tail" moves it over that event,
+ *   so events are published in order even if their writers finish out of
+ *   order, and the reader never sees a partially written event.
  */
-static size_t log_head;
-static size_t log_tail;
-static size_t log_tail_next;
+static atomic_t log_head;
+static atomic_t log_tail;
+static atomic_t log_tail_next;
+static ATOMIC_DEFINE(log_committed, UNIT_COUNT);
+
+/* Number of events lost since log_clear_dropped() was last called */
+static atomic_t log_dropped;
 
 /* Size of one FIFO entry */
 #define ENTRY_SIZE(payload_sz) (1 + DIV_ROUND_UP((payload_sz), UNIT_SIZE))
+BUILD_ASSERT(EVENT_LOG_MAX_ENTRY_SIZE ==
+	     ENTRY_SIZE(EVENT_LOG_SIZE_MASK) * UNIT_SIZE);
+
+/* Size in units of the entry at position pos */
+static uint32_t entry_units(uint32_t pos)
+{
+	const struct event_log_entry *r = log_events + (pos & UNIT_COUNT_MASK);
+
+	return ENTRY_SIZE(EVENT_LOG_SIZE(r->size));
+}
+
+/*
+ * Throw away the oldest entry, head being the value of log_head seen by the
+ * caller. Only published entries can be discarded, returns false if there are
+ * none.
+ */
+static bool log_discard_oldest(uint32_t head)
+{
+	if (head == atomic_get(&log_tail))
+		return false;
+
+	/* If log_head moved, the size was read from a stale entry: ignore it */
+	if (atomic_cas(&log_head, head, head + entry_units(head)))
+		atomic_add(&log_dropped, 1);
+
+	return true;
+}
+
+/* Move log_tail over all the entries committed right behind it */
+static void log_publish(void)
+{
+	uint32_t tail;
+
+	for (;;) {
+		tail = atomic_get(&log_tail);
+		if (!atomic_test_and_clear_bit(log_committed,
+					       tail & UNIT_COUNT_MASK))
+			return;
+		/*
+		 * log_tail moved after we read it: the bit belongs to a later
+		 * entry, hand it back and look at the new tail.
+		 */
+		if (atomic_get(&log_tail) != tail) {
+			atomic_set_bit(log_committed, tail & UNIT_COUNT_MASK);
+			continue;
+		}
+		/* We own the commit bit at log_tail, nobody else can move it */
+		atomic_add(&log_tail, entry_units(tail));
+	}
+}
 
 void log_add_event(uint8_t type, uint8_t size, uint16_t data, void *payload,
 		   uint32_t timestamp)
 {
 	struct event_log_entry *r;
 	size_t payload_size = EVENT_LOG_SIZE(size);
-	size_t total_size = ENTRY_SIZE(payload_size);
-	size_t current_tail, first;
-	uint32_t lock_key;
-
-	/* --- critical section : reserve queue space --- */
-	lock_key = irq_lock();
-	current_tail = log_tail_next;
-	log_tail_next = current_tail + total_size;
-	irq_unlock(lock_key);
-	/* --- end of critical section --- */
-
-	/* Out of space : discard the oldest entry */
-	while ((UNIT_COUNT - (current_tail - log_head)) < total_size) {
-		struct event_log_entry *oldest;
-		/* --- critical section : atomically free-up space --- */
-		lock_key = irq_lock();
-		oldest = log_events + (log_head & UNIT_COUNT_MASK);
-		log_head += ENTRY_SIZE(EVENT_LOG_SIZE(oldest->size));
-		irq_unlock(lock_key);
-		/* --- end of critical section --- */
+	uint32_t total_size = ENTRY_SIZE(payload_size);
+	uint32_t current_tail, head, first;
+
+	/* Reserve queue space, discarding the oldest entries if needed */
+	for (;;) {
+		head = atomic_get(&log_head);
+		current_tail = atomic_get(&log_tail_next);
+		if (current_tail + total_size - head > UNIT_COUNT) {
+			/*
+			 * The space is held by entries still being written:
+			 * drop this one rather than wait for them.
+			 */
+			if (!log_discard_oldest(head)) {
+				atomic_add(&log_dropped, 1);
+				return;
+			}
+			continue;
+		}
+		if (atomic_cas(&log_tail_next, current_tail,
+			       current_tail + total_size))
+			break;
 	}
 
 	r = log_events + (current_tail & UNIT_COUNT_MASK);
@@ -85,49 +144,151 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data, void *payload,
 	if (first < total_size - 1)
 		memcpy(log_events, ((uint8_t *)payload) + first * UNIT_SIZE,
 		       (total_size - first) * UNIT_SIZE);
-	/* mark the entry available in the queue if nobody is behind us */
-	if (current_tail == log_tail)
-		log_tail = log_tail_next;
+
+	/* mark the entry available, along with any committed behind it */
+	atomic_set_bit(log_committed, current_tail & UNIT_COUNT_MASK);
+	log_publish();
+}
+
+/* Copy the entry of total_size units at position pos into r */
+static void copy_entry(struct event_log_entry *r, uint32_t pos,
+		       uint32_t total_size)
+{
+	uint32_t first = MIN(total_size, UNIT_COUNT - (pos & UNIT_COUNT_MASK));
+
+	memcpy(r, log_events + (pos & UNIT_COUNT_MASK), first * UNIT_SIZE);
+	if (first < total_size)
+		memcpy(r + first, log_events, (total_size - first) * UNIT_SIZE);
+}
+
+/*
+ * Remove the oldest entry into r if it fits in max bytes, and fixup its
+ * timestamp relative to now. Returns the size of the entry, or 0 if the FIFO
+ * is empty or the entry doesn't fit.
+ */
+static int log_dequeue_one(struct event_log_entry *r, int max, uint32_t now)
+{
+	uint32_t total_size, current_head;
+
+	do {
+		current_head = atomic_get(&log_head);
+		/* The log FIFO is empty */
+		if (atomic_get(&log_tail) == current_head)
+			return 0;
+
+		total_size = entry_units(current_head);
+		if ((int)(total_size * UNIT_SIZE) > max)
+			return 0;
+		copy_entry(r, current_head, total_size);
+		/* retry if our entry was thrown away while we copied it */
+	} while (!atomic_cas(&log_head, current_head,
+			     current_head + total_size));
+
+	/* fixup the timestamp : number of milliseconds in the past */
+	r->timestamp = now - r->timestamp;
+
+	return total_size * UNIT_SIZE;
 }
 
 int log_dequeue_event(struct event_log_entry *r)
 {
 	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
-	unsigned int total_size, first;
-	struct event_log_entry *entry;
-	size_t current_head;
-	uint32_t lock_key;
-
-retry:
-	current_head = log_head;
-	/* The log FIFO is empty */
-	if (log_tail == current_head) {
+	int size;
+
+	size = log_dequeue_one(r, EVENT_LOG_MAX_ENTRY_SIZE, now);
+	if (!size) {
 		memset(r, 0, UNIT_SIZE);
 		r->type = EVENT_LOG_NO_ENTRY;
 		return UNIT_SIZE;
 	}
 
-	entry = log_events + (current_head & UNIT_COUNT_MASK);
-	total_size = ENTRY_SIZE(EVENT_LOG_SIZE(entry->size));
-	first = MIN(total_size, UNIT_COUNT - (current_head & UNIT_COUNT_MASK));
-	memcpy(r, entry, first * UNIT_SIZE);
-	if (first < total_size)
-		memcpy(r + first, log_events, (total_size - first) * UNIT_SIZE);
+	return size;
+}
+
+int log_dequeue_events(void *buf, int size)
+{
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	uint8_t *out = buf;
+	int len = 0, n;
+
+	while ((n = log_dequeue_one((struct event_log_entry *)(out + len),
+				    size - len, now)))
+		len += n;
 
-	/* --- critical section : remove the entry from the queue --- */
-	lock_key = irq_lock();
-	if (log_head != current_head) { /* our entry was thrown away */
-		irq_unlock(lock_key);
-		goto retry;
+	return len;
+}
+
+/*
+ * Remove the entries before cursor. Returns EC_ERROR_INVAL if cursor is past
+ * the end of the log or isn't the position of an entry.
+ */
+static int log_release(uint32_t cursor)
+{
+	uint32_t head, pos;
+
+	for (;;) {
+		head = atomic_get(&log_head);
+		/* Already removed */
+		if ((int32_t)(cursor - head) <= 0)
+			return EC_SUCCESS;
+		if (cursor - head > atomic_get(&log_tail) - head)
+			return EC_ERROR_INVAL;
+
+		pos = head;
+		while ((int32_t)(cursor - pos) > 0)
+			pos += entry_units(pos);
+		/* Don't trust the walk if writers discarded entries */
+		if (pos != cursor) {
+			if (atomic_get(&log_head) == head)
+				return EC_ERROR_INVAL;
+			continue;
+		}
+
+		if (atomic_cas(&log_head, head, cursor))
+			return EC_SUCCESS;
 	}
-	log_head += total_size;
-	irq_unlock(lock_key);
-	/* --- end of critical section --- */
+}
 
-	/* fixup the timestamp : number of milliseconds in the past */
-	r->timestamp = now - r->timestamp;
+uint32_t log_oldest_cursor(void)
+{
+	return atomic_get(&log_head);
+}
 
-	return total_size * UNIT_SIZE;
+int log_read_events(uint32_t *cursor, void *buf, int size)
+{
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	uint32_t start, pos, tail, total_size;
+	struct event_log_entry *r;
+	uint8_t *out = buf;
+	int len;
+
+	if (log_release(*cursor))
+		return -1;
+
+	do {
+		start = pos = atomic_get(&log_head);
+		tail = atomic_get(&log_tail);
+		len = 0;
+		while ((int32_t)(tail - pos) > 0) {
+			total_size = entry_units(pos);
+			if (len + (int)(total_size * UNIT_SIZE) > size)
+				break;
+			r = (struct event_log_entry *)(out + len);
+			copy_entry(r, pos, total_size);
+			r->timestamp = now - r->timestamp;
+			len += total_size * UNIT_SIZE;
+			pos += total_size;
+		}
+		/* start over if writers discarded entries while we copied */
+	} while (atomic_get(&log_head) != start);
+
+	*cursor = start;
+	return len;
+}
+
+uint32_t log_clear_dropped(void)
+{
+	return atomic_clear(&log_dropped);
 }
 
 #ifdef CONFIG_CMD_DLOG
@@ -136,7 +297,7 @@ retry:
  */
 static int command_dlog(int argc, const char **argv)
 {
-	size_t log_cur;
+	uint32_t log_cur;
 	const uint8_t *const log_events_end =
 		(uint8_t *)&log_events[UNIT_COUNT];
 
@@ -144,6 +305,8 @@ static int command_dlog(int argc, const char **argv)
 		if (!strcasecmp(argv[1], "clear")) {
 			interrupt_disable();
 			log_head = log_tail = log_tail_next = 0;
+			memset(log_committed, 0, sizeof(log_committed));
+			log_dropped = 0;
 			interrupt_enable();
 
 			return EC_SUCCESS;
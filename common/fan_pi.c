@@ -0,0 +1,119 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Predictive PI fan controller */
+
+#include "fan_pi.h"
+
+#include <string.h>
+
+/* Standalone, so it builds for host tools without the EC headers */
+#define FAN_PI_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define FAN_PI_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define FAN_PI_CLAMP(x, lo, hi) FAN_PI_MIN(FAN_PI_MAX(x, lo), hi)
+
+void fan_pi_reset(struct fan_pi_state *state)
+{
+	memset(state, 0, sizeof(*state));
+	state->hottest = -1;
+}
+
+/*
+ * Update the slope of sensor i and return where its temperature is heading:
+ * a first order system rising at slope settles slope * tau higher.
+ */
+static int predict(const struct fan_pi_sensor *s, struct fan_pi_state *state,
+		   int i, int temp_mk, int dt_ms)
+{
+	int span = FAN_PI_MAX(s->temp_max_mk - s->temp_off_mk, 1);
+	int64_t raw, ahead;
+
+	if (!state->primed || state->temp_mk[i] <= 0) {
+		state->temp_mk[i] = temp_mk;
+		state->slope[i] = 0;
+	}
+
+	/* Smooth the slope over a quarter of tau so noise is not amplified. */
+	raw = (int64_t)(temp_mk - state->temp_mk[i]) * 1000 / dt_ms;
+	state->slope[i] += (raw - state->slope[i]) * dt_ms /
+			   (dt_ms + s->tau_ms / 4);
+	state->temp_mk[i] = temp_mk;
+
+	ahead = (int64_t)state->slope[i] * s->tau_ms / 1000;
+	return temp_mk + FAN_PI_CLAMP(ahead, -span, span);
+}
+
+int fan_pi_update(const struct fan_pi_config *cfg, struct fan_pi_state *state,
+		  const int *temps_mk, int power_mw, int dt_ms)
+{
+	int64_t err = 0, warmth = 0, ff, p, u;
+	int i, step;
+
+	if (dt_ms <= 0)
+		dt_ms = 1;
+
+	state->hottest = -1;
+	for (i = 0; i < cfg->num_sensors && i < FAN_PI_MAX_SENSORS; i++) {
+		const struct fan_pi_sensor *s = &cfg->sensors[i];
+		int span = FAN_PI_MAX(s->temp_max_mk - s->temp_off_mk, 1);
+		int64_t e, w;
+		int t;
+
+		if (temps_mk[i] <= 0) {
+			state->temp_mk[i] = 0;
+			continue;
+		}
+
+		t = predict(s, state, i, temps_mk[i], dt_ms);
+
+		/* Error from the set point, FAN_PI_OUTPUT_MAX per span */
+		e = (int64_t)(t - s->temp_target_mk) * FAN_PI_OUTPUT_MAX / span;
+		if (state->hottest < 0 || e > err) {
+			err = e;
+			state->hottest = i;
+		}
+
+		/* How far from fan off towards the set point */
+		w = (int64_t)(t - s->temp_off_mk) * FAN_PI_OUTPUT_MAX /
+		    FAN_PI_MAX(s->temp_target_mk - s->temp_off_mk, 1);
+		w = FAN_PI_CLAMP(w, 0, FAN_PI_OUTPUT_MAX);
+		warmth = FAN_PI_MAX(warmth, w);
+	}
+	state->primed = 1;
+
+	/* No sensor to go by, keep the fan where it is. */
+	if (state->hottest < 0)
+		return state->output;
+
+	/*
+	 * A power limit is what the system may draw, not what it draws, so
+	 * only feed it forward as the temperatures show the heat coming.
+	 */
+	ff = (int64_t)power_mw * cfg->ff_per_w / 1000;
+	ff = ff * warmth / FAN_PI_OUTPUT_MAX;
+	p = err * cfg->kp / FAN_PI_GAIN_ONE;
+
+	/* Don't wind up against an output that is already saturated. */
+	u = ff + p + state->integral;
+	if (!(u >= FAN_PI_OUTPUT_MAX && err > 0) && !(u <= 0 && err < 0)) {
+		state->integral += err * cfg->ki * dt_ms /
+				   (FAN_PI_GAIN_ONE * 1000);
+		state->integral = FAN_PI_CLAMP(state->integral,
+					       -FAN_PI_OUTPUT_MAX,
+					       FAN_PI_OUTPUT_MAX);
+	}
+	u = FAN_PI_CLAMP(ff + p + state->integral, 0, FAN_PI_OUTPUT_MAX);
+
+	if (u > state->output) {
+		step = cfg->slew_up ? cfg->slew_up * dt_ms : FAN_PI_OUTPUT_MAX;
+		state->output = FAN_PI_MIN(u, state->output + step);
+	} else {
+		step = cfg->slew_down ? cfg->slew_down * dt_ms :
+					FAN_PI_OUTPUT_MAX;
+		state->output = FAN_PI_MAX(u, state->output - step);
+	}
+
+	return state->output;
+}
@@ -72,6 +72,131 @@ static const struct hook_ptrs hook_list[] = {
 /* Times for deferrable functions */
 static int hook_task_started;
 
+#if defined(CONFIG_HOOK_SORTED) || defined(CONFIG_HOOK_DEBUG)
+/*
+ * Number hooks by their offset from the first one.  The linker scripts place
+ * all the hook sections back to back, starting with HOOK_INIT.
+ */
+static inline int hook_index(const struct hook_data *p)
+{
+	return p - __hooks_init;
+}
+#endif
+
+#ifdef CONFIG_HOOK_SORTED
+/*
+ * Priority order of each hook type, as offsets from the type's first hook.
+ * The order of a type starts at hook_index() of its first hook.
+ */
+static uint8_t hook_order[CONFIG_HOOK_MAX_COUNT];
+/* Bitmap of the hook types whose order is in hook_order[] */
+static uint32_t hook_sorted_types;
+BUILD_ASSERT(ARRAY_SIZE(hook_list) <= 32);
+
+static void hook_sort(void)
+{
+	int type, i, j;
+
+	for (type = 0; type < ARRAY_SIZE(hook_list); type++) {
+		const struct hook_data *start = hook_list[type].start;
+		int count = hook_list[type].end - start;
+		uint8_t *order = hook_order + hook_index(start);
+
+		if (hook_index(start) + count > ARRAY_SIZE(hook_order) ||
+		    count > UINT8_MAX + 1) {
+			CPRINTS("hook type %d left unsorted", type);
+			continue;
+		}
+
+		/* Insertion sort is stable: link order within a priority. */
+		for (i = 0; i < count; i++) {
+			for (j = i; j > 0; j--) {
+				if (start[order[j - 1]].priority <=
+				    start[i].priority)
+					break;
+				order[j] = order[j - 1];
+			}
+			order[j] = i;
+		}
+		hook_sorted_types |= BIT(type);
+	}
+}
+#endif /* CONFIG_HOOK_SORTED */
+
+#ifdef CONFIG_HOOK_DEFERRED_HEAP
+/*
+ * Min-heap of the pending deferred functions, ordered by firing time.  The
+ * linker scripts reserve a uint16_t heap slot and a uint16_t heap position
+ * per deferred function; the position is the slot plus one, or zero when
+ * the function isn't pending.  Only touched with interrupts locked.
+ */
+#define deferred_heap __deferred_heap
+#define deferred_pos (__deferred_heap + DEFERRED_FUNCS_COUNT)
+static int deferred_heap_size;
+
+static void deferred_heap_place(int slot, int i)
+{
+	deferred_heap[slot] = i;
+	deferred_pos[i] = slot + 1;
+}
+
+static void deferred_sift_up(int slot)
+{
+	int i = deferred_heap[slot];
+	int parent;
+
+	while (slot > 0) {
+		parent = (slot - 1) / 2;
+		if (__deferred_until[deferred_heap[parent]] <=
+		    __deferred_until[i])
+			break;
+		deferred_heap_place(slot, deferred_heap[parent]);
+		slot = parent;
+	}
+	deferred_heap_place(slot, i);
+}
+
+static void deferred_sift_down(int slot)
+{
+	int i = deferred_heap[slot];
+	int child;
+
+	while ((child = 2 * slot + 1) < deferred_heap_size) {
+		if (child + 1 < deferred_heap_size &&
+		    __deferred_until[deferred_heap[child + 1]] <
+			    __deferred_until[deferred_heap[child]])
+			child++;
+		if (__deferred_until[i] <=
+		    __deferred_until[deferred_heap[child]])
+			break;
+		deferred_heap_place(slot, deferred_heap[child]);
+		slot = child;
+	}
+	deferred_heap_place(slot, i);
+}
+
+/* Restore the heap order after the firing time of a queued function moved */
+static void deferred_heap_fix(int i)
+{
+	deferred_sift_up(deferred_pos[i] - 1);
+	deferred_sift_down(deferred_pos[i] - 1);
+}
+
+static void deferred_heap_remove(int i)
+{
+	int slot = deferred_pos[i] - 1;
+	int last;
+
+	deferred_pos[i] = 0;
+	if (slot == --deferred_heap_size)
+		return;
+
+	last = deferred_heap[deferred_heap_size];
+	deferred_heap_place(slot, last);
+	deferred_heap_fix(last);
+}
+#endif /* CONFIG_HOOK_DEFERRED_HEAP */
+
 #ifdef CONFIG_HOOK_DEBUG
 /* Stats for hooks */
 static uint64_t max_hook_tick_delay;
@@ -82,6 +207,21 @@ static uint64_t avg_hook_tick_delay;
 static uint64_t avg_hook_second_delay;
 static uint64_t avg_hook_run_time[ARRAY_SIZE(hook_list)];
 
+struct hook_stats {
+	uint32_t calls;
+	uint32_t max_us;
+	uint32_t avg_us;
+};
+static struct hook_stats hook_stats[CONFIG_HOOK_MAX_COUNT];
+
+/* Stats for deferred functions, in space reserved by the linker scripts */
+struct deferred_stats {
+	uint32_t calls;
+	uint32_t max_late_us;
+	uint32_t avg_late_us;
+};
+#define DEFERRED_STATS ((struct deferred_stats *)__deferred_stats)
+
 static inline void update_hook_average(uint64_t *avg, uint64_t time)
 {
 	*avg = (*avg * 7 + time) >> 3;
@@ -106,23 +246,51 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 }
 #endif
 
-void hook_notify(enum hook_type type)
+static void hook_call(const struct hook_data *p)
 {
-	const struct hook_data *start, *end, *p;
-	int count, called = 0;
-	int last_prio = HOOK_PRIO_FIRST - 1, prio;
 #ifdef CONFIG_HOOK_DEBUG
+	int i = hook_index(p);
 	uint64_t start_time = get_time().val;
-	uint64_t run_time;
+	uint32_t run_time;
 #endif
 
-	CPRINTS("hook notify %d", type);
+	p->routine();
+
+#ifdef CONFIG_HOOK_DEBUG
+	if (i < ARRAY_SIZE(hook_stats)) {
+		run_time = get_time().val - start_time;
+		hook_stats[i].calls++;
+		hook_stats[i].max_us = MAX(hook_stats[i].max_us, run_time);
+		hook_stats[i].avg_us = (hook_stats[i].avg_us * 7 + run_time) >>
+				       3;
+	}
+#endif
+}
+
+#ifdef CONFIG_HOOK_SORTED
+static void hook_call_sorted(enum hook_type type)
+{
+	const struct hook_data *start = hook_list[type].start;
+	const uint8_t *order = hook_order + hook_index(start);
+	int count = hook_list[type].end - start;
+	int i;
+
+	for (i = 0; i < count; i++)
+		hook_call(start + order[i]);
+}
+#endif
+
+/* Call the hooks in priority order, with one pass per priority level. */
+static void hook_call_unsorted(enum hook_type type)
+{
+	const struct hook_data *start, *end, *p;
+	int count, called = 0;
+	int last_prio = HOOK_PRIO_FIRST - 1, prio;
 
 	start = hook_list[type].start;
 	end = hook_list[type].end;
 	count = end - start;
 
-	/* Call all the hooks in priority order */
 	while (called < count) {
 		/* Find the lowest remaining priority */
 		for (p = start, prio = HOOK_PRIO_LAST + 1; p < end; p++) {
@@ -135,10 +303,27 @@ void hook_notify(enum hook_type type)
 		for (p = start; p < end; p++) {
 			if (p->priority == prio) {
 				called++;
-				p->routine();
+				hook_call(p);
 			}
 		}
 	}
+}
+
+void hook_notify(enum hook_type type)
+{
+#ifdef CONFIG_HOOK_DEBUG
+	uint64_t start_time = get_time().val;
+	uint64_t run_time;
+#endif
+
+	CPRINTS("hook notify %d", type);
+
+#ifdef CONFIG_HOOK_SORTED
+	if (hook_sorted_types & BIT(type))
+		hook_call_sorted(type);
+	else
+#endif
+		hook_call_unsorted(type);
 
 #ifdef CONFIG_HOOK_DEBUG
 	run_time = get_time().val - start_time;
@@ -151,10 +336,36 @@ void hook_notify(enum hook_type type)
 int hook_call_deferred(const struct deferred_data *data, int us)
 {
 	int i = data - __deferred_funcs;
+#ifdef CONFIG_HOOK_DEFERRED_HEAP
+	uint32_t key;
+#endif
 
 	if (data < __deferred_funcs || data >= __deferred_funcs_end)
 		return EC_ERROR_INVAL; /* Routine not registered */
 
+#ifdef CONFIG_HOOK_DEFERRED_HEAP
+	key = irq_lock();
+	if (us == -1) {
+		/* Cancel */
+		if (deferred_pos[i])
+			deferred_heap_remove(i);
+		__deferred_until[i] = 0;
+	} else {
+		/* Set alarm */
+		__deferred_until[i] = get_time().val + us;
+		if (deferred_pos[i]) {
+			deferred_heap_fix(i);
+		} else {
+			deferred_heap_place(deferred_heap_size++, i);
+			deferred_sift_up(deferred_heap_size - 1);
+		}
+	}
+	irq_unlock(key);
+
+	/* Wake task so it can re-sleep for the proper time */
+	if (us != -1 && hook_task_started)
+		task_wake(TASK_ID_HOOKS);
+#else
 	if (us == -1) {
 		/* Cancel */
 		__deferred_until[i] = 0;
@@ -166,10 +377,112 @@ int hook_call_deferred(const struct deferred_data *data, int us)
 		if (hook_task_started)
 			task_wake(TASK_ID_HOOKS);
 	}
+#endif
 
 	return EC_SUCCESS;
 }
 
+/* Call deferred function i, which was due at time until */
+static void deferred_call(int i, uint64_t until)
+{
+#ifdef CONFIG_HOOK_DEBUG
+	struct deferred_stats *s = &DEFERRED_STATS[i];
+	uint32_t late = get_time().val - until;
+
+	s->calls++;
+	s->max_late_us = MAX(s->max_late_us, late);
+	s->avg_late_us = (s->avg_late_us * 7 + late) >> 3;
+#endif
+
+	CPRINTS("hook call deferred 0x%p", __deferred_funcs[i].routine);
+	__deferred_funcs[i].routine();
+}
+
+#ifdef CONFIG_HOOK_DEFERRED_HEAP
+/* Call the deferred functions due before time t, earliest first. */
+static void deferred_run(uint64_t t)
+{
+	uint32_t key = irq_lock();
+	uint64_t until;
+	int i;
+
+	while (deferred_heap_size &&
+	       __deferred_until[deferred_heap[0]] < t) {
+		/*
+		 * Dequeue and clear the timer first, so the function can
+		 * request itself be called later.
+		 */
+		i = deferred_heap[0];
+		until = __deferred_until[i];
+		deferred_heap_remove(i);
+		__deferred_until[i] = 0;
+		irq_unlock(key);
+		deferred_call(i, until);
+		key = irq_lock();
+	}
+	irq_unlock(key);
+}
+
+/* Shorten the sleep of next us from time t to the first pending deferred */
+static int deferred_next(uint64_t t, int next)
+{
+	uint32_t key = irq_lock();
+	uint64_t until;
+
+	if (deferred_heap_size) {
+		until = __deferred_until[deferred_heap[0]];
+		if (until < t)
+			next = 0;
+		else if (until - t < next)
+			next = until - t;
+	}
+	irq_unlock(key);
+
+	return next;
+}
+#else
+static void deferred_run(uint64_t t)
+{
+	uint64_t until;
+	int i;
+
+	interrupt_disable();
+	for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
+		if (__deferred_until[i] && __deferred_until[i] < t) {
+			/*
+			 * Call deferred function.  Clear timer first,
+			 * so it can request itself be called later.
+			 */
+			until = __deferred_until[i];
+			__deferred_until[i] = 0;
+			interrupt_enable();
+			deferred_call(i, until);
+			interrupt_disable();
+		}
+	}
+	interrupt_enable();
+}
+
+static int deferred_next(uint64_t t, int next)
+{
+	int i;
+
+	interrupt_disable();
+	for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
+		if (!__deferred_until[i])
+			continue;
+
+		if (__deferred_until[i] < t)
+			next = 0;
+		else if (__deferred_until[i] - t < next)
+			next = __deferred_until[i] - t;
+	}
+	interrupt_enable();
+
+	return next;
+}
+#endif /* CONFIG_HOOK_DEFERRED_HEAP */
+
 void hook_task(void *u)
 {
 	/* Periodic hooks will be called first time through the loop */
@@ -178,6 +491,11 @@ void hook_task(void *u)
 
 	hook_task_started = 1;
 
+#ifdef CONFIG_HOOK_SORTED
+	/* Nothing else runs yet, so the order can't change under a caller. */
+	hook_sort();
+#endif
+
 	/* Call HOOK_INIT hooks. */
 	hook_notify(HOOK_INIT);
 
@@ -187,26 +505,10 @@ void hook_task(void *u)
 	while (1) {
 		uint64_t t = get_time().val;
 		int next = 0;
-		int i;
 
-		interrupt_disable();
 		/* Handle deferred routines */
-		for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
-			if (__deferred_until[i] && __deferred_until[i] < t) {
-				/*
-				 * Call deferred function.  Clear timer first,
-				 * so it can request itself be called later.
-				 */
-				__deferred_until[i] = 0;
-				interrupt_enable();
-				CPRINTS("hook call deferred 0x%p",
-					__deferred_funcs[i].routine);
-				__deferred_funcs[i].routine();
-				interrupt_disable();
-			}
-		}
+		deferred_run(t);
 
-		interrupt_enable();
 		if (t - last_tick >= HOOK_TICK_INTERVAL) {
 #ifdef CONFIG_HOOK_DEBUG
 			record_hook_delay(t, last_tick, HOOK_TICK_INTERVAL,
@@ -232,18 +534,8 @@ void hook_task(void *u)
 		if (last_tick + HOOK_TICK_INTERVAL > t)
 			next = last_tick + HOOK_TICK_INTERVAL - t;
 
-		interrupt_disable();
-		for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
-			if (!__deferred_until[i])
-				continue;
-
-			if (__deferred_until[i] < t)
-				next = 0;
-			else if (__deferred_until[i] - t < next)
-				next = __deferred_until[i] - t;
-		}
-
-		interrupt_enable();
+		if (next > 0)
+			next = deferred_next(t, next);
 
 		/*
 		 * If nothing is immediately pending, sleep until the next
@@ -285,6 +577,37 @@ static int command_stats(int argc, const char **argv)
 			 (uint32_t)max_hook_run_time[i],
 			 (uint32_t)avg_hook_run_time[i]);
 
+	ccprintf("\nPer hook:\ntype prio routine      calls      max_us  "
+		 "avg_us\n");
+	for (i = 0; i < ARRAY_SIZE(hook_list); ++i) {
+		const struct hook_data *p;
+
+		for (p = hook_list[i].start; p < hook_list[i].end; p++) {
+			const struct hook_stats *s;
+
+			if (hook_index(p) >= ARRAY_SIZE(hook_stats))
+				break;
+			s = &hook_stats[hook_index(p)];
+			if (!s->calls)
+				continue;
+			ccprintf("%-4d %-4d %-12p %-10u %-7u %u\n", i,
+				 p->priority, p->routine, s->calls, s->max_us,
+				 s->avg_us);
+			cflush();
+		}
+	}
+
+	ccprintf("\nDeferred:\nroutine      calls      max_late  avg_late\n");
+	for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
+		const struct deferred_stats *s = &DEFERRED_STATS[i];
+
+		if (!s->calls)
+			continue;
+		ccprintf("%-12p %-10u %-9u %u\n", __deferred_funcs[i].routine,
+			 s->calls, s->max_late_us, s->avg_late_us);
+		cflush();
+	}
+
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(hookstats, command_stats, NULL, "Print stats of hooks");
@@ -91,6 +91,43 @@ static const uint16_t hc_suppressed_cmd[] = { CONFIG_SUPPRESSED_HOST_COMMANDS };
 static uint32_t hc_suppressed_cnt[ARRAY_SIZE(hc_suppressed_cmd)];
 #endif
 
+#ifdef CONFIG_HOSTCMD_LOOKUP_HASH
+/*
+ * Perfect hash of the registered command numbers, built once when the host
+ * command task starts ("hash and displace"). Each command hashes to a bucket,
+ * and each bucket stores the displacement that sends all of its commands to
+ * distinct slots, so a lookup is two hashes and one compare.
+ */
+#define HCMD_HASH_SLOTS CONFIG_HOSTCMD_LOOKUP_HASH_SLOTS
+#define HCMD_HASH_BUCKETS (HCMD_HASH_SLOTS / 4)
+/* Largest bucket the builder handles; bigger ones fall back to a scan */
+#define HCMD_HASH_MAX_BUCKET 8
+
+BUILD_ASSERT(POWER_OF_TWO(HCMD_HASH_SLOTS) && HCMD_HASH_SLOTS <= 256,
+	     "CONFIG_HOSTCMD_LOOKUP_HASH_SLOTS must be a power of 2 <= 256");
+
+static uint8_t hcmd_hash_disp[HCMD_HASH_BUCKETS];
+/* Index of the command in the table + 1, or 0 for an empty slot */
+static uint8_t hcmd_hash_slot[HCMD_HASH_SLOTS];
+static bool hcmd_hash_ready;
+#endif
+
+#ifdef CONFIG_HOSTCMD_LATENCY
+/*
+ * Dispatch statistics of the most frequent commands. When the table is full,
+ * a new command replaces the least frequent one, so hot commands stay.
+ */
+static struct {
+	uint16_t command;
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint64_t total_us;
+	uint32_t hist[EC_HOST_CMD_LATENCY_BUCKETS];
+} hcmd_latency[CONFIG_HOSTCMD_LATENCY_SLOTS];
+static int hcmd_latency_used;
+#endif
+
 uint8_t *host_get_memmap(int offset)
 {
 #ifdef CONFIG_HOSTCMD_X86
@@ -367,6 +404,110 @@ host_packet_bad:
 	host_packet_respond(&args0);
 }
 
+#ifdef CONFIG_HOSTCMD_LOOKUP_HASH
+/**
+ * Get the table of registered host commands.
+ *
+ * @param count		Set to the number of entries in the table
+ * @return The first entry of the table.
+ */
+static const struct host_command *host_command_table(int *count)
+{
+	if (IS_ENABLED(CONFIG_ZEPHYR))
+		return zephyr_get_host_commands(count);
+
+	*count = __hcmds_end - __hcmds;
+	return __hcmds;
+}
+
+static inline uint32_t hcmd_hash_mix(uint32_t x, uint32_t k)
+{
+	x *= k;
+	return x ^ (x >> 16);
+}
+
+static inline int hcmd_hash_bucket(uint16_t command)
+{
+	return hcmd_hash_mix(command, 0x9e3779b1) & (HCMD_HASH_BUCKETS - 1);
+}
+
+static inline int hcmd_hash_index(uint16_t command, uint8_t disp)
+{
+	return (hcmd_hash_mix(command, 0x85ebca6b) +
+		disp * (hcmd_hash_mix(command, 0xc2b2ae35) | 1)) &
+	       (HCMD_HASH_SLOTS - 1);
+}
+
+/**
+ * Try to place the commands of one bucket with the given displacement.
+ *
+ * @return true if all commands landed in distinct free slots, which are then
+ * claimed.
+ */
+static bool hcmd_hash_place(const struct host_command *table,
+			    const uint8_t *members, int n, uint8_t disp)
+{
+	int slots[HCMD_HASH_MAX_BUCKET];
+	int i, j;
+
+	for (i = 0; i < n; i++) {
+		slots[i] = hcmd_hash_index(table[members[i]].command, disp);
+		if (hcmd_hash_slot[slots[i]])
+			return false;
+		for (j = 0; j < i; j++)
+			if (slots[j] == slots[i])
+				return false;
+	}
+
+	for (i = 0; i < n; i++)
+		hcmd_hash_slot[slots[i]] = members[i] + 1;
+
+	return true;
+}
+
+static void hcmd_hash_build(void)
+{
+	const struct host_command *table;
+	uint8_t members[HCMD_HASH_MAX_BUCKET];
+	int count, size, b, i, n, disp;
+
+	table = host_command_table(&count);
+	if (count >= HCMD_HASH_SLOTS)
+		goto fail;
+
+	memset(hcmd_hash_slot, 0, sizeof(hcmd_hash_slot));
+
+	/* Place the largest buckets first, while the table is emptiest. */
+	for (size = HCMD_HASH_MAX_BUCKET; size > 0; size--) {
+		for (b = 0; b < HCMD_HASH_BUCKETS; b++) {
+			n = 0;
+			for (i = 0; i < count; i++) {
+				if (hcmd_hash_bucket(table[i].command) != b)
+					continue;
+				if (n == HCMD_HASH_MAX_BUCKET)
+					goto fail;
+				members[n++] = i;
+			}
+			if (n != size)
+				continue;
+
+			for (disp = 0; disp < 256; disp++)
+				if (hcmd_hash_place(table, members, n, disp))
+					break;
+			if (disp == 256)
+				goto fail;
+			hcmd_hash_disp[b] = disp;
+		}
+	}
+
+	hcmd_hash_ready = true;
+	return;
+
+fail:
+	CPRINTS("HC hash lookup unavailable for %d commands", count);
+}
+#endif /* CONFIG_HOSTCMD_LOOKUP_HASH */
+
 /**
  * Find a command by command number.
  *
@@ -379,6 +520,22 @@ static const struct host_command *find_host_command(int command)
 		if (!command_is_allowed_in_safe_mode(command))
 			return NULL;
 	}
+#ifdef CONFIG_HOSTCMD_LOOKUP_HASH
+	if (hcmd_hash_ready) {
+		const struct host_command *table;
+		int count, i;
+
+		if (command < 0 || command > UINT16_MAX)
+			return NULL;
+
+		table = host_command_table(&count);
+		i = hcmd_hash_slot[hcmd_hash_index(
+			command, hcmd_hash_disp[hcmd_hash_bucket(command)])];
+		if (i && table[i - 1].command == command)
+			return &table[i - 1];
+		return NULL;
+	}
+#endif
 	if (IS_ENABLED(CONFIG_ZEPHYR)) {
 		return zephyr_find_host_command(command);
 	} else if (IS_ENABLED(CONFIG_HOSTCMD_SECTION_SORTED)) {
@@ -417,6 +574,10 @@ static const struct host_command *find_host_command(int command)
 
 static void host_command_init(void)
 {
+#ifdef CONFIG_HOSTCMD_LOOKUP_HASH
+	hcmd_hash_build();
+#endif
+
 	/* Initialize memory map ID area */
 	host_get_memmap(EC_MEMMAP_ID)[0] = 'E';
 	host_get_memmap(EC_MEMMAP_ID)[1] = 'C';
@@ -652,27 +813,44 @@ static void host_command_debug_request(struct host_cmd_handler_args *args)
 		CPRINTS("HC 0x%04x", args->command);
 }
 
-uint16_t host_command_process(struct host_cmd_handler_args *args)
+#ifdef CONFIG_HOSTCMD_LATENCY
+static void host_command_record_latency(uint16_t command, uint32_t us)
 {
-	const struct host_command *cmd;
-	int rv;
+	int i, coldest = 0;
 
-	if (hcdebug)
-		host_command_debug_request(args);
+	for (i = 0; i < hcmd_latency_used; i++) {
+		if (hcmd_latency[i].command == command)
+			break;
+		if (hcmd_latency[i].count < hcmd_latency[coldest].count)
+			coldest = i;
+	}
 
-	/*
-	 * Pre-emptively clear the entire response buffer so we do not
-	 * have any left over contents from previous host commands.
-	 * For example, this prevents the last portion of a char array buffer
-	 * from containing data from the last host command if the string does
-	 * not take the entire width of the char array buffer.
-	 *
-	 * Note that if request and response buffers pointed to the same memory
-	 * location, then the chip implementation already needed to provide a
-	 * request_temp buffer in which the request data was already copied
-	 * by this point (see host_packet_receive function).
-	 */
-	memset(args->response, 0, args->response_max);
+	if (i == hcmd_latency_used) {
+		if (i == ARRAY_SIZE(hcmd_latency))
+			i = coldest;
+		else
+			hcmd_latency_used++;
+		memset(&hcmd_latency[i], 0, sizeof(hcmd_latency[i]));
+		hcmd_latency[i].command = command;
+		hcmd_latency[i].min_us = UINT32_MAX;
+	}
+
+	hcmd_latency[i].count++;
+	hcmd_latency[i].min_us = MIN(hcmd_latency[i].min_us, us);
+	hcmd_latency[i].max_us = MAX(hcmd_latency[i].max_us, us);
+	hcmd_latency[i].total_us += us;
+
+	/* Bucket N holds [2^N, 2^(N+1)) us; bucket 0 also holds 0 us. */
+	hcmd_latency[i].hist[MIN(us ? __fls(us) : 0,
+				 EC_HOST_CMD_LATENCY_BUCKETS - 1)]++;
+}
+#endif
+
+/* Runs the handler of a host command, without logging or statistics. */
+static uint16_t host_command_dispatch(struct host_cmd_handler_args *args)
+{
+	const struct host_command *cmd;
+	int rv;
 
 #ifdef CONFIG_HOSTCMD_PD
 	if (args->command >= EC_CMD_PASSTHRU_OFFSET(1) &&
@@ -701,6 +879,39 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 			rv = cmd->handler(args);
 	}
 
+	return rv;
+}
+
+uint16_t host_command_process(struct host_cmd_handler_args *args)
+{
+	int rv;
+#ifdef CONFIG_HOSTCMD_LATENCY
+	timestamp_t t0 = get_time();
+#endif
+
+	if (hcdebug)
+		host_command_debug_request(args);
+
+	/*
+	 * Pre-emptively clear the entire response buffer so we do not
+	 * have any left over contents from previous host commands.
+	 * For example, this prevents the last portion of a char array buffer
+	 * from containing data from the last host command if the string does
+	 * not take the entire width of the char array buffer.
+	 *
+	 * Note that if request and response buffers pointed to the same memory
+	 * location, then the chip implementation already needed to provide a
+	 * request_temp buffer in which the request data was already copied
+	 * by this point (see host_packet_receive function).
+	 */
+	memset(args->response, 0, args->response_max);
+
+	rv = host_command_dispatch(args);
+
+#ifdef CONFIG_HOSTCMD_LATENCY
+	host_command_record_latency(args->command, time_since32(t0));
+#endif
+
 	if (rv != EC_RES_SUCCESS)
 		CPRINTS("HC 0x%04x err %d", args->command, rv);
 
@@ -781,6 +992,189 @@ host_command_get_features(struct host_cmd_handler_args *args)
 DECLARE_HOST_COMMAND(EC_CMD_GET_FEATURES, host_command_get_features,
 		     EC_VER_MASK(0));
 
+#ifdef CONFIG_HOSTCMD_LATENCY
+/* Returns the dispatch latency histogram of one host command. */
+static enum ec_status
+host_command_get_latency(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_host_cmd_latency *p = args->params;
+	struct ec_response_host_cmd_latency *r = args->response;
+	int i;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+
+	for (i = 0; i < hcmd_latency_used; i++) {
+		if (hcmd_latency[i].command != p->cmd)
+			continue;
+
+		memcpy(r->hist, hcmd_latency[i].hist, sizeof(r->hist));
+		args->response_size = sizeof(*r);
+		return EC_RES_SUCCESS;
+	}
+
+	return EC_RES_UNAVAILABLE;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_HOST_CMD_LATENCY,
+			     host_command_get_latency, EC_VER_MASK(0));
+
+/* Returns dispatch statistics of the hottest host commands. */
+static enum ec_status
+host_command_get_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_host_cmd_stats *p = args->params;
+	struct ec_response_host_cmd_stats *r = args->response;
+	bool reported[ARRAY_SIZE(hcmd_latency)] = { 0 };
+	int max_entries, i, n, hottest;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	max_entries = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+	max_entries = MIN(max_entries, p->max_entries);
+	max_entries = MIN(max_entries, hcmd_latency_used);
+
+	/* The table is small, so pick the hottest unreported one each time. */
+	for (n = 0; n < max_entries; n++) {
+		hottest = -1;
+		for (i = 0; i < hcmd_latency_used; i++) {
+			if (reported[i])
+				continue;
+			if (hottest < 0 ||
+			    hcmd_latency[i].count > hcmd_latency[hottest].count)
+				hottest = i;
+		}
+		reported[hottest] = true;
+
+		r->entries[n].cmd = hcmd_latency[hottest].command;
+		r->entries[n].count = hcmd_latency[hottest].count;
+		r->entries[n].min_us = hcmd_latency[hottest].min_us;
+		r->entries[n].avg_us = hcmd_latency[hottest].total_us /
+				       hcmd_latency[hottest].count;
+		r->entries[n].max_us = hcmd_latency[hottest].max_us;
+	}
+
+	r->num_entries = n;
+	args->response_size = sizeof(*r) + n * sizeof(r->entries[0]);
+
+	if (p->flags & EC_HOST_CMD_STATS_RESET) {
+		memset(hcmd_latency, 0, sizeof(hcmd_latency));
+		hcmd_latency_used = 0;
+	}
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_HOST_CMD_STATS, host_command_get_stats,
+			     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_LATENCY */
+
+#ifdef CONFIG_HOSTCMD_BATCH
+/*
+ * Sub-command params and responses are copied through these, since they sit
+ * at arbitrary alignment in the batch request and response. The console
+ * hostcmd command runs batches from another task, hence the mutex.
+ */
+static uint32_t batch_params[256 / sizeof(uint32_t)];
+static uint32_t batch_response[256 / sizeof(uint32_t)];
+K_MUTEX_DEFINE(batch_mutex);
+
+static void host_command_batch_no_response(struct host_cmd_handler_args *args)
+{
+}
+
+/*
+ * Commands which send their response before they finish can't be batched:
+ * the early response would go nowhere, and an EC_RES_IN_PROGRESS would leave
+ * the command pending with the batch buffers as its arguments.
+ */
+static bool host_command_batchable(uint16_t command)
+{
+	switch (command) {
+	case EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH):
+	case EC_CMD_FLASH_ERASE:
+	case EC_CMD_REBOOT_EC:
+		return false;
+	default:
+		return true;
+	}
+}
+
+static enum ec_status host_command_batch_run(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_batch *p = args->params;
+	struct ec_response_batch *r = args->response;
+	const uint8_t *in = p->cmds;
+	const uint8_t *in_end = (const uint8_t *)args->params +
+				args->params_size;
+	uint8_t *out = r->results;
+	uint8_t *out_end = (uint8_t *)args->response + args->response_max;
+	int i;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	r->num_results = 0;
+	for (i = 0; i < p->num_cmds; i++) {
+		const struct ec_batch_cmd *cmd = (const void *)in;
+		struct ec_batch_result *res = (void *)out;
+		struct host_cmd_handler_args sub;
+
+		if (in_end - in < sizeof(*cmd) ||
+		    in_end - in < sizeof(*cmd) + cmd->param_size ||
+		    !host_command_batchable(cmd->command))
+			return EC_RES_INVALID_PARAM;
+		if (out_end - out < sizeof(*res) + cmd->response_max)
+			break;
+
+		memcpy(batch_params, cmd->params, cmd->param_size);
+		memset(batch_response, 0, cmd->response_max);
+		sub = (struct host_cmd_handler_args){
+			.send_response = host_command_batch_no_response,
+			.command = cmd->command,
+			.version = cmd->version,
+			.params = batch_params,
+			.params_size = cmd->param_size,
+			.response = batch_response,
+			.response_max = cmd->response_max,
+		};
+
+		/* The batch itself is what the latency stats count. */
+		res->command = cmd->command;
+		res->result = host_command_dispatch(&sub);
+		if (res->result == EC_RES_SUCCESS &&
+		    sub.response_size > cmd->response_max)
+			res->result = EC_RES_RESPONSE_TOO_BIG;
+		res->size = res->result == EC_RES_SUCCESS ? sub.response_size :
+							     0;
+		memcpy(res->data, batch_response, res->size);
+
+		in += sizeof(*cmd) + cmd->param_size;
+		out += sizeof(*res) + res->size;
+		r->num_results++;
+	}
+
+	args->response_size = out - (uint8_t *)r;
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status host_command_batch(struct host_cmd_handler_args *args)
+{
+	enum ec_status rv;
+
+	mutex_lock(&batch_mutex);
+	rv = host_command_batch_run(args);
+	mutex_unlock(&batch_mutex);
+
+	return rv;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_BATCH, host_command_batch,
+			     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_BATCH */
+
 /*****************************************************************************/
 /* Console commands */
 
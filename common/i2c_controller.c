@@ -12,13 +12,16 @@
 #include "console.h"
 #include "crc8.h"
 #include "gpio.h"
+#include "hooks.h"
 #include "host_command.h"
+#include "hwtimer.h"
 #include "i2c.h"
 #include "i2c_bitbang.h"
 #include "i2c_private.h"
 #include "printf.h"
 #include "system.h"
 #include "task.h"
+#include "timer.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
 #include "util.h"
@@ -198,20 +201,20 @@ static int i2c_xfer_no_retry(const int port, const uint16_t addr_flags,
 }
 #endif /* CONFIG_I2C_XFER_LARGE_TRANSFER */
 
-int i2c_xfer_unlocked(const int port, const uint16_t addr_flags,
-		      const uint8_t *out, int out_size, uint8_t *in,
-		      int in_size, int flags)
+/*
+ * Run a transfer, retrying while the peripheral NAKs.  The number of attempts
+ * and of NAKed attempts are returned through attempts and naks.
+ */
+static int i2c_xfer_retry(const int port, const uint16_t addr_flags,
+			  const uint8_t *out, int out_size, uint8_t *in,
+			  int in_size, int flags, int *attempts, int *naks)
 {
 	int i;
 	int ret = EC_SUCCESS;
 	uint16_t no_pec_af = addr_flags & ~I2C_FLAG_PEC;
 
-	if (!i2c_port_is_locked(port)) {
-		CPUTS("Access I2C without lock!");
-		return EC_ERROR_INVAL;
-	}
-
 	for (i = 0; i <= CONFIG_I2C_NACK_RETRY_COUNT; i++) {
+		*attempts = i + 1;
 #ifdef CONFIG_ZEPHYR
 		struct i2c_msg msg[2];
 		int num_msgs = 0;
@@ -269,6 +272,7 @@ int i2c_xfer_unlocked(const int port, const uint16_t addr_flags,
 			return EC_SUCCESS;
 		case -EIO:
 			ret = EC_ERROR_INVAL;
+			(*naks)++;
 			continue;
 		default:
 			return EC_ERROR_UNKNOWN;
@@ -282,13 +286,285 @@ int i2c_xfer_unlocked(const int port, const uint16_t addr_flags,
 #endif /* CONFIG_I2C_XFER_LARGE_TRANSFER */
 		if (ret != EC_ERROR_BUSY)
 			break;
+		(*naks)++;
+	}
+	return ret;
+}
+
+int i2c_xfer_unlocked(const int port, const uint16_t addr_flags,
+		      const uint8_t *out, int out_size, uint8_t *in,
+		      int in_size, int flags)
+{
+	int ret, attempts = 0, naks = 0;
+	__maybe_unused uint32_t start;
+
+	if (!i2c_port_is_locked(port)) {
+		CPUTS("Access I2C without lock!");
+		return EC_ERROR_INVAL;
 	}
+
+	if (IS_ENABLED(CONFIG_I2C_STATS))
+		start = __hw_clock_source_read();
+
+	ret = i2c_xfer_retry(port, addr_flags, out, out_size, in, in_size,
+			     flags, &attempts, &naks);
+
+	if (IS_ENABLED(CONFIG_I2C_STATS))
+		i2c_stats_record(port, addr_flags, out_size + in_size,
+				 __hw_clock_source_read() - start, attempts,
+				 naks, ret);
+
 	return ret;
 }
 
+#ifdef CONFIG_I2C_ASYNC
+/* Pending asynchronous requests, one queue per controller. */
+static struct i2c_async_req *async_queue[ARRAY_SIZE(port_mutex)];
+/* Requests run by synchronous callers, waiting for the hook task */
+static struct i2c_async_req *async_done;
+
+static int i2c_async_offset(const struct i2c_async_req *req)
+{
+	if (req->out_size == 1)
+		return req->out[0];
+	if (I2C_IS_ADDR16_LITTLE_ENDIAN(req->addr_flags))
+		return req->out[0] | (req->out[1] << 8);
+	return (req->out[0] << 8) | req->out[1];
+}
+
+/*
+ * Return true if next reads the registers directly following the len bytes
+ * read so far by the run of requests starting at first.
+ */
+static bool i2c_async_can_coalesce(const struct i2c_async_req *first, int len,
+				   const struct i2c_async_req *next)
+{
+	if (!(first->flags & next->flags & I2C_ASYNC_COALESCE))
+		return false;
+	if (first->port != next->port ||
+	    first->addr_flags != next->addr_flags ||
+	    first->out_size != next->out_size)
+		return false;
+	if (len + next->in_size > CONFIG_I2C_ASYNC_COALESCE_MAX)
+		return false;
+
+	return i2c_async_offset(next) == i2c_async_offset(first) + len;
+}
+
+/*
+ * Run the requests queued on a controller, up to and including until if it is
+ * not NULL.  Must be called with the controller locked; returns the other
+ * completed requests as a list.
+ */
+static struct i2c_async_req *i2c_async_run(int controller,
+					   const struct i2c_async_req *until)
+{
+	struct i2c_async_req *done = NULL;
+	struct i2c_async_req **done_tail = &done;
+
+	while (1) {
+		uint8_t buf[CONFIG_I2C_ASYNC_COALESCE_MAX];
+		struct i2c_async_req *first, *last, *req;
+		uint32_t key;
+		int len, rv;
+
+		key = irq_lock();
+		first = async_queue[controller];
+		if (!first) {
+			irq_unlock(key);
+			break;
+		}
+		len = first->in_size;
+		for (last = first; last->next; last = last->next) {
+			if (!i2c_async_can_coalesce(first, len, last->next))
+				break;
+			len += last->next->in_size;
+		}
+		async_queue[controller] = last->next;
+		last->next = NULL;
+		irq_unlock(key);
+
+		if (first == last) {
+			first->rv = i2c_xfer_unlocked(
+				first->port, first->addr_flags, first->out,
+				first->out_size, first->in, first->in_size,
+				I2C_XFER_SINGLE);
+		} else {
+			/* One block read, split back into the requests. */
+			rv = i2c_xfer_unlocked(first->port, first->addr_flags,
+					       first->out, first->out_size, buf,
+					       len, I2C_XFER_SINGLE);
+			for (req = first, len = 0; req; req = req->next) {
+				if (rv == EC_SUCCESS)
+					memcpy(req->in, buf + len,
+					       req->in_size);
+				req->rv = rv;
+				len += req->in_size;
+			}
+		}
+
+		/* Never coalesced, as the caller does not set the flag. */
+		if (first == until)
+			break;
+
+		*done_tail = first;
+		done_tail = &last->next;
+	}
+
+	return done;
+}
+
+static void i2c_async_complete(struct i2c_async_req *done)
+{
+	while (done) {
+		struct i2c_async_req *req = done;
+
+		/* req may be resubmitted from here on. */
+		done = req->next;
+		req->pending = false;
+		if (req->done)
+			req->done(req);
+		else if (req->event)
+			task_set_event(req->task, req->event);
+	}
+}
+
+/*
+ * Service the queues.  This only runs in the hook task, so completion
+ * callbacks never run in the context of an unrelated task.
+ */
+static void i2c_async_service(void)
+{
+	struct i2c_async_req *done;
+	uint32_t key;
+	int i, port;
+
+	/* Requests that synchronous callers ran ahead of their own */
+	key = irq_lock();
+	done = async_done;
+	async_done = NULL;
+	irq_unlock(key);
+	i2c_async_complete(done);
+
+	for (i = 0; i < ARRAY_SIZE(async_queue); i++) {
+		key = irq_lock();
+		port = async_queue[i] ? async_queue[i]->port : -1;
+		irq_unlock(key);
+
+		if (port < 0)
+			continue;
+
+		i2c_lock(port, 1);
+		done = i2c_async_run(i, NULL);
+		i2c_lock(port, 0);
+		i2c_async_complete(done);
+	}
+}
+DECLARE_DEFERRED(i2c_async_service);
+
+static int i2c_async_controller(int port)
+{
+#ifdef CONFIG_I2C_MULTI_PORT_CONTROLLER
+	port = i2c_port_to_controller(port);
+#endif
+	if (port < 0 || port >= ARRAY_SIZE(async_queue))
+		return -1;
+	return port;
+}
+
+static int i2c_async_enqueue(int controller, struct i2c_async_req *req)
+{
+	struct i2c_async_req **p;
+	uint32_t key;
+
+	key = irq_lock();
+	if (req->pending) {
+		irq_unlock(key);
+		return EC_ERROR_BUSY;
+	}
+	req->pending = true;
+	req->task = task_get_current();
+
+	/* High priority requests go after other high priority ones only. */
+	for (p = &async_queue[controller]; *p; p = &(*p)->next) {
+		if ((req->flags & I2C_ASYNC_PRIO_HIGH) &&
+		    !((*p)->flags & I2C_ASYNC_PRIO_HIGH))
+			break;
+	}
+	req->next = *p;
+	*p = req;
+	irq_unlock(key);
+
+	return EC_SUCCESS;
+}
+
+int i2c_async_submit(struct i2c_async_req *req)
+{
+	int controller = i2c_async_controller(req->port);
+	int rv;
+
+	if (controller < 0)
+		return EC_ERROR_INVAL;
+	if ((req->flags & I2C_ASYNC_COALESCE) &&
+	    (req->out_size < 1 || req->out_size > 2))
+		return EC_ERROR_INVAL;
+
+	rv = i2c_async_enqueue(controller, req);
+	if (rv == EC_SUCCESS)
+		hook_call_deferred(&i2c_async_service_data, 0);
+
+	return rv;
+}
+
+/*
+ * Synchronous transfer through the queue.  The caller holds the port while
+ * the requests queued ahead of it and then its own run, so synchronous and
+ * asynchronous users share the bus in order.  The hook task completes the
+ * other requests.
+ */
+static int i2c_async_xfer(struct i2c_async_req *req)
+{
+	int controller = i2c_async_controller(req->port);
+	struct i2c_async_req *done, **p;
+	uint32_t key;
+
+	if (controller < 0)
+		return EC_ERROR_INVAL;
+
+	i2c_lock(req->port, 1);
+	i2c_async_enqueue(controller, req);
+	done = i2c_async_run(controller, req);
+	i2c_lock(req->port, 0);
+	req->pending = false;
+
+	if (done) {
+		key = irq_lock();
+		for (p = &async_done; *p; p = &(*p)->next)
+			;
+		*p = done;
+		irq_unlock(key);
+		hook_call_deferred(&i2c_async_service_data, 0);
+	}
+
+	return req->rv;
+}
+#endif /* CONFIG_I2C_ASYNC */
+
 int i2c_xfer(const int port, const uint16_t addr_flags, const uint8_t *out,
 	     int out_size, uint8_t *in, int in_size)
 {
+#ifdef CONFIG_I2C_ASYNC
+	struct i2c_async_req req = {
+		.port = port,
+		.addr_flags = addr_flags,
+		.out = out,
+		.out_size = out_size,
+		.in = in,
+		.in_size = in_size,
+	};
+
+	return i2c_async_xfer(&req);
+#else
 	int rv;
 
 	i2c_lock(port, 1);
@@ -297,6 +573,7 @@ int i2c_xfer(const int port, const uint16_t addr_flags, const uint8_t *out,
 	i2c_lock(port, 0);
 
 	return rv;
+#endif
 }
 
 void i2c_lock(int port, int lock)
@@ -0,0 +1,224 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* I2C traffic statistics */
+
+#include "common.h"
+#include "console.h"
+#include "host_command.h"
+#include "hwtimer.h"
+#include "i2c.h"
+#include "task.h"
+#include "timer.h"
+#include "util.h"
+
+/*
+ * Utilization is tracked in a ring of buckets covering the window. Buckets
+ * are rounded up to a power of two of us, so that recording a transfer only
+ * shifts the 32-bit hardware clock. Epochs wrap with the clock, every 71
+ * minutes; a port idle for exactly that long may briefly show old traffic.
+ */
+#define WINDOW_BUCKETS 8
+#define BUCKET_SHIFT \
+	(__fls(CONFIG_I2C_STATS_WINDOW_MS * MSEC / WINDOW_BUCKETS - 1) + 1)
+#define BUCKET_US (1U << BUCKET_SHIFT)
+#define EPOCH_MASK (UINT32_MAX >> BUCKET_SHIFT)
+#define WINDOW_MS (WINDOW_BUCKETS * BUCKET_US / MSEC)
+
+struct i2c_stats_port {
+	bool used;
+	uint8_t port;
+	uint32_t epoch[WINDOW_BUCKETS];
+	uint32_t busy_us[WINDOW_BUCKETS];
+};
+
+static struct i2c_stats_port port_stats[EC_I2C_STATS_MAX_PORTS];
+static struct ec_i2c_stats_entry entries[CONFIG_I2C_STATS_ENTRIES];
+static int num_entries;
+/* Transactions not accounted for because the entry table was full */
+static uint32_t untracked;
+K_MUTEX_DEFINE(stats_mutex);
+
+static struct i2c_stats_port *find_port(int port)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(port_stats); i++) {
+		if (!port_stats[i].used) {
+			port_stats[i].used = true;
+			port_stats[i].port = port;
+			return &port_stats[i];
+		}
+		if (port_stats[i].port == port)
+			return &port_stats[i];
+	}
+
+	return NULL;
+}
+
+static struct ec_i2c_stats_entry *find_entry(int port, int addr)
+{
+	int i;
+
+	for (i = 0; i < num_entries; i++) {
+		if (entries[i].port == port && entries[i].addr == addr)
+			return &entries[i];
+	}
+	if (num_entries == ARRAY_SIZE(entries))
+		return NULL;
+
+	entries[num_entries].port = port;
+	entries[num_entries].addr = addr;
+	return &entries[num_entries++];
+}
+
+void i2c_stats_record(int port, uint16_t addr_flags, int bytes,
+		      uint32_t busy_us, int attempts, int naks, int rv)
+{
+	uint32_t epoch = __hw_clock_source_read() >> BUCKET_SHIFT;
+	int bucket = epoch % WINDOW_BUCKETS;
+	struct ec_i2c_stats_entry *e;
+	struct i2c_stats_port *p;
+
+	mutex_lock(&stats_mutex);
+
+	p = find_port(port);
+	e = find_entry(port, I2C_STRIP_FLAGS(addr_flags));
+	if (!e)
+		untracked++;
+
+	if (p) {
+		if (p->epoch[bucket] != epoch) {
+			p->epoch[bucket] = epoch;
+			p->busy_us[bucket] = 0;
+		}
+		p->busy_us[bucket] += busy_us;
+	}
+
+	if (e) {
+		e->count++;
+		e->bytes += bytes;
+		e->busy_us += busy_us;
+		e->max_us = MAX(e->max_us, busy_us);
+		e->retries += attempts - 1;
+		e->naks += naks;
+		if (rv != EC_SUCCESS)
+			e->errors++;
+	}
+
+	mutex_unlock(&stats_mutex);
+}
+
+/* Bus utilization of a port over the window, in 1/1000 units */
+static int port_utilization(const struct i2c_stats_port *p)
+{
+	uint32_t now = __hw_clock_source_read();
+	uint32_t epoch = now >> BUCKET_SHIFT;
+	uint32_t busy = 0, span;
+	int i;
+
+	for (i = 0; i < WINDOW_BUCKETS; i++) {
+		if (((epoch - p->epoch[i]) & EPOCH_MASK) < WINDOW_BUCKETS)
+			busy += p->busy_us[i];
+	}
+	/* The current bucket is only partially elapsed. */
+	span = (WINDOW_BUCKETS - 1) * BUCKET_US + (now & (BUCKET_US - 1));
+
+	return MIN(1000, (uint64_t)busy * 1000 / span);
+}
+
+static void i2c_stats_reset(void)
+{
+	mutex_lock(&stats_mutex);
+
+	memset(port_stats, 0, sizeof(port_stats));
+	memset(entries, 0, sizeof(entries));
+	num_entries = 0;
+	untracked = 0;
+
+	mutex_unlock(&stats_mutex);
+}
+
+static enum ec_status i2c_stats_get(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_i2c_stats *p = args->params;
+	struct ec_response_i2c_stats *r = args->response;
+	int max, i;
+
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+	max = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+
+	memset(r, 0, sizeof(*r));
+	r->window_ms = WINDOW_MS;
+
+	mutex_lock(&stats_mutex);
+	for (i = 0; i < ARRAY_SIZE(port_stats) && port_stats[i].used; i++) {
+		r->ports[i].port = port_stats[i].port;
+		r->ports[i].utilization = port_utilization(&port_stats[i]);
+	}
+	r->num_ports = i;
+	r->total_entries = num_entries;
+	if (p->start < num_entries) {
+		r->num_entries = MIN(num_entries - p->start, max);
+		memcpy(r->entries, entries + p->start,
+		       r->num_entries * sizeof(r->entries[0]));
+	}
+	mutex_unlock(&stats_mutex);
+
+	args->response_size =
+		sizeof(*r) + r->num_entries * sizeof(r->entries[0]);
+
+	if (p->flags & EC_I2C_STATS_RESET)
+		i2c_stats_reset();
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_I2C_STATS, i2c_stats_get, EC_VER_MASK(0));
+
+static int command_i2cstats(int argc, const char **argv)
+{
+	struct i2c_stats_port port;
+	struct ec_i2c_stats_entry e;
+	int i, u;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "reset"))
+			return EC_ERROR_PARAM1;
+		i2c_stats_reset();
+		return EC_SUCCESS;
+	}
+
+	ccprintf("Utilization over %d ms:\n", WINDOW_MS);
+	for (i = 0; i < ARRAY_SIZE(port_stats); i++) {
+		mutex_lock(&stats_mutex);
+		port = port_stats[i];
+		mutex_unlock(&stats_mutex);
+		if (!port.used)
+			break;
+
+		u = port_utilization(&port);
+		ccprintf("  port %d: %d.%d%%\n", port.port, u / 10, u % 10);
+	}
+
+	ccprintf("port addr  count      bytes      busy_us    max_us  "
+		 "retry  nak    err\n");
+	for (i = 0; i < num_entries; i++) {
+		mutex_lock(&stats_mutex);
+		e = entries[i];
+		mutex_unlock(&stats_mutex);
+
+		ccprintf("%-4d 0x%02x  %-10u %-10u %-10u %-7u %-6u %-6u %u\n",
+			 e.port, e.addr, e.count, e.bytes, e.busy_us, e.max_us,
+			 e.retries, e.naks, e.errors);
+		cflush();
+	}
+	if (untracked)
+		ccprintf("%u transactions untracked (table full)\n", untracked);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(i2cstats, command_i2cstats, "[reset]",
+			"Show I2C traffic statistics");
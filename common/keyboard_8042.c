@@ -236,6 +236,168 @@ static void kblog_put(char type, uint8_t byte)
 	}
 }
 
+#ifdef CONFIG_KEYBOARD_LATENCY
+/*
+ * Keypress latency, from the scanner seeing a key change to queueing its
+ * scan code for the host, and from there to the host having read the last
+ * byte of it.  Pending scan codes are matched to host reads by the to_host
+ * queue head and tail, which only wrap at UINT32_MAX.
+ */
+struct kbd_latency_pending {
+	uint32_t matrix_us;
+	uint32_t queued_us;
+	/* to_host queue tail just after the scan code */
+	size_t tail;
+};
+
+struct kbd_latency_sample {
+	uint32_t queue_us;
+	uint32_t host_us;
+};
+
+/* All under to_host_mutex */
+static struct kbd_latency_pending kbd_latency_pending[4];
+static int kbd_latency_num_pending;
+static struct kbd_latency_sample
+	kbd_latency_samples[CONFIG_KEYBOARD_LATENCY_SAMPLES];
+static int kbd_latency_head;
+static int kbd_latency_count;
+static uint32_t kbd_latency_total;
+static uint32_t kbd_latency_dropped;
+
+/* When the scanner saw the key change being reported */
+static uint32_t kbd_latency_matrix_us;
+static bool kbd_latency_matrix_valid;
+
+void keyboard_latency_key_event(void)
+{
+	kbd_latency_matrix_us = get_time().le.lo;
+	kbd_latency_matrix_valid = true;
+}
+
+/* A scan code was queued on to_host.  Called with to_host_mutex held. */
+static void kbd_latency_queued(void)
+{
+	uint32_t now = get_time().le.lo;
+	struct kbd_latency_pending *p;
+
+	if (kbd_latency_num_pending == ARRAY_SIZE(kbd_latency_pending)) {
+		kbd_latency_dropped++;
+		return;
+	}
+
+	p = &kbd_latency_pending[kbd_latency_num_pending++];
+	/* Keys which don't come from the matrix start here */
+	p->matrix_us = kbd_latency_matrix_valid ? kbd_latency_matrix_us : now;
+	p->queued_us = now;
+	p->tail = to_host.state->tail;
+	kbd_latency_matrix_valid = false;
+}
+
+/* The host has read every byte sent so far. */
+static void kbd_latency_host_read(void)
+{
+	uint32_t now = get_time().le.lo;
+	struct kbd_latency_pending *p;
+	struct kbd_latency_sample *s;
+	int i, n = 0;
+
+	if (!kbd_latency_num_pending)
+		return;
+
+	mutex_lock(&to_host_mutex);
+	for (i = 0; i < kbd_latency_num_pending; i++) {
+		p = &kbd_latency_pending[i];
+		if ((int32_t)(to_host.state->head - p->tail) < 0) {
+			/* Not all sent yet */
+			kbd_latency_pending[n++] = *p;
+			continue;
+		}
+
+		s = &kbd_latency_samples[kbd_latency_head];
+		s->queue_us = p->queued_us - p->matrix_us;
+		s->host_us = now - p->queued_us;
+		kbd_latency_head = (kbd_latency_head + 1) %
+				   ARRAY_SIZE(kbd_latency_samples);
+		kbd_latency_count = MIN(kbd_latency_count + 1,
+					ARRAY_SIZE(kbd_latency_samples));
+		kbd_latency_total++;
+	}
+	kbd_latency_num_pending = n;
+	mutex_unlock(&to_host_mutex);
+}
+
+/* Fill in the percentiles of one stage of the recorded samples. */
+static void kbd_latency_summary(int stage, int n,
+				struct ec_keyboard_latency_stage *r)
+{
+	uint32_t v[ARRAY_SIZE(kbd_latency_samples)];
+	const struct kbd_latency_sample *s;
+	uint32_t x;
+	int i, j;
+
+	mutex_lock(&to_host_mutex);
+	for (i = 0; i < n; i++) {
+		s = &kbd_latency_samples[i];
+		if (stage == EC_KEYBOARD_LATENCY_QUEUE)
+			v[i] = s->queue_us;
+		else if (stage == EC_KEYBOARD_LATENCY_HOST)
+			v[i] = s->host_us;
+		else
+			v[i] = s->queue_us + s->host_us;
+	}
+	mutex_unlock(&to_host_mutex);
+
+	for (i = 1; i < n; i++) {
+		x = v[i];
+		for (j = i; j > 0 && v[j - 1] > x; j--)
+			v[j] = v[j - 1];
+		v[j] = x;
+	}
+
+	/* Nearest rank */
+	r->p50_us = v[(n * 50 + 99) / 100 - 1];
+	r->p99_us = v[(n * 99 + 99) / 100 - 1];
+	r->max_us = v[n - 1];
+}
+
+static enum ec_status
+keyboard_latency_get(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_keyboard_latency *p = args->params;
+	struct ec_response_keyboard_latency *r = args->response;
+	int i;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+
+	memset(r, 0, sizeof(*r));
+
+	mutex_lock(&to_host_mutex);
+	r->total = kbd_latency_total;
+	r->dropped = kbd_latency_dropped;
+	r->samples = kbd_latency_count;
+	mutex_unlock(&to_host_mutex);
+
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT && r->samples; i++)
+		kbd_latency_summary(i, r->samples, &r->stages[i]);
+
+	if (p->flags & EC_KEYBOARD_LATENCY_RESET) {
+		mutex_lock(&to_host_mutex);
+		kbd_latency_head = 0;
+		kbd_latency_count = 0;
+		kbd_latency_total = 0;
+		kbd_latency_dropped = 0;
+		mutex_unlock(&to_host_mutex);
+	}
+
+	args->response_size = sizeof(*r);
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_KEYBOARD_LATENCY, keyboard_latency_get,
+			     EC_VER_MASK(0));
+#endif /* CONFIG_KEYBOARD_LATENCY */
+
 /*****************************************************************************/
 
 void keyboard_host_write(int data, int is_cmd)
@@ -244,7 +406,7 @@ void keyboard_host_write(int data, int is_cmd)
 
 	h.type = is_cmd ? HOST_COMMAND : HOST_DATA;
 	h.byte = data;
-	queue_add_unit(&from_host, &h);
+	queue_spsc_add(&from_host, &h, 1);
 #if defined(CONFIG_THIRD_PARTY_CUSTOMIZED_DESIGN)
 	lpc_kbc_ibf_clear();
 #endif
@@ -292,12 +454,15 @@ static void aux_enable_irq(int enable)
  * @param len		Number of bytes to send to the host
  * @param bytes		Data to send
  * @param chan		Channel to send data on
+ * @param is_typematic	1 for a typematic repeat
+ * @param is_key	1 for the scan code of a key press or release, which is
+ *			timed with CONFIG_KEYBOARD_LATENCY
  */
 static void i8042_send_to_host(int len, const uint8_t *bytes, uint8_t chan,
-			       int is_typematic)
+			       int is_typematic, int is_key)
 {
 	int i;
-	struct data_byte data;
+	struct data_byte *data;
 
 	/* Enqueue output data if there's space */
 	mutex_lock(&to_host_mutex);
@@ -325,11 +490,20 @@ static void i8042_send_to_host(int len, const uint8_t *bytes, uint8_t chan,
 
 		if (queue_space(queue) >= len) {
 			kblog_put('t', queue->state->tail);
+			/*
+			 * Fill the free space in place and publish the whole
+			 * scan code with a single tail update.
+			 */
 			for (i = 0; i < len; i++) {
-				data.chan = chan;
-				data.byte = bytes[i];
-				queue_add_unit(queue, &data);
+				data = queue_get_write_chunk(queue, i).buffer;
+				data->chan = chan;
+				data->byte = bytes[i];
 			}
+			queue_advance_tail(queue, len);
+#ifdef CONFIG_KEYBOARD_LATENCY
+			if (is_key && !is_typematic && len > 0)
+				kbd_latency_queued();
+#endif
 		}
 	}
 	mutex_unlock(&to_host_mutex);
@@ -457,6 +631,10 @@ void keyboard_clear_buffer(void)
 	kblog_put('x', queue_count(&to_host));
 	queue_init(&to_host);
 	queue_init(&to_host_cmd);
+#ifdef CONFIG_KEYBOARD_LATENCY
+	/* These will never reach the host */
+	kbd_latency_num_pending = 0;
+#endif
 	mutex_unlock(&to_host_mutex);
 	lpc_keyboard_clear_buffer();
 }
@@ -500,7 +678,7 @@ void keyboard_state_changed(int row, int col, int is_pressed)
 	if (ret == EC_SUCCESS) {
 		ASSERT(len > 0);
 		if (keystroke_enabled)
-			i8042_send_to_host(len, scan_code, CHAN_KBD, 0);
+			i8042_send_to_host(len, scan_code, CHAN_KBD, 0, 1);
 	}
 
 	if (is_pressed) {
@@ -510,6 +688,11 @@ void keyboard_state_changed(int row, int col, int is_pressed)
 	} else {
 		clear_typematic_key();
 	}
+
+#ifdef CONFIG_KEYBOARD_LATENCY
+	/* Don't leave it for another key if this one wasn't sent. */
+	kbd_latency_matrix_valid = false;
+#endif
 }
 #ifdef CONFIG_BOARD_AZALEA
 void i8042_pause_to_host_queue(bool pause)
@@ -947,7 +1130,7 @@ static void i8042_handle_from_host(void)
 		}
 		/* clear queue buffer */
 		queue_advance_head(&from_host, 1);
-		i8042_send_to_host(ret_len, output, chan, 0);
+		i8042_send_to_host(ret_len, output, chan, 0, 0);
 	}
 	k_mutex_unlock(&from_host_mutex);
 }
@@ -959,7 +1142,7 @@ static void i8042_handle_from_host(void)
 	uint8_t output[MAX_SCAN_CODE_LEN];
 	uint8_t chan;
 
-	while (queue_remove_unit(&from_host, &h)) {
+	while (queue_spsc_remove(&from_host, &h, 1)) {
 		if (h.type == HOST_COMMAND) {
 			ret_len = handle_keyboard_command(h.byte, output);
 			chan = CHAN_KBD;
@@ -976,7 +1159,7 @@ static void i8042_handle_from_host(void)
 			}
 		}
 
-		i8042_send_to_host(ret_len, output, chan, 0);
+		i8042_send_to_host(ret_len, output, chan, 0, 0);
 	}
 }
 #endif
@@ -1005,7 +1188,7 @@ void keyboard_protocol_task(void *u)
 				if (keystroke_enabled)
 					i8042_send_to_host(typematic_len,
 							   typematic_scan_code,
-							   CHAN_KBD, 1);
+							   CHAN_KBD, 1, 0);
 				typematic_deadline.val =
 					t.val + typematic_inter_delay;
 				wait = typematic_inter_delay;
@@ -1022,6 +1205,11 @@ void keyboard_protocol_task(void *u)
 			/* Handle command/data write from host */
 			i8042_handle_from_host();
 
+#ifdef CONFIG_KEYBOARD_LATENCY
+			if (!lpc_keyboard_has_char())
+				kbd_latency_host_read();
+#endif
+
 			/* Check if we have data to send to host */
 			if (queue_is_empty(&to_host) &&
 			    queue_is_empty(&to_host_cmd))
@@ -1071,7 +1259,7 @@ void keyboard_protocol_task(void *u)
 
 			/* Get a char from buffer. */
 			if (queue_count(&to_host_cmd)) {
-				queue_remove_unit(&to_host_cmd, &entry);
+				queue_spsc_remove(&to_host_cmd, &entry, 1);
 			} else if (data_port_state == STATE_ATKBD_SETLEDS) {
 				/*
 				 * to_host_cmd == empty and to_host != empty.
@@ -1097,10 +1285,10 @@ void keyboard_protocol_task(void *u)
 				 */
 				CPRINTS("KB SETLEDS timeout");
 				data_port_state = STATE_ATKBD_CMD;
-				queue_remove_unit(&to_host, &entry);
+				queue_spsc_remove(&to_host, &entry, 1);
 			} else {
 				/* to_host isn't empty && not in SETLEDS */
-				queue_remove_unit(&to_host, &entry);
+				queue_spsc_remove(&to_host, &entry, 1);
 			}
 
 			/* Write to host. */
@@ -1127,10 +1315,9 @@ static void send_aux_data_to_host_deferred(void)
 	    chipset_in_state(CHIPSET_STATE_ANY_SUSPEND))
 		device_set_single_event(EC_DEVICE_EVENT_TRACKPAD);
 
-	while (!queue_is_empty(&aux_to_host_queue)) {
-		queue_remove_unit(&aux_to_host_queue, &data);
+	while (queue_spsc_remove(&aux_to_host_queue, &data, 1)) {
 		if (aux_chan_enabled && IS_ENABLED(CONFIG_8042_AUX))
-			i8042_send_to_host(1, &data, CHAN_AUX, 0);
+			i8042_send_to_host(1, &data, CHAN_AUX, 0, 0);
 		else
 			CPRINTS("AUX Callback ignored");
 	}
@@ -1144,7 +1331,7 @@ DECLARE_DEFERRED(send_aux_data_to_host_deferred);
  */
 void send_aux_data_to_host_interrupt(uint8_t data)
 {
-	queue_add_unit(&aux_to_host_queue, &data);
+	queue_spsc_add(&aux_to_host_queue, &data, 1);
 	hook_call_deferred(&send_aux_data_to_host_deferred_data, 0);
 }
 
@@ -1188,7 +1375,7 @@ test_mockable void keyboard_update_button(enum keyboard_button_type button,
 	if (keystroke_enabled) {
 		CPRINTS5("KB UPDATE BTN");
 
-		i8042_send_to_host(len, scan_code, CHAN_KBD, 0);
+		i8042_send_to_host(len, scan_code, CHAN_KBD, 0, 1);
 		task_wake(TASK_ID_KEYPROTO);
 	}
 }
@@ -1222,7 +1409,7 @@ void simulate_keyboard(uint16_t scancode, int is_pressed)
 		clear_typematic_key();
 
 	if (keystroke_enabled) {
-		i8042_send_to_host(len, scan_code, CHAN_KBD, 0);
+		i8042_send_to_host(len, scan_code, CHAN_KBD, 0, 1);
 		task_wake(TASK_ID_KEYPROTO);
 	}
 }
@@ -136,6 +136,17 @@ static volatile int kbd_polls;
 /* If true, we'll force a keyboard poll */
 static volatile int force_poll;
 
+/* Scan statistics, shown by ksstate */
+static uint32_t scan_count;
+static uint32_t scan_idle_count;
+static uint32_t scan_last_us;
+static uint32_t scan_max_us;
+static uint32_t scan_avg_us;
+/* Scans in the last full second, and the one being counted */
+static uint32_t scans_per_sec;
+static uint32_t scan_rate_count;
+static uint32_t scan_rate_start;
+
 test_export_static int keyboard_scan_is_enabled(void)
 {
 	/* NOTE: this is just an instantaneous glimpse of the variable. */
@@ -289,6 +300,35 @@ static void simulate_key(int row, int col, int pressed)
 	ensure_keyboard_scanned(kbd_polls);
 }
 
+#ifdef CONFIG_KEYBOARD_SCAN_IDLE_SKIP
+/**
+ * Check if no key is pressed, with all columns driven at once.
+ *
+ * This takes a single settle period, so a full scan of the matrix is only
+ * needed while some row is active.
+ *
+ * @param at_boot	True if we are reading the boot key state.
+ *
+ * @return true if no row is active.
+ */
+static bool matrix_is_idle(bool at_boot)
+{
+	/*
+	 * The power button workaround and the test sequences need the
+	 * per-column state, and ADC rows have no all-columns reading.
+	 */
+	if (at_boot || IS_ENABLED(CONFIG_KEYBOARD_TEST) ||
+	    IS_ENABLED(CONFIG_KEYBOARD_SCAN_ADC) ||
+	    !keyboard_scan_is_enabled())
+		return false;
+
+	keyboard_raw_drive_column(KEYBOARD_COLUMN_ALL);
+	udelay(keyscan_config.output_settle_us);
+
+	return !keyboard_raw_read_rows();
+}
+#endif
+
 /**
  * Read the raw keyboard matrix state.
  *
@@ -305,17 +345,24 @@ static int read_matrix(uint8_t *state, bool at_boot)
 {
 	int c;
 	int pressed = 0;
+	bool idle = false;
+
+#ifdef CONFIG_KEYBOARD_SCAN_IDLE_SKIP
+	idle = matrix_is_idle(at_boot);
+	if (idle)
+		scan_idle_count++;
+#endif
 
 	/* 1. Read input pins */
 	for (c = 0; c < keyboard_cols; c++) {
 		/*
-		 * Skip if scanning becomes disabled. Clear the state
-		 * to make sure we don't mix new and old states in the
-		 * same array.
+		 * Skip if scanning becomes disabled or no key is pressed.
+		 * Clear the state to make sure we don't mix new and old
+		 * states in the same array.
 		 *
 		 * Note, scanning is enabled on boot by default.
 		 */
-		if (!keyboard_scan_is_enabled()) {
+		if (idle || !keyboard_scan_is_enabled()) {
 			state[c] = 0;
 			continue;
 		}
@@ -548,6 +595,10 @@ test_mockable_static void key_state_changed(int row, int col, uint8_t state)
 	if (!keyboard_scan_is_enabled())
 		return;
 
+#if defined(CONFIG_KEYBOARD_LATENCY) && defined(CONFIG_KEYBOARD_PROTOCOL_8042)
+	keyboard_latency_key_event();
+#endif
+
 	/* No-op for protocols that require full keyboard matrix (e.g. MKBP). */
 	keyboard_state_changed(row, col, !!(state & BIT(row)));
 }
@@ -572,9 +623,24 @@ static int check_keys_changed(uint8_t *state)
 		scan_time_index = 0;
 	scan_time[scan_time_index] = tnow;
 
+	/* Count scans over whole seconds */
+	if (tnow - scan_rate_start >= SECOND) {
+		scans_per_sec = tnow - scan_rate_start < 2 * SECOND ?
+					scan_rate_count :
+					0;
+		scan_rate_count = 0;
+		scan_rate_start = tnow;
+	}
+	scan_rate_count++;
+	scan_count++;
+
 	/* Read the raw key state */
 	any_pressed = read_matrix(new_state, false);
 
+	scan_last_us = get_time().le.lo - tnow;
+	scan_max_us = MAX(scan_max_us, scan_last_us);
+	scan_avg_us = (scan_avg_us * 7 + scan_last_us) >> 3;
+
 	if (!IS_ENABLED(CONFIG_KEYBOARD_SCAN_ADC)) {
 		/* Ignore if so many keys are pressed that we're ghosting. */
 		if (has_ghosting(new_state))
@@ -1137,6 +1203,12 @@ static int command_ksstate(int argc, const char **argv)
 	print_state(debouncing, "debouncing");
 
 	ccprintf("Keyboard scan disable mask: 0x%08x\n", disable_scanning_mask);
+	ccprintf("Scans: %u (%u idle), %u/s\n", scan_count, scan_idle_count,
+		 get_time().le.lo - scan_rate_start < 2 * SECOND ?
+			 scans_per_sec :
+			 0);
+	ccprintf("Scan time: last %u us, max %u us, avg %u us\n",
+		 scan_last_us, scan_max_us, scan_avg_us);
 	ccprintf("Keyboard scan state printing %s\n",
 		 print_state_changes ? "on" : "off");
 	return EC_SUCCESS;
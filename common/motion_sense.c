@@ -965,6 +965,7 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_motion_sense *in = args->params;
 	struct ec_response_motion_sense *out = args->response;
+	struct ec_response_motion_sense_fifo_stats *stats;
 	struct motion_sensor_t *sensor;
 	int i, ret = EC_RES_INVALID_PARAM, reported;
 	const void *in_offset;
@@ -1242,14 +1243,43 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 			args->response_size = sizeof(out->fifo_info);
 			break;
 		}
-		motion_sense_fifo_get_info(&out->fifo_info, 1);
 		args->response_size = sizeof(out->fifo_info) +
 				      sizeof(uint16_t) * motion_sensor_count;
+		/* Hosts asking for them get the drop statistics after lost[] */
+		stats = (void *)&out->fifo_info.lost[motion_sensor_count];
+		if (args->params_size <=
+			    offsetof(struct ec_params_motion_sense,
+				     fifo_info.flags) ||
+		    !(in->fifo_info.flags & MOTIONSENSE_FIFO_INFO_STATS) ||
+		    args->response_max < args->response_size + sizeof(*stats))
+			stats = NULL;
+		motion_sense_fifo_get_info(&out->fifo_info, stats, 1);
+		if (stats)
+			args->response_size += sizeof(*stats);
 		break;
 
 	case MOTIONSENSE_CMD_FIFO_READ:
 		if (!IS_ENABLED(CONFIG_ACCEL_FIFO))
 			return EC_RES_INVALID_PARAM;
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+		/*
+		 * Without CONFIG_ACCEL_FIFO_PACKED the flag is ignored: plain
+		 * entries are valid packed entries.
+		 */
+		if (args->params_size > offsetof(struct ec_params_motion_sense,
+						 fifo_read.flags) &&
+		    in->fifo_read.flags & MOTIONSENSE_FIFO_READ_PACKED) {
+			out->fifo_read.number_data =
+				motion_sense_fifo_read_packed(
+					args->response_max -
+						sizeof(out->fifo_read),
+					in->fifo_read.max_data_vector,
+					out->fifo_read.data,
+					&(args->response_size));
+			args->response_size += sizeof(out->fifo_read);
+			break;
+		}
+#endif
 		out->fifo_read.number_data = motion_sense_fifo_read(
 			args->response_max - sizeof(out->fifo_read),
 			in->fifo_read.max_data_vector, out->fifo_read.data,
@@ -25,6 +25,16 @@
 #define MOTION_SENSOR_INT_ADJUSTMENT_US \
 	(CONFIG_MOTION_MIN_SENSE_WAIT_TIME * MSEC / 10)
 
+/** Size of an entry as staged, and as read by the AP. */
+#define FIFO_ENTRY_BYTES sizeof(struct ec_response_motion_sensor_data)
+
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+/* Smallest committed entry: a timestamp 127 us or less after the previous. */
+#define FIFO_MIN_ENTRY_BYTES 2
+#else
+#define FIFO_MIN_ENTRY_BYTES FIFO_ENTRY_BYTES
+#endif
+
 /**
  * Staged metadata for the fifo queue.
  * @read_ts: The timestamp at which the staged data was read. This value will
@@ -53,11 +63,20 @@ struct timestamp_state {
 	uint32_t next;
 };
 
-/** Queue to hold the data to be sent to the AP. */
-static struct queue fifo = QUEUE_NULL(CONFIG_ACCEL_FIFO_SIZE,
-				      struct ec_response_motion_sensor_data);
+/**
+ * Queue to hold the data to be sent to the AP. Staged entries are full
+ * struct ec_response_motion_sensor_data after the tail; committed entries
+ * are packed with CONFIG_ACCEL_FIFO_PACKED, see fifo_pack_entry().
+ */
+static struct queue fifo =
+	QUEUE_NULL(CONFIG_ACCEL_FIFO_SIZE * FIFO_ENTRY_BYTES, uint8_t);
+/** Number of committed entries in the fifo. */
+static int fifo_count;
 /** Count of the number of entries lost due to a small queue. */
 static int fifo_lost;
+/** Entries staged and dropped since the fifo was last reset. */
+static uint32_t fifo_total_staged;
+static uint32_t fifo_total_dropped;
 /*
  * How many vector events are lost in the FIFO since last time
  * FIFO info has been transmitted.
@@ -105,6 +124,38 @@ static int ap_interrupt_needed;
  */
 uint32_t ts_last_int[MAX_MOTION_SENSORS];
 
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+/** Previous values a packed entry is relative to. */
+struct fifo_pack_state {
+	uint32_t timestamp;
+	int16_t data[MAX_MOTION_SENSORS][3];
+};
+
+/** Values the entry at the head of the fifo is packed relative to. */
+static struct fifo_pack_state head_state;
+
+/** Values the next committed entry is packed relative to. */
+static struct fifo_pack_state tail_state;
+
+BUILD_ASSERT(!(EC_MOTION_SENSE_PACKED &
+	       (MOTIONSENSE_SENSOR_FLAG_FLUSH |
+		MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
+		MOTIONSENSE_SENSOR_FLAG_WAKEUP |
+		MOTIONSENSE_SENSOR_FLAG_TABLET_MODE |
+		MOTIONSENSE_SENSOR_FLAG_ODR |
+		MOTIONSENSE_SENSOR_FLAG_BYPASS_FIFO)));
+#endif
+
+/** Position in the committed entries of the fifo. */
+struct fifo_iter {
+	/** Queue index of the next entry. */
+	size_t index;
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	/** Values the next entry is packed relative to. */
+	struct fifo_pack_state state;
+#endif
+};
+
 /**
  * Check whether or not a give sensor data entry is a timestamp or not.
  *
@@ -130,15 +181,258 @@ static inline bool is_data(const struct ec_response_motion_sensor_data *data)
 }
 
 /**
- * Convenience function to get the head of the fifo. This function makes no
- * guarantee on whether or not the entry is valid.
+ * Copy bytes out of the fifo buffer, wrapping around its end.
+ *
+ * @param index Queue index of the first byte.
+ * @param dst Where to copy the bytes.
+ * @param n Number of bytes to copy, at most the fifo size.
+ */
+static void fifo_copy_out(size_t index, void *dst, size_t n)
+{
+	size_t pos = index & fifo.buffer_units_mask;
+	size_t first = MIN(n, fifo.buffer_units - pos);
+
+	memcpy(dst, fifo.buffer + pos, first);
+	memcpy((uint8_t *)dst + first, fifo.buffer, n - first);
+}
+
+/**
+ * Copy bytes into the fifo buffer, wrapping around its end.
+ *
+ * @param index Queue index of the first byte.
+ * @param src The bytes to copy.
+ * @param n Number of bytes to copy, at most the fifo size.
+ */
+static void fifo_copy_in(size_t index, const void *src, size_t n)
+{
+	size_t pos = index & fifo.buffer_units_mask;
+	size_t first = MIN(n, fifo.buffer_units - pos);
+
+	memcpy(fifo.buffer + pos, src, first);
+	memcpy(fifo.buffer, (const uint8_t *)src + first, n - first);
+}
+
+/**
+ * Read a staged entry. This function performs no bound checking.
+ *
+ * @param offset The offset into the staged data, in entries.
+ * @param data Where to copy the entry.
+ */
+static inline void get_fifo_staged(size_t offset,
+				   struct ec_response_motion_sensor_data *data)
+{
+	fifo_copy_out(fifo.state->tail + offset * FIFO_ENTRY_BYTES, data,
+		      FIFO_ENTRY_BYTES);
+}
+
+/**
+ * Write a staged entry. This function performs no bound checking.
+ *
+ * @param offset The offset into the staged data, in entries.
+ * @param data The entry to write.
+ */
+static inline void
+put_fifo_staged(size_t offset,
+		const struct ec_response_motion_sensor_data *data)
+{
+	fifo_copy_in(fifo.state->tail + offset * FIFO_ENTRY_BYTES, data,
+		     FIFO_ENTRY_BYTES);
+}
+
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+static uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+	while (v >= 0x80) {
+		*p++ = v | 0x80;
+		v >>= 7;
+	}
+	*p++ = v;
+	return p;
+}
+
+static uint8_t *put_zigzag(uint8_t *p, int16_t v)
+{
+	uint16_t u = v;
+
+	return put_varint(p, (uint16_t)(u << 1) ^ (uint16_t)(v >> 15));
+}
+
+static const uint8_t *get_varint(const uint8_t *p, uint32_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	do {
+		*v |= (uint32_t)(*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+	return p;
+}
+
+/** Update the previous values with an entry. */
+static void fifo_pack_update(struct fifo_pack_state *state,
+			     const struct ec_response_motion_sensor_data *v)
+{
+	if (is_timestamp(v))
+		state->timestamp = v->timestamp;
+	else if (is_data(v) && v->sensor_num < MAX_MOTION_SENSORS)
+		memcpy(state->data[v->sensor_num], v->data, sizeof(v->data));
+}
+
+/**
+ * Pack one fifo entry, see EC_MOTION_SENSE_PACKED in ec_commands.h.
+ *
+ * @param state Previous values, updated with this entry.
+ * @param v The entry to pack.
+ * @param out Output buffer, at least FIFO_ENTRY_BYTES.
+ * @return Number of bytes written to out, at most FIFO_ENTRY_BYTES.
+ */
+static int fifo_pack_entry(struct fifo_pack_state *state,
+			   const struct ec_response_motion_sensor_data *v,
+			   uint8_t *out)
+{
+	uint8_t buf[2 + 3 * 3];
+	uint8_t *p = buf;
+	const int16_t *prev;
+	int i;
+
+	if (v->flags == MOTIONSENSE_SENSOR_FLAG_TIMESTAMP &&
+	    v->sensor_num <= EC_MOTION_SENSE_PACKED_SENSOR_MASK) {
+		*p++ = EC_MOTION_SENSE_PACKED |
+		       EC_MOTION_SENSE_PACKED_TIMESTAMP | v->sensor_num;
+		p = put_varint(p, v->timestamp - state->timestamp);
+	} else if (is_data(v) && v->sensor_num < MAX_MOTION_SENSORS &&
+		   v->sensor_num < EC_MOTION_SENSE_PACKED_MAX_SENSORS) {
+		*p++ = EC_MOTION_SENSE_PACKED | v->sensor_num;
+		*p++ = v->flags;
+		prev = state->data[v->sensor_num];
+		for (i = X; i <= Z; i++)
+			p = put_zigzag(p, v->data[i] - prev[i]);
+	}
+	fifo_pack_update(state, v);
+
+	/* Fall back to the raw entry unless packing saved space. */
+	if (p == buf || p - buf >= FIFO_ENTRY_BYTES) {
+		memcpy(out, v, FIFO_ENTRY_BYTES);
+		return FIFO_ENTRY_BYTES;
+	}
+	memcpy(out, buf, p - buf);
+	return p - buf;
+}
+
+/**
+ * Unpack one fifo entry packed by fifo_pack_entry().
+ *
+ * @param state Previous values, updated with this entry.
+ * @param in The packed entry.
+ * @param v The unpacked entry.
+ * @return Number of bytes read from in.
+ */
+static int fifo_unpack_entry(struct fifo_pack_state *state, const uint8_t *in,
+			     struct ec_response_motion_sensor_data *v)
+{
+	const uint8_t *p = in;
+	uint32_t d;
+	int i;
+
+	if (!(*p & EC_MOTION_SENSE_PACKED)) {
+		memcpy(v, p, FIFO_ENTRY_BYTES);
+		p += FIFO_ENTRY_BYTES;
+	} else if (*p & EC_MOTION_SENSE_PACKED_TIMESTAMP) {
+		v->flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
+		v->sensor_num = *p++ & EC_MOTION_SENSE_PACKED_SENSOR_MASK;
+		v->reserved = 0;
+		p = get_varint(p, &d);
+		v->timestamp = state->timestamp + d;
+	} else {
+		v->sensor_num = *p++ & EC_MOTION_SENSE_PACKED_SENSOR_MASK;
+		v->flags = *p++;
+		for (i = X; i <= Z; i++) {
+			p = get_varint(p, &d);
+			v->data[i] = state->data[v->sensor_num][i] +
+				     (int16_t)((d >> 1) ^ -(d & 1));
+		}
+	}
+	fifo_pack_update(state, v);
+
+	return p - in;
+}
+#endif /* CONFIG_ACCEL_FIFO_PACKED */
+
+/**
+ * Start iterating over the committed entries from the head of the fifo.
+ *
+ * @param it The iterator to initialize.
+ */
+static void fifo_iter_head(struct fifo_iter *it)
+{
+	it->index = fifo.state->head;
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	it->state = head_state;
+#endif
+}
+
+/**
+ * Read the next committed entry. This function performs no bound checking.
  *
- * @return Pointer to the head of the fifo.
+ * @param it The iterator, advanced past the entry.
+ * @param data Where to copy the entry.
  */
-static inline struct ec_response_motion_sensor_data *get_fifo_head(void)
+static void fifo_iter_next(struct fifo_iter *it,
+			   struct ec_response_motion_sensor_data *data)
 {
-	return ((struct ec_response_motion_sensor_data *)fifo.buffer) +
-	       (fifo.state->head & fifo.buffer_units_mask);
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	uint8_t buf[FIFO_ENTRY_BYTES];
+
+	fifo_copy_out(it->index, buf, sizeof(buf));
+	it->index += fifo_unpack_entry(&it->state, buf, data);
+#else
+	fifo_copy_out(it->index, data, FIFO_ENTRY_BYTES);
+	it->index += FIFO_ENTRY_BYTES;
+#endif
+}
+
+/**
+ * Remove the committed entries up to an iterator started at the head.
+ *
+ * @param it The iterator.
+ * @param count The number of entries it was advanced over.
+ */
+static void fifo_advance_head(const struct fifo_iter *it, int count)
+{
+	queue_advance_head(&fifo, it->index - fifo.state->head);
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	head_state = it->state;
+#endif
+	fifo_count -= count;
+}
+
+/**
+ * Convenience function to get the head of the fifo, committed or staged.
+ * This function makes no guarantee on whether or not the entry is valid.
+ *
+ * @param data Where to copy the head of the fifo.
+ */
+static void get_fifo_head(struct ec_response_motion_sensor_data *data)
+{
+	struct fifo_iter it;
+
+	if (!fifo_count) {
+		get_fifo_staged(0, data);
+		return;
+	}
+	fifo_iter_head(&it);
+	fifo_iter_next(&it, data);
+}
+
+/**
+ * Check whether there is room to stage one more entry.
+ *
+ * @return True if there is, false otherwise.
+ */
+static inline bool fifo_has_space(void)
+{
+	return queue_space(&fifo) >= (fifo_staged.count + 1) * FIFO_ENTRY_BYTES;
 }
 
 /**
@@ -155,20 +449,29 @@ static inline struct ec_response_motion_sensor_data *get_fifo_head(void)
  */
 static void fifo_pop(void)
 {
-	struct ec_response_motion_sensor_data *head = get_fifo_head();
-	const size_t initial_count = queue_count(&fifo);
+	struct ec_response_motion_sensor_data entry;
+	struct ec_response_motion_sensor_data *head = &entry;
+	const int initial_count = fifo_count;
+	struct fifo_iter it;
 
 	/* Check that we have something to pop. */
 	if (!initial_count && !fifo_staged.count)
 		return;
 
-	/*
-	 * If all the data is staged (nothing in the committed queue), we'll
-	 * need to move the head and the tail over to simulate poping from the
-	 * staged data.
-	 */
-	if (!initial_count)
-		queue_advance_tail(&fifo, 1);
+	if (initial_count) {
+		fifo_iter_head(&it);
+		fifo_iter_next(&it, head);
+		fifo_advance_head(&it, 1);
+	} else {
+		/*
+		 * If all the data is staged (nothing in the committed queue),
+		 * we'll need to move the head and the tail over to simulate
+		 * poping from the staged data.
+		 */
+		get_fifo_staged(0, head);
+		queue_advance_tail(&fifo, FIFO_ENTRY_BYTES);
+		queue_advance_head(&fifo, FIFO_ENTRY_BYTES);
+	}
 
 	/*
 	 * If we're about to pop a wakeup flag, we should remember it as though
@@ -176,11 +479,8 @@ static void fifo_pop(void)
 	 */
 	if (head->flags & MOTIONSENSE_SENSOR_FLAG_WAKEUP)
 		wake_up_needed = 1;
-	/*
-	 * By not using queue_remove_unit we're avoiding an un-necessary memcpy.
-	 */
-	queue_advance_head(&fifo, 1);
 	fifo_lost++;
+	fifo_total_dropped++;
 
 	/* Increment lost counter if we have valid data. */
 	if (!is_timestamp(head))
@@ -221,26 +521,31 @@ static void fifo_pop(void)
  */
 static void fifo_ensure_space(void)
 {
+	struct ec_response_motion_sensor_data head;
+
 	/* If we already have space just bail. */
-	if (queue_space(&fifo) > fifo_staged.count)
+	if (fifo_has_space())
 		return;
 
 	/*
-	 * Pop at least 1 spot, but if all the following conditions are met we
-	 * will continue to pop:
+	 * Pop until there is space, but if all the following conditions are
+	 * met we will continue to pop:
 	 * 1. We're operating with tight timestamps.
 	 * 2. The new head isn't a timestamp.
 	 * 3. We have data that we can possibly pop.
 	 *
 	 * Removing more than one entry is needed because if we are using tight
 	 * timestamps and we pop a timestamp, then the next head is data, the AP
-	 * would assign a bad timestamp to it.
+	 * would assign a bad timestamp to it. Packed entries can be smaller
+	 * than the entry being staged, so a single pop may not be enough.
 	 */
 	do {
 		fifo_pop();
-	} while (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
-		 !is_timestamp(get_fifo_head()) &&
-		 queue_count(&fifo) + fifo_staged.count);
+		get_fifo_head(&head);
+	} while ((!fifo_has_space() ||
+		  (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
+		   !is_timestamp(&head))) &&
+		 fifo_count + fifo_staged.count);
 }
 
 /**
@@ -268,7 +573,6 @@ static inline bool is_new_timestamp(uint8_t sensor_num)
 static void fifo_stage_unit(struct ec_response_motion_sensor_data *data,
 			    struct motion_sensor_t *sensor, int valid_data)
 {
-	struct queue_chunk chunk;
 	int i;
 
 	if (valid_data > 0 && !sensor)
@@ -319,34 +623,28 @@ static void fifo_stage_unit(struct ec_response_motion_sensor_data *data,
 					MOTIONSENSE_SENSOR_FLAG_TABLET_MODE :
 					0);
 
-	/*
-	 * Get the next writable block in the fifo. We don't need to lock this
-	 * because it will always be past the tail and thus the AP will never
-	 * read this until motion_sense_fifo_commit_data() is called.
-	 */
-	chunk = queue_get_write_chunk(&fifo, fifo_staged.count);
-
-	if (!chunk.buffer) {
+	if (!fifo_has_space()) {
 		/*
 		 * This should never happen since we already ensured there was
-		 * space, but if there was a bug, we don't want to write to
-		 * address 0. Just don't add any data to the queue instead.
+		 * space, but if there was a bug, we don't want to overwrite
+		 * committed data. Just don't add any data to the queue instead.
 		 */
-		CPRINTS("Failed to get write chunk for new fifo data!");
+		CPRINTS("No space for new fifo data!");
 		mutex_unlock(&g_sensor_mutex);
 		return;
 	}
 
 	/*
-	 * Save the data to the writable block and increment count. This data
-	 * will now reside AFTER the tail of the queue and will not be visible
-	 * to the AP until the motion_sense_fifo_commit_data() function is
-	 * called. Because count is incremented, the following staged data will
-	 * be written to the next available block and this one will remain
-	 * staged.
+	 * Save the data after the staged entries and increment count. We
+	 * don't need to lock this because it will reside AFTER the tail of the
+	 * queue and will not be visible to the AP until the
+	 * motion_sense_fifo_commit_data() function is called. Because count is
+	 * incremented, the following staged data will be written to the next
+	 * available block and this one will remain staged.
 	 */
-	memcpy(chunk.buffer, data, fifo.unit_bytes);
+	put_fifo_staged(fifo_staged.count, data);
 	fifo_staged.count++;
+	fifo_total_staged++;
 
 	/*
 	 * If we're using tight timestamps, and the current entry isn't a
@@ -379,18 +677,35 @@ static void fifo_stage_timestamp(uint32_t timestamp, uint8_t sensor_num)
 }
 
 /**
- * Peek into the staged data at a given offset. This function performs no bound
- * checking and is purely for confinience.
+ * Move the staged entries behind the tail of the fifo, packing them with
+ * CONFIG_ACCEL_FIFO_PACKED.
  *
- * @param offset The offset into the staged data to peek into.
- * @return Pointer to the entry at the given offset.
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
  */
-static inline struct ec_response_motion_sensor_data *
-peek_fifo_staged(size_t offset)
+static void fifo_commit_staged(void)
 {
-	return (struct ec_response_motion_sensor_data *)queue_get_write_chunk(
-		       &fifo, offset)
-		.buffer;
+	size_t size;
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	struct ec_response_motion_sensor_data data;
+	uint8_t buf[FIFO_ENTRY_BYTES];
+	int i, len;
+
+	/*
+	 * Pack in place: a packed entry is never larger than the staged one,
+	 * so it can't overwrite entries that haven't been read yet.
+	 */
+	for (i = 0, size = 0; i < fifo_staged.count; i++) {
+		get_fifo_staged(i, &data);
+		len = fifo_pack_entry(&tail_state, &data, buf);
+		fifo_copy_in(fifo.state->tail + size, buf, len);
+		size += len;
+	}
+#else
+	size = fifo_staged.count * FIFO_ENTRY_BYTES;
+#endif
+	queue_advance_tail(&fifo, size);
+	fifo_count += fifo_staged.count;
 }
 
 void motion_sense_fifo_init(void)
@@ -474,7 +789,7 @@ void motion_sense_fifo_stage_data(struct ec_response_motion_sensor_data *data,
 
 void motion_sense_fifo_commit_data(void)
 {
-	struct ec_response_motion_sensor_data *data;
+	struct ec_response_motion_sensor_data data, ts;
 	int i, window, sensor_num;
 
 	/* Nothing staged, no work to do. */
@@ -490,7 +805,7 @@ void motion_sense_fifo_commit_data(void)
 	if (!fifo_staged.requires_spreading)
 		goto commit_data_end;
 
-	data = peek_fifo_staged(0);
+	get_fifo_staged(0, &data);
 
 	/*
 	 * Spreading only makes sense if tight timestamps are used. In such case
@@ -498,13 +813,13 @@ void motion_sense_fifo_commit_data(void)
 	 * entry isn't a timestamp we must have gotten out of sync. Just commit
 	 * all the data and skip the spreading.
 	 */
-	if (!is_timestamp(data)) {
+	if (!is_timestamp(&data)) {
 		CPRINTS("Spreading skipped, first entry is not a timestamp");
 		fifo_staged.requires_spreading = 0;
 		goto commit_data_end;
 	}
 
-	window = time_until(data->timestamp, fifo_staged.read_ts);
+	window = time_until(data.timestamp, fifo_staged.read_ts);
 
 	/* Update the data_periods as needed for this flush. */
 	for (i = 0; i < MAX_MOTION_SENSORS; i++) {
@@ -537,24 +852,25 @@ commit_data_end:
 	 * the timestamp right before it to keep things correct.
 	 */
 	for (i = 0; i < fifo_staged.count; i++) {
-		data = peek_fifo_staged(i);
-		if (data->flags & MOTIONSENSE_SENSOR_FLAG_BYPASS_FIFO)
+		get_fifo_staged(i, &data);
+		if (data.flags & MOTIONSENSE_SENSOR_FLAG_BYPASS_FIFO)
 			bypass_needed = 1;
-		if (data->flags & MOTIONSENSE_SENSOR_FLAG_WAKEUP)
+		if (data.flags & MOTIONSENSE_SENSOR_FLAG_WAKEUP)
 			wake_up_needed = 1;
 
 		/*
 		 * Skip non-data entries, we don't know the sensor number yet.
 		 */
-		if (!is_data(data))
+		if (!is_data(&data))
 			continue;
 
-		/* Get the sensor number and point to the timestamp entry. */
-		sensor_num = data->sensor_num;
-		data = peek_fifo_staged(i - 1);
+		/* Get the sensor number and the timestamp entry before it. */
+		sensor_num = data.sensor_num;
+		if (i > 0)
+			get_fifo_staged(i - 1, &ts);
 
 		/* Verify we're pointing at a timestamp. */
-		if (!is_timestamp(data)) {
+		if (i == 0 || !is_timestamp(&ts)) {
 			CPRINTS("FIFO entries out of order,"
 				" expected timestamp");
 			continue;
@@ -566,14 +882,14 @@ commit_data_end:
 		 * ahead.
 		 */
 		if (is_new_timestamp(sensor_num) ||
-		    time_after(data->timestamp,
-			       next_timestamp[sensor_num].prev)) {
-			next_timestamp[sensor_num].next = data->timestamp;
+		    time_after(ts.timestamp, next_timestamp[sensor_num].prev)) {
+			next_timestamp[sensor_num].next = ts.timestamp;
 			next_timestamp_initialized |= BIT(sensor_num);
 		}
 
 		/* Spread the timestamp and compute the expected next. */
-		data->timestamp = next_timestamp[sensor_num].next;
+		ts.timestamp = next_timestamp[sensor_num].next;
+		put_fifo_staged(i - 1, &ts);
 		next_timestamp[sensor_num].prev =
 			next_timestamp[sensor_num].next;
 		next_timestamp[sensor_num].next +=
@@ -582,15 +898,14 @@ commit_data_end:
 				expected_data_periods[sensor_num];
 
 		/* Update online calibration if enabled. */
-		data = peek_fifo_staged(i);
 		if (IS_ENABLED(CONFIG_ONLINE_CALIB))
 			online_calibration_process_data(
-				data, &motion_sensors[sensor_num],
+				&data, &motion_sensors[sensor_num],
 				next_timestamp[sensor_num].prev);
 	}
 
 	/* Advance the tail and clear the staged metadata. */
-	queue_advance_tail(&fifo, fifo_staged.count);
+	fifo_commit_staged();
 
 	/* Reset metadata for next staging cycle. */
 	memset(&fifo_staged, 0, sizeof(fifo_staged));
@@ -599,17 +914,23 @@ commit_data_end:
 }
 
 void motion_sense_fifo_get_info(
-	struct ec_response_motion_sense_fifo_info *fifo_info, int reset)
+	struct ec_response_motion_sense_fifo_info *fifo_info,
+	struct ec_response_motion_sense_fifo_stats *stats, int reset)
 {
 	int i;
 
 	mutex_lock(&g_sensor_mutex);
-	fifo_info->size = fifo.buffer_units;
-	fifo_info->count = queue_count(&fifo);
+	fifo_info->size = fifo.buffer_units / FIFO_MIN_ENTRY_BYTES;
+	fifo_info->count = fifo_count;
 	fifo_info->total_lost = fifo_lost;
 	for (i = 0; i < MAX_MOTION_SENSORS; i++) {
 		fifo_info->lost[i] = fifo_sensor_lost[i];
 	}
+	/* After lost[], which it may overlap. */
+	if (stats) {
+		stats->total_staged = fifo_total_staged;
+		stats->total_dropped = fifo_total_dropped;
+	}
 	mutex_unlock(&g_sensor_mutex);
 #ifdef CONFIG_MKBP_EVENT
 	fifo_info->timestamp = mkbp_last_event_time;
@@ -627,7 +948,7 @@ static int motion_sense_get_next_event(uint8_t *out)
 	union ec_response_get_next_data *data =
 		(union ec_response_get_next_data *)out;
 	/* out is not padded. It has one byte for the event type */
-	motion_sense_fifo_get_info(&data->sensor_fifo.info, 0);
+	motion_sense_fifo_get_info(&data->sensor_fifo.info, NULL, 0);
 	return sizeof(data->sensor_fifo);
 }
 /* LCOV_EXCL_STOP */
@@ -638,7 +959,8 @@ inline int motion_sense_fifo_over_thres(void)
 	int result;
 
 	mutex_lock(&g_sensor_mutex);
-	result = queue_space(&fifo) < CONFIG_ACCEL_FIFO_THRES;
+	result = queue_space(&fifo) <
+		 CONFIG_ACCEL_FIFO_THRES * FIFO_ENTRY_BYTES;
 	mutex_unlock(&g_sensor_mutex);
 
 	return result;
@@ -647,18 +969,53 @@ inline int motion_sense_fifo_over_thres(void)
 int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 			   uint16_t *out_size)
 {
-	int count;
+	struct ec_response_motion_sensor_data *data = out;
+	struct fifo_iter it;
+	int count, i;
 
 	mutex_lock(&g_sensor_mutex);
-	count = MIN(capacity_bytes / fifo.unit_bytes,
-		    MIN(queue_count(&fifo), max_count));
-	count = queue_remove_units(&fifo, out, count);
+	count = MIN(capacity_bytes / (int)FIFO_ENTRY_BYTES, fifo_count);
+	count = MIN((unsigned int)count, (unsigned int)max_count);
+	fifo_iter_head(&it);
+	for (i = 0; i < count; i++)
+		fifo_iter_next(&it, &data[i]);
+	fifo_advance_head(&it, count);
 	mutex_unlock(&g_sensor_mutex);
-	*out_size = count * fifo.unit_bytes;
+	*out_size = count * FIFO_ENTRY_BYTES;
 
 	return count;
 }
 
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+int motion_sense_fifo_read_packed(int capacity_bytes, int max_count, void *out,
+				  uint16_t *out_size)
+{
+	struct fifo_pack_state state = {};
+	struct ec_response_motion_sensor_data v;
+	struct fifo_iter it;
+	uint8_t *p = out;
+	int count, len;
+
+	mutex_lock(&g_sensor_mutex);
+	max_count = MIN((unsigned int)fifo_count, (unsigned int)max_count);
+	fifo_iter_head(&it);
+	/* Stop while there is still room for the largest entry. */
+	for (count = 0; count < max_count &&
+			capacity_bytes >= (int)FIFO_ENTRY_BYTES;
+	     count++) {
+		fifo_iter_next(&it, &v);
+		len = fifo_pack_entry(&state, &v, p);
+		p += len;
+		capacity_bytes -= len;
+	}
+	fifo_advance_head(&it, count);
+	mutex_unlock(&g_sensor_mutex);
+	*out_size = p - (uint8_t *)out;
+
+	return count;
+}
+#endif /* CONFIG_ACCEL_FIFO_PACKED */
+
 void motion_sense_fifo_reset(void)
 {
 	static uint8_t fifo_info_buffer
@@ -671,7 +1028,14 @@ void motion_sense_fifo_reset(void)
 	memset(&fifo_staged, 0, sizeof(fifo_staged));
 	motion_sense_fifo_init();
 	queue_init(&fifo);
-	motion_sense_fifo_get_info(fifo_info, /*reset=*/true);
+	fifo_count = 0;
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	memset(&head_state, 0, sizeof(head_state));
+	memset(&tail_state, 0, sizeof(tail_state));
+#endif
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/true);
+	fifo_total_staged = 0;
+	fifo_total_dropped = 0;
 }
 
 void motion_sense_set_data_period(int sensor_num, uint32_t data_period)
@@ -694,14 +1058,16 @@ static int motion_sense_read_fifo(int argc, char **argv)
 {
 	int count, i;
 	struct ec_response_motion_sensor_data v;
+	struct fifo_iter it;
 
 	if (argc < 1)
 		return EC_ERROR_PARAM_COUNT;
 
 	/* Limit the amount of data to avoid saturating the UART buffer */
-	count = MIN(queue_count(&fifo), 16);
+	count = MIN(fifo_count, 16);
+	fifo_iter_head(&it);
 	for (i = 0; i < count; i++) {
-		queue_peek_units(&fifo, &v, i, 1);
+		fifo_iter_next(&it, &v);
 		if (v.flags & (MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
 			       MOTIONSENSE_SENSOR_FLAG_FLUSH)) {
 			uint64_t timestamp;
@@ -56,6 +56,27 @@ void pd_log_recv_vdm(int port, int cnt, uint32_t *payload)
 	}
 }
 
+/*
+ * Ask connected accessories for their log entries, which land in our log.
+ * Returns EC_RES_BUSY if the host should retry later.
+ */
+static enum ec_status fetch_acc_log_entries(void)
+{
+	int i, res;
+
+	incoming_logs = 0;
+	for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
+		/* only accessories who knows Google logging format */
+		if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
+			continue;
+		res = pd_fetch_acc_log_entry(i);
+		if (res == EC_RES_BUSY) /* host should retry */
+			return EC_RES_BUSY;
+	}
+
+	return EC_RES_SUCCESS;
+}
+
 /* we are a PD MCU/EC, send back the events to the host */
 static enum ec_status hc_pd_get_log_entry(struct host_cmd_handler_args *args)
 {
@@ -65,16 +86,8 @@ dequeue_retry:
 	args->response_size = log_dequeue_event((struct event_log_entry *)r);
 	/* if the MCU log no longer has entries, try connected accessories */
 	if (r->type == PD_EVENT_NO_ENTRY) {
-		int i, res;
-		incoming_logs = 0;
-		for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
-			/* only accessories who knows Google logging format */
-			if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
-				continue;
-			res = pd_fetch_acc_log_entry(i);
-			if (res == EC_RES_BUSY) /* host should retry */
-				return EC_RES_BUSY;
-		}
+		if (fetch_acc_log_entries() == EC_RES_BUSY)
+			return EC_RES_BUSY;
 		/* we have received new entries from an accessory */
 		if (incoming_logs)
 			goto dequeue_retry;
@@ -86,6 +99,72 @@ dequeue_retry:
 DECLARE_HOST_COMMAND(EC_CMD_PD_GET_LOG_ENTRY, hc_pd_get_log_entry,
 		     EC_VER_MASK(0));
 
+static enum ec_status
+hc_pd_get_log_entries_v1(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_pd_get_log_entries_v1 *p = args->params;
+	struct ec_response_pd_get_log_entries_v1 *r = args->response;
+	int max = args->response_max - sizeof(*r);
+	uint32_t cursor;
+	int size;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+	if (max < (int)EVENT_LOG_MAX_ENTRY_SIZE)
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	cursor = (p->flags & EC_PD_LOG_ENTRIES_OLDEST) ? log_oldest_cursor() :
+							  p->cursor;
+	size = log_read_events(&cursor, r->entries, max);
+	if (size < 0)
+		return EC_RES_INVALID_PARAM;
+	/* if the MCU log has nothing new, try connected accessories */
+	if (!size) {
+		if (fetch_acc_log_entries() == EC_RES_BUSY)
+			return EC_RES_BUSY;
+		if (incoming_logs)
+			size = log_read_events(&cursor, r->entries, max);
+	}
+
+	r->cursor = cursor;
+	r->next_cursor = cursor + size / sizeof(struct event_log_entry);
+	r->dropped = log_clear_dropped();
+	r->size = size;
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + size;
+
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status hc_pd_get_log_entries(struct host_cmd_handler_args *args)
+{
+	struct ec_response_pd_get_log_entries *r = args->response;
+	int max = args->response_max - sizeof(*r);
+
+	if (args->version == 1)
+		return hc_pd_get_log_entries_v1(args);
+
+	if (max < (int)EVENT_LOG_MAX_ENTRY_SIZE)
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	r->size = log_dequeue_events(r->entries, max);
+	/* if the MCU log is empty, try connected accessories */
+	if (!r->size) {
+		if (fetch_acc_log_entries() == EC_RES_BUSY)
+			return EC_RES_BUSY;
+		if (incoming_logs)
+			r->size = log_dequeue_events(r->entries, max);
+	}
+	r->dropped = log_clear_dropped();
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + r->size;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_PD_GET_LOG_ENTRIES,
+			     hc_pd_get_log_entries,
+			     EC_VER_MASK(0) | EC_VER_MASK(1));
+
 static enum ec_status hc_pd_write_log_entry(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_pd_write_log_entry *p = args->params;
@@ -36,6 +36,37 @@ static int hexdigit(int c)
 #define PF_SIGN BIT(2) /* Add sign (+) for a positive number */
 #define PF_64BIT BIT(3) /* Number is 64-bit */
 
+/*
+ * Divide by 10 with multiplications by the reciprocal (the usual compiler
+ * trick), since Cortex-M has no 64-bit divider and M0 has no divider at all.
+ * Returns the remainder.
+ */
+static int div10(uint64_t *val)
+{
+	uint64_t v = *val, q;
+	uint32_t lo, hi;
+
+	if (v <= UINT32_MAX) {
+		/* A single 32x32->64 multiply */
+		q = ((uint64_t)(uint32_t)v * 0xcccccccdU) >> 35;
+	} else {
+		/* High half of v * 0xcccccccccccccccd, from 32-bit products */
+		uint64_t lo_lo, hi_lo, lo_hi, hi_hi, mid;
+
+		lo = v;
+		hi = v >> 32;
+		lo_lo = (uint64_t)lo * 0xcccccccdU;
+		hi_lo = (uint64_t)hi * 0xcccccccdU;
+		lo_hi = (uint64_t)lo * 0xccccccccU;
+		hi_hi = (uint64_t)hi * 0xccccccccU;
+		mid = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+		q = (hi_hi + (hi_lo >> 32) + (mid >> 32)) >> 3;
+	}
+
+	*val = q;
+	return v - q * 10;
+}
+
 test_export_static char *uint64_to_str(char *buf, int buf_len, uint64_t val,
 				       int precision, int base, bool uppercase)
 {
@@ -69,7 +100,7 @@ test_export_static char *uint64_to_str(char *buf, int buf_len, uint64_t val,
 	 * Handle digits to right of decimal for fixed point numbers.
 	 */
 	for (i = 0; i < precision; i++)
-		*(--str) = '0' + uint64divmod(&val, 10);
+		*(--str) = '0' + div10(&val);
 	if (precision >= 0)
 		*(--str) = '.';
 
@@ -82,7 +113,14 @@ test_export_static char *uint64_to_str(char *buf, int buf_len, uint64_t val,
 		if (str <= buf)
 			return NULL;
 
-		digit = uint64divmod(&val, base);
+		if (base == 10) {
+			digit = div10(&val);
+		} else if (base == 16) {
+			digit = val & 0xf;
+			val >>= 4;
+		} else {
+			digit = uint64divmod(&val, base);
+		}
 		if (digit < 10)
 			*(--str) = '0' + digit;
 		else if (uppercase)
@@ -102,7 +140,6 @@ int snprintf_timestamp_now(char *str, size_t size)
 int snprintf_timestamp(char *str, size_t size, uint64_t timestamp)
 {
 	int len;
-	int precision;
 	char *tmp_str;
 	char tmp_buf[PRINTF_TIMESTAMP_BUF_SIZE];
 	int base = 10;
@@ -113,19 +150,17 @@ int snprintf_timestamp(char *str, size_t size, uint64_t timestamp)
 	/* Ensure string has terminating '\0' in error cases. */
 	str[0] = '\0';
 
-	if (IS_ENABLED(CONFIG_CONSOLE_VERBOSE)) {
-		precision = 6;
-	} else {
-		precision = 3;
-		timestamp /= 1000;
-	}
-
-	tmp_str = uint64_to_str(tmp_buf, sizeof(tmp_buf), timestamp, precision,
-				base, false);
+	tmp_str = uint64_to_str(tmp_buf, sizeof(tmp_buf), timestamp, 6, base,
+				false);
 	if (!tmp_str)
 		return -EC_ERROR_OVERFLOW;
 
 	len = strlen(tmp_str);
+	/* Print ms by dropping digits, rather than a 64-bit division. */
+	if (!IS_ENABLED(CONFIG_CONSOLE_VERBOSE)) {
+		len -= 3;
+		tmp_str[len] = '\0';
+	}
 	if (len + 1 > size)
 		return -EC_ERROR_OVERFLOW;
 
@@ -223,8 +258,59 @@ int snprintf_hex_buffer(char *str, size_t size,
 	return (rv == EC_SUCCESS) ? (context.str - str) : -rv;
 }
 
-int vfnprintf(int (*addchar)(void *context, int c), void *context,
-	      const char *format, va_list args)
+/* Where vfnprintf() output goes */
+struct printf_output {
+	/* Called for each character, when there is no buffer */
+	int (*addchar)(void *context, int c);
+	void *context;
+	/* Buffer taking runs of characters at once, and the room left in it */
+	char *str;
+	size_t size;
+};
+
+static int output_str(struct printf_output *out, const char *s, int len)
+{
+	int n;
+
+	if (out->str) {
+		n = MIN(len, out->size);
+		memcpy(out->str, s, n);
+		out->str += n;
+		out->size -= n;
+		return n < len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	}
+
+	while (len-- > 0) {
+		if (out->addchar(out->context, *s++))
+			return EC_ERROR_OVERFLOW;
+	}
+	return EC_SUCCESS;
+}
+
+static int output_fill(struct printf_output *out, int c, int len)
+{
+	int n;
+
+	if (len <= 0)
+		return EC_SUCCESS;
+
+	if (out->str) {
+		n = MIN(len, out->size);
+		memset(out->str, c, n);
+		out->str += n;
+		out->size -= n;
+		return n < len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	}
+
+	while (len--) {
+		if (out->addchar(out->context, c))
+			return EC_ERROR_OVERFLOW;
+	}
+	return EC_SUCCESS;
+}
+
+static int vfnprintf_output(struct printf_output *out, const char *format,
+			    va_list args)
 {
 	/*
 	 * Longest uint64 in decimal = 20
@@ -240,15 +326,18 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	int vlen;
 
 	while (*format) {
-		int c = *format++;
+		const char *run = format;
 		char sign = 0;
+		int c;
 
-		/* Copy normal characters */
-		if (c != '%') {
-			if (addchar(context, c))
-				return EC_ERROR_OVERFLOW;
-			continue;
-		}
+		/* Copy normal characters up to the next format at once */
+		while (*format && *format != '%')
+			format++;
+		if (output_str(out, run, format - run))
+			return EC_ERROR_OVERFLOW;
+		if (!*format)
+			break;
+		format++;
 
 		/* Zero flags, now that we're in a format */
 		flags = 0;
@@ -258,7 +347,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 
 		/* Send "%" for "%%" input */
 		if (c == '%' || c == '\0') {
-			if (addchar(context, '%'))
+			if (output_str(out, "%", 1))
 				return EC_ERROR_OVERFLOW;
 
 			if (c == '\0')
@@ -269,8 +358,9 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 
 		/* Handle %c */
 		if (c == 'c') {
-			c = va_arg(args, int);
-			if (addchar(context, c))
+			char ch = va_arg(args, int);
+
+			if (output_str(out, &ch, 1))
 				return EC_ERROR_OVERFLOW;
 			continue;
 		}
@@ -459,33 +549,46 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		if (precision >= 0 && pad_width > precision)
 			pad_width = precision;
 
-		if (precision < 0) {
-			/* If precision is unset, print everything */
-			vlen = strlen(vstr);
-			precision = MAX(vlen, pad_width);
-		} else {
-			/*
-			 * If precision is set, ensure that we do not
-			 * overrun it
-			 */
-			vlen = strnlen(vstr, precision);
-		}
+		/* If precision is set, ensure that we do not overrun it */
+		vlen = precision < 0 ? strlen(vstr) : strnlen(vstr, precision);
 
-		while (vlen < pad_width && !(flags & PF_LEFT)) {
-			if (addchar(context, flags & PF_PADZERO ? '0' : ' '))
-				return EC_ERROR_OVERFLOW;
-			vlen++;
-		}
-		while (--precision >= 0 && *vstr)
-			if (addchar(context, *vstr++))
-				return EC_ERROR_OVERFLOW;
-		while (vlen < pad_width && flags & PF_LEFT) {
-			if (addchar(context, ' '))
-				return EC_ERROR_OVERFLOW;
-			vlen++;
-		}
+		if (!(flags & PF_LEFT) &&
+		    output_fill(out, flags & PF_PADZERO ? '0' : ' ',
+				pad_width - vlen))
+			return EC_ERROR_OVERFLOW;
+		if (output_str(out, vstr, vlen))
+			return EC_ERROR_OVERFLOW;
+		if ((flags & PF_LEFT) &&
+		    output_fill(out, ' ', pad_width - vlen))
+			return EC_ERROR_OVERFLOW;
 	}
 
 	/* If we're still here, we consumed all output */
 	return EC_SUCCESS;
 }
+
+int vfnprintf(int (*addchar)(void *context, int c), void *context,
+	      const char *format, va_list args)
+{
+	struct printf_output out = {
+		.addchar = addchar,
+		.context = context,
+	};
+
+	return vfnprintf_output(&out, format, args);
+}
+
+int vfnprintf_buf(char **str, size_t *size, const char *format, va_list args)
+{
+	struct printf_output out = {
+		.str = *str,
+		.size = *size,
+	};
+	int rv;
+
+	rv = vfnprintf_output(&out, format, args);
+	*str = out.str;
+	*size = out.size;
+
+	return rv;
+}
@@ -21,6 +21,22 @@ struct queue_policy const queue_policy_null = {
 	.remove = queue_action_null,
 };
 
+/*
+ * The producer owns state->tail and the consumer owns state->head.  The other
+ * side's index is loaded with acquire semantics before the buffer is touched,
+ * and an index is stored with release semantics only after the buffer has
+ * been written or read.
+ */
+static inline size_t queue_load_index(volatile size_t *index)
+{
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void queue_store_index(volatile size_t *index, size_t value)
+{
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
 void queue_init(struct queue const *q)
 {
 	ASSERT(q->policy);
@@ -33,12 +49,13 @@ void queue_init(struct queue const *q)
 
 int queue_is_empty(struct queue const *q)
 {
-	return q->state->head == q->state->tail;
+	return queue_count(q) == 0;
 }
 
 size_t queue_count(struct queue const *q)
 {
-	return q->state->tail - q->state->head;
+	return queue_load_index(&q->state->tail) -
+	       queue_load_index(&q->state->head);
 }
 
 size_t queue_space(struct queue const *q)
@@ -74,13 +91,15 @@ int queue_is_full(struct queue const *q)
 
 struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = (q->state->tail + offset) & q->buffer_units_mask;
+	size_t head_idx = queue_load_index(&q->state->head);
+	size_t tail_idx = q->state->tail;
+	size_t head = head_idx & q->buffer_units_mask;
+	size_t tail = (tail_idx + offset) & q->buffer_units_mask;
 	size_t last = (tail < head) ? head : /* Wrapped        */
 				      q->buffer_units; /* Normal | Empty */
 
 	/* Make sure that the offset doesn't exceed free space. */
-	if (queue_space(q) <= offset)
+	if (q->buffer_units - (tail_idx - head_idx) <= offset)
 		return ((struct queue_chunk){
 			.count = 0,
 			.buffer = NULL,
@@ -94,9 +113,11 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 
 struct queue_chunk queue_get_read_chunk(struct queue const *q)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = q->state->tail & q->buffer_units_mask;
-	size_t last = (queue_is_empty(q) ? head : /* Empty          */
+	size_t head_idx = q->state->head;
+	size_t tail_idx = queue_load_index(&q->state->tail);
+	size_t head = head_idx & q->buffer_units_mask;
+	size_t tail = tail_idx & q->buffer_units_mask;
+	size_t last = ((head_idx == tail_idx) ? head : /* Empty          */
 			       ((head < tail) ? tail : /* Normal         */
 					q->buffer_units)); /* Wrapped | Full */
 
@@ -110,7 +131,7 @@ size_t queue_advance_head(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_count(q));
 
-	q->state->head += transfer;
+	queue_store_index(&q->state->head, q->state->head + transfer);
 
 	q->policy->remove(q->policy, transfer);
 
@@ -121,13 +142,67 @@ size_t queue_advance_tail(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_space(q));
 
-	q->state->tail += transfer;
+	queue_store_index(&q->state->tail, q->state->tail + transfer);
 
 	q->policy->add(q->policy, transfer);
 
 	return transfer;
 }
 
+size_t queue_spsc_add(struct queue const *q, const void *src, size_t count)
+{
+	size_t tail = q->state->tail;
+	size_t space = q->buffer_units -
+		       (tail - queue_load_index(&q->state->head));
+	size_t transfer = MIN(count, space);
+	size_t offset = tail & q->buffer_units_mask;
+	size_t first = MIN(transfer, q->buffer_units - offset);
+	uint8_t *dest = q->buffer + offset * q->unit_bytes;
+
+	if (transfer == 1 && q->unit_bytes == 1) {
+		*dest = *(const uint8_t *)src;
+	} else {
+		memcpy(dest, src, first * q->unit_bytes);
+		if (first < transfer)
+			memcpy(q->buffer,
+			       (const uint8_t *)src + first * q->unit_bytes,
+			       (transfer - first) * q->unit_bytes);
+	}
+
+	queue_store_index(&q->state->tail, tail + transfer);
+
+	if (q->policy != &queue_policy_null)
+		q->policy->add(q->policy, transfer);
+
+	return transfer;
+}
+
+size_t queue_spsc_remove(struct queue const *q, void *dest, size_t count)
+{
+	size_t head = q->state->head;
+	size_t available = queue_load_index(&q->state->tail) - head;
+	size_t transfer = MIN(count, available);
+	size_t offset = head & q->buffer_units_mask;
+	size_t first = MIN(transfer, q->buffer_units - offset);
+	const uint8_t *src = q->buffer + offset * q->unit_bytes;
+
+	if (transfer == 1 && q->unit_bytes == 1) {
+		*(uint8_t *)dest = *src;
+	} else {
+		memcpy(dest, src, first * q->unit_bytes);
+		if (first < transfer)
+			memcpy((uint8_t *)dest + first * q->unit_bytes,
+			       q->buffer, (transfer - first) * q->unit_bytes);
+	}
+
+	queue_store_index(&q->state->head, head + transfer);
+
+	if (q->policy != &queue_policy_null)
+		q->policy->remove(q->policy, transfer);
+
+	return transfer;
+}
+
 size_t queue_add_unit(struct queue const *q, const void *src)
 {
 	size_t tail = q->state->tail & q->buffer_units_mask;
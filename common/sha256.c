@@ -74,15 +74,37 @@
 		       w[i - 16];                                              \
 	}
 
-#define SHA256_EXP(a, b, c, d, e, f, g, h, j)                             \
-	{                                                                 \
-		t1 = wv[h] + SHA256_F2(wv[e]) + CH(wv[e], wv[f], wv[g]) + \
-		     sha256_k[j] + w[j];                                  \
-		t2 = SHA256_F1(wv[a]) + MAJ(wv[a], wv[b], wv[c]);         \
-		wv[d] += t1;                                              \
-		wv[h] = t1 + t2;                                          \
+/*
+ * Unrolled round: the working variables are passed in rotated order instead of
+ * being shuffled through an array, and the message schedule is kept in a
+ * rolling 16-word window so only 64 bytes of stack are needed for it.
+ */
+#define SHA256_W(j)                                                    \
+	(w[(j) & 15] += SHA256_F4(w[((j) - 2) & 15]) + w[((j) - 7) & 15] + \
+			SHA256_F3(w[((j) - 15) & 15]))
+
+#define SHA256_RND(a, b, c, d, e, f, g, h, j, wj)                            \
+	{                                                                    \
+		t1 = h + SHA256_F2(e) + CH(e, f, g) + sha256_k[j] + (wj);    \
+		t2 = SHA256_F1(a) + MAJ(a, b, c);                            \
+		d += t1;                                                     \
+		h = t1 + t2;                                                 \
+	}
+
+#define SHA256_RND8(j, W)                                      \
+	{                                                      \
+		SHA256_RND(a, b, c, d, e, f, g, h, j, W(j));         \
+		SHA256_RND(h, a, b, c, d, e, f, g, j + 1, W(j + 1)); \
+		SHA256_RND(g, h, a, b, c, d, e, f, j + 2, W(j + 2)); \
+		SHA256_RND(f, g, h, a, b, c, d, e, j + 3, W(j + 3)); \
+		SHA256_RND(e, f, g, h, a, b, c, d, j + 4, W(j + 4)); \
+		SHA256_RND(d, e, f, g, h, a, b, c, j + 5, W(j + 5)); \
+		SHA256_RND(c, d, e, f, g, h, a, b, j + 6, W(j + 6)); \
+		SHA256_RND(b, c, d, e, f, g, h, a, j + 7, W(j + 7)); \
 	}
 
+#define SHA256_W0(j) (w[j])
+
 static const uint32_t sha256_h0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372,
 				       0xa54ff53a, 0x510e527f, 0x9b05688c,
 				       0x1f83d9ab, 0x5be0cd19 };
@@ -112,6 +134,47 @@ void SHA256_init(struct sha256_ctx *ctx)
 	ctx->tot_len = 0;
 }
 
+#ifdef CONFIG_SHA256_UNROLLED
+static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
+			     unsigned int block_nb)
+{
+	uint32_t w[16];
+	uint32_t a, b, c, d, e, f, g, h;
+	uint32_t t1, t2;
+	const unsigned char *sub_block;
+	int i, j;
+
+	for (i = 0; i < (int)block_nb; i++) {
+		sub_block = message + (i << 6);
+
+		for (j = 0; j < 16; j++)
+			PACK32(&sub_block[j << 2], &w[j]);
+
+		a = ctx->h[0];
+		b = ctx->h[1];
+		c = ctx->h[2];
+		d = ctx->h[3];
+		e = ctx->h[4];
+		f = ctx->h[5];
+		g = ctx->h[6];
+		h = ctx->h[7];
+
+		SHA256_RND8(0, SHA256_W0);
+		SHA256_RND8(8, SHA256_W0);
+		for (j = 16; j < 64; j += 8)
+			SHA256_RND8(j, SHA256_W);
+
+		ctx->h[0] += a;
+		ctx->h[1] += b;
+		ctx->h[2] += c;
+		ctx->h[3] += d;
+		ctx->h[4] += e;
+		ctx->h[5] += f;
+		ctx->h[6] += g;
+		ctx->h[7] += h;
+	}
+}
+#else
 static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 			     unsigned int block_nb)
 {
@@ -128,37 +191,12 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 		for (j = 0; j < 16; j++)
 			PACK32(&sub_block[j << 2], &w[j]);
 
-#ifdef CONFIG_SHA256_UNROLLED
-		for (j = 16; j < 64; j += 8) {
-			SHA256_SCR(j);
-			SHA256_SCR(j + 1);
-			SHA256_SCR(j + 2);
-			SHA256_SCR(j + 3);
-			SHA256_SCR(j + 4);
-			SHA256_SCR(j + 5);
-			SHA256_SCR(j + 6);
-			SHA256_SCR(j + 7);
-		}
-#else
 		for (j = 16; j < 64; j++)
 			SHA256_SCR(j);
-#endif
 
 		for (j = 0; j < 8; j++)
 			wv[j] = ctx->h[j];
 
-#ifdef CONFIG_SHA256_UNROLLED
-		for (j = 0; j < 64; j += 8) {
-			SHA256_EXP(0, 1, 2, 3, 4, 5, 6, 7, j);
-			SHA256_EXP(7, 0, 1, 2, 3, 4, 5, 6, j + 1);
-			SHA256_EXP(6, 7, 0, 1, 2, 3, 4, 5, j + 2);
-			SHA256_EXP(5, 6, 7, 0, 1, 2, 3, 4, j + 3);
-			SHA256_EXP(4, 5, 6, 7, 0, 1, 2, 3, j + 4);
-			SHA256_EXP(3, 4, 5, 6, 7, 0, 1, 2, j + 5);
-			SHA256_EXP(2, 3, 4, 5, 6, 7, 0, 1, j + 6);
-			SHA256_EXP(1, 2, 3, 4, 5, 6, 7, 0, j + 7);
-		}
-#else
 		for (j = 0; j < 64; j++) {
 			t1 = wv[7] + SHA256_F2(wv[4]) +
 			     CH(wv[4], wv[5], wv[6]) + sha256_k[j] + w[j];
@@ -172,12 +210,12 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 			wv[1] = wv[0];
 			wv[0] = t1 + t2;
 		}
-#endif
 
 		for (j = 0; j < 8; j++)
 			ctx->h[j] += wv[j];
 	}
 }
+#endif
 
 void SHA256_update(struct sha256_ctx *ctx, const uint8_t *data, uint32_t len)
 {
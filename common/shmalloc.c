@@ -37,18 +37,155 @@ TEST_GLOBAL struct shm_buffer *allocced_buf_chain;
 /* The size of the biggest ever allocated buffer. */
 static int max_allocated_size;
 
+/* Bytes currently allocated (including headers), and the most ever. */
+static size_t allocated_bytes;
+static size_t max_allocated_bytes;
+
+#ifdef CONFIG_SHMALLOC_POOLS
+/*
+ * Fixed size block pools. Free blocks are kept in a singly linked list
+ * threaded through their first word, so acquire and release are O(1).
+ */
+struct shm_pool {
+	const size_t block_size;
+	const int count;
+	char *base;
+	void *free_list;
+	int free;
+	/* Most blocks ever in use at once */
+	int high_water;
+	/* Requests of this size class the pool had no free block for */
+	uint32_t misses;
+};
+
+static struct shm_pool pools[] = {
+	{ .block_size = 64, .count = CONFIG_SHMALLOC_POOL_64_COUNT },
+	{ .block_size = 256, .count = CONFIG_SHMALLOC_POOL_256_COUNT },
+	{ .block_size = 1024, .count = CONFIG_SHMALLOC_POOL_1K_COUNT },
+	{ .block_size = 4096, .count = CONFIG_SHMALLOC_POOL_4K_COUNT },
+};
+
+/* Carve the pools from the start of shared memory, returns bytes used. */
+static size_t pools_init(char *base, size_t size)
+{
+	size_t total = 0;
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(pools); i++)
+		total += pools[i].block_size * pools[i].count;
+	if (total > size / 2)
+		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(pools); i++) {
+		struct shm_pool *pool = &pools[i];
+
+		pool->base = base;
+		pool->free_list = NULL;
+		for (j = pool->count - 1; j >= 0; j--) {
+			void **block = (void **)(base + j * pool->block_size);
+
+			*block = pool->free_list;
+			pool->free_list = block;
+		}
+		pool->free = pool->count;
+		base += pool->block_size * pool->count;
+	}
+
+	return total;
+}
+
+/* Called with the mutex lock acquired. */
+static void *pool_acquire(int size)
+{
+	struct shm_pool *pool;
+	bool missed = false;
+	void **block;
+
+	for (pool = pools; pool < pools + ARRAY_SIZE(pools); pool++) {
+		if (size > pool->block_size || !pool->count)
+			continue;
+		if (!pool->free_list) {
+			/* Count the miss once, against the best fitting pool */
+			if (!missed)
+				pool->misses++;
+			missed = true;
+			continue;
+		}
+
+		block = pool->free_list;
+		pool->free_list = *block;
+		pool->free--;
+		pool->high_water =
+			MAX(pool->high_water, pool->count - pool->free);
+		allocated_bytes += pool->block_size;
+		max_allocated_bytes = MAX(max_allocated_bytes, allocated_bytes);
+		return block;
+	}
+
+	return NULL;
+}
+
+/*
+ * Called with the mutex lock acquired. Returns false if ptr is not in any
+ * pool, so belongs to the chain.
+ */
+static bool pool_release(void *ptr)
+{
+	struct shm_pool *pool;
+	size_t offset;
+
+	for (pool = pools; pool < pools + ARRAY_SIZE(pools); pool++) {
+		if ((char *)ptr < pool->base ||
+		    (char *)ptr >= pool->base + pool->block_size * pool->count)
+			continue;
+
+		offset = (char *)ptr - pool->base;
+		if (offset % pool->block_size)
+			return true; /* Not a block start, ignore it. */
+
+		*(void **)ptr = pool->free_list;
+		pool->free_list = ptr;
+		pool->free++;
+		allocated_bytes -= pool->block_size;
+		return true;
+	}
+
+	return false;
+}
+
+/* Called with the mutex lock acquired. */
+static size_t pool_max_free(void)
+{
+	size_t max_free = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pools); i++) {
+		if (pools[i].free_list)
+			max_free = pools[i].block_size;
+	}
+
+	return max_free;
+}
+#endif /* CONFIG_SHMALLOC_POOLS */
+
 static void shared_mem_init(void)
 {
+	size_t size = system_usable_ram_end() - (uintptr_t)__shared_mem_buf;
+	size_t pool_size = 0;
+
+#ifdef CONFIG_SHMALLOC_POOLS
+	pool_size = pools_init(__shared_mem_buf, size);
+#endif
+
 	/*
 	 * Use all the RAM we can. The shared memory buffer is the last thing
 	 * allocated from the start of RAM, so we can use everything up to the
 	 * jump data at the end of RAM.
 	 */
-	free_buf_chain = (struct shm_buffer *)__shared_mem_buf;
+	free_buf_chain = (struct shm_buffer *)(__shared_mem_buf + pool_size);
 	free_buf_chain->next_buffer = NULL;
 	free_buf_chain->prev_buffer = NULL;
-	free_buf_chain->buffer_size =
-		system_usable_ram_end() - (uintptr_t)__shared_mem_buf;
+	free_buf_chain->buffer_size = size - pool_size;
 }
 DECLARE_HOOK(HOOK_INIT, shared_mem_init, HOOK_PRIO_FIRST);
 
@@ -94,6 +231,7 @@ static void do_release(struct shm_buffer *ptr)
 	 * for quick reference.
 	 */
 	released_size = ptr->buffer_size;
+	allocated_bytes -= released_size;
 	if (!free_buf_chain) {
 		/*
 		 * All memory had been allocated - this buffer is going to be
@@ -298,9 +436,15 @@ int shared_mem_size(void)
 		pfb = pfb->next_buffer;
 	}
 
-	mutex_unlock(&shmem_lock);
 	/* Leave room for shmem header */
-	max_available -= sizeof(struct shm_buffer);
+	if (max_available)
+		max_available -= sizeof(struct shm_buffer);
+
+#ifdef CONFIG_SHMALLOC_POOLS
+	max_available = MAX(max_available, pool_max_free());
+#endif
+
+	mutex_unlock(&shmem_lock);
 	return max_available;
 }
 
@@ -314,10 +458,23 @@ int shared_mem_acquire(int size, char **dest_ptr)
 	if (in_interrupt_context())
 		return EC_ERROR_INVAL;
 
-	if (!free_buf_chain)
+	mutex_lock(&shmem_lock);
+
+#ifdef CONFIG_SHMALLOC_POOLS
+	*dest_ptr = pool_acquire(size);
+	if (*dest_ptr) {
+		if (size > max_allocated_size)
+			max_allocated_size = size;
+		mutex_unlock(&shmem_lock);
+		return EC_SUCCESS;
+	}
+#endif
+
+	if (!free_buf_chain) {
+		mutex_unlock(&shmem_lock);
 		return EC_ERROR_BUSY;
+	}
 
-	mutex_lock(&shmem_lock);
 	rv = do_acquire(size, &new_buf);
 	if (rv == EC_SUCCESS) {
 		new_buf->next_buffer = allocced_buf_chain;
@@ -331,6 +488,9 @@ int shared_mem_acquire(int size, char **dest_ptr)
 
 		if (size > max_allocated_size)
 			max_allocated_size = size;
+
+		allocated_bytes += new_buf->buffer_size;
+		max_allocated_bytes = MAX(max_allocated_bytes, allocated_bytes);
 	}
 	mutex_unlock(&shmem_lock);
 
@@ -346,7 +506,10 @@ void shared_mem_release(void *ptr)
 		return;
 
 	mutex_lock(&shmem_lock);
-	do_release((struct shm_buffer *)ptr - 1);
+#ifdef CONFIG_SHMALLOC_POOLS
+	if (!pool_release(ptr))
+#endif
+		do_release((struct shm_buffer *)ptr - 1);
 	mutex_unlock(&shmem_lock);
 }
 
@@ -357,6 +520,7 @@ static int command_shmem(int argc, const char **argv)
 	size_t allocated_size;
 	size_t free_size;
 	size_t max_free;
+	int free_bufs = 0;
 	struct shm_buffer *buf;
 
 	allocated_size = free_size = max_free = 0;
@@ -371,6 +535,7 @@ static int command_shmem(int argc, const char **argv)
 		free_size += buf_room;
 		if (buf_room > max_free)
 			max_free = buf_room;
+		free_bufs++;
 	}
 
 	for (buf = allocced_buf_chain; buf; buf = buf->next_buffer)
@@ -383,6 +548,25 @@ static int command_shmem(int argc, const char **argv)
 	ccprintf("Free:          %6zd\n", free_size);
 	ccprintf("Max free buf:  %6zd\n", max_free);
 	ccprintf("Max allocated: %6d\n", max_allocated_size);
+	ccprintf("High water:    %6zd\n", max_allocated_bytes);
+	/* Share of the free memory not in the biggest free buffer */
+	ccprintf("Fragmentation: %6d%% (%d free bufs)\n",
+		 free_size ? 100 - (int)(max_free * 100 / free_size) : 0,
+		 free_bufs);
+
+#ifdef CONFIG_SHMALLOC_POOLS
+	ccprintf("Pool  blocks free  max_used misses\n");
+	for (int i = 0; i < ARRAY_SIZE(pools); i++) {
+		const struct shm_pool *pool = &pools[i];
+
+		/* Skip pools the board gives no blocks */
+		if (!pool->base || !pool->count)
+			continue;
+		ccprintf("%-5zd %-6d %-5d %-8d %u\n", pool->block_size,
+			 pool->count, pool->free, pool->high_water,
+			 pool->misses);
+	}
+#endif
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem, NULL,
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "console.h"
 #include "host_command.h"
+#include "system_boot_time.h"
 #include "system.h"
 #include "util.h"
 
@@ -14,6 +15,9 @@
 #ifdef CONFIG_SYSTEM_BOOT_TIME_LOGGING
 /* Content of ap_boot_time will be lost on sysjump */
 static struct ec_response_get_boot_time ap_boot_time;
+
+/* Duration of the first vboot hash after boot, 0 until it completes */
+static uint32_t vboot_hash_time_us;
 #endif
 
 /* This function updates timestamp for ap boot time params */
@@ -69,6 +73,16 @@ void update_ap_boot_time(enum boot_time_param param)
 #endif
 }
 
+void update_vboot_hash_time(uint32_t hash_us)
+{
+#ifdef CONFIG_SYSTEM_BOOT_TIME_LOGGING
+	if (vboot_hash_time_us)
+		return;
+
+	vboot_hash_time_us = MAX(hash_us, 1);
+#endif
+}
+
 #ifdef CONFIG_SYSTEM_BOOT_TIME_LOGGING
 /* Returns system boot time data */
 static enum ec_status
@@ -93,4 +107,18 @@ host_command_get_boot_time(struct host_cmd_handler_args *args)
 
 DECLARE_HOST_COMMAND(EC_CMD_GET_BOOT_TIME, host_command_get_boot_time,
 		     EC_VER_MASK(0));
+
+static int command_boot_time(int argc, const char **argv)
+{
+	int i;
+
+	for (i = 0; i < RESET_CNT; i++)
+		ccprintf("%d: %llu\n", i, ap_boot_time.timestamp[i]);
+	ccprintf("warm reboot: %d\n", ap_boot_time.cnt);
+	ccprintf("vboot hash: %u us\n", vboot_hash_time_us);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(boottime, command_boot_time, NULL,
+			"Print boot time checkpoints");
 #endif
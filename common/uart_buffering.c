@@ -52,6 +52,8 @@ static int tx_snapshot_head;
 static int tx_snapshot_tail;
 static int tx_last_snapshot_head;
 static int tx_next_snapshot_head;
+/* Bytes written to tx_buf, wrapping, so that tx_buf_head == this & mask */
+static volatile uint32_t tx_buf_written;
 static int tx_checksum __preserved_logs(tx_checksum);
 
 static int uart_buffer_calc_checksum(void)
@@ -73,6 +75,7 @@ void uart_init_buffer(void)
 		tx_buf_tail = 0;
 		tx_checksum = 0;
 	}
+	tx_buf_written = tx_buf_head;
 }
 
 int uart_tx_char_raw(void *context, int c)
@@ -106,6 +109,7 @@ int uart_tx_char_raw(void *context, int c)
 
 	tx_buf[tx_buf_head] = c;
 	tx_buf_head = tx_buf_next;
+	tx_buf_written++;
 
 	if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
 		tx_checksum = uart_buffer_calc_checksum();
@@ -387,3 +391,57 @@ int uart_console_read_buffer(uint8_t type, char *dest, uint16_t dest_size,
 
 	return EC_RES_SUCCESS;
 }
+
+/* Bytes of history in tx_buf, all of it except the byte at the head */
+#define TX_BUF_HISTORY (CONFIG_UART_TX_BUF_SIZE - 1)
+
+uint32_t uart_console_stream_oldest(void)
+{
+	return tx_buf_written - TX_BUF_HISTORY;
+}
+
+enum ec_status uart_console_read_stream(uint32_t *offset, uint32_t *lost,
+					char *dest, uint16_t dest_size,
+					uint16_t *write_count)
+{
+	uint32_t end = tx_buf_written;
+	uint32_t oldest, pos;
+	uint16_t count;
+	char c;
+
+	/* Offset from before a reboot, the caller has to start over */
+	if ((int32_t)(*offset - end) > 0)
+		return EC_RES_INVALID_PARAM;
+
+	*lost = 0;
+	do {
+		oldest = end - TX_BUF_HISTORY;
+		if ((int32_t)(*offset - oldest) < 0) {
+			*lost += oldest - *offset;
+			*offset = oldest;
+		}
+
+		/*
+		 * Copy straight from the circular buffer. As in
+		 * uart_console_read_buffer(), skip the unused bytes if the
+		 * buffer hasn't rolled since boot.
+		 */
+		count = 0;
+		for (pos = *offset; pos != end && count < dest_size; pos++) {
+			c = tx_buf[pos & (CONFIG_UART_TX_BUF_SIZE - 1)];
+			if (c)
+				dest[count++] = c;
+		}
+
+		/*
+		 * Output added while we copied may have overwritten the start
+		 * of it, in which case copy again from the new oldest byte.
+		 */
+		end = tx_buf_written;
+	} while ((int32_t)(*offset - (end - TX_BUF_HISTORY)) < 0);
+
+	*offset = pos;
+	*write_count = count;
+
+	return EC_RES_SUCCESS;
+}
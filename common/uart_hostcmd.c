@@ -52,3 +52,36 @@ host_command_console_read(struct host_cmd_handler_args *args)
 
 DECLARE_HOST_COMMAND(EC_CMD_CONSOLE_READ, host_command_console_read,
 		     EC_VER_MASK(0) | READ_V1_MASK);
+
+static enum ec_status
+host_command_console_stream(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_console_stream *p = args->params;
+	struct ec_response_console_stream *r = args->response;
+	uint32_t offset, lost;
+	uint16_t size;
+	enum ec_status rv;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	offset = (p->flags & EC_CONSOLE_STREAM_OLDEST) ?
+			 uart_console_stream_oldest() :
+			 p->offset;
+	rv = uart_console_read_stream(&offset, &lost, r->data,
+				      args->response_max - sizeof(*r), &size);
+	if (rv != EC_RES_SUCCESS)
+		return rv;
+
+	r->next_offset = offset;
+	r->lost = lost;
+	r->size = size;
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + size;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(EC_CMD_CONSOLE_STREAM,
+			     host_command_console_stream, EC_VER_MASK(0));
@@ -18,6 +18,7 @@
 #include "stdbool.h"
 #include "stdint.h"
 #include "system.h"
+#include "system_boot_time.h"
 #include "task.h"
 #include "timer.h"
 #include "util.h"
@@ -33,9 +34,19 @@ struct vboot_hash_tag {
 	uint32_t size;
 };
 
-#define CHUNK_SIZE 1024 /* Bytes to hash per deferred call */
+#define CHUNK_SIZE 1024 /* Bytes to hash per flash read */
 #define WORK_INTERVAL_US 100 /* Delay between deferred calls */
 
+/*
+ * Time budget for one deferred call. With no burst configured, a deferred
+ * call hashes exactly one chunk.
+ */
+#ifdef CONFIG_VBOOT_HASH_BURST_US
+#define WORK_BURST_US CONFIG_VBOOT_HASH_BURST_US
+#else
+#define WORK_BURST_US 0
+#endif
+
 /* Check that CHUNK_SIZE fits in shared memory. */
 SHARED_MEM_CHECK_SIZE(CHUNK_SIZE);
 
@@ -45,6 +56,7 @@ static uint32_t curr_pos;
 static const uint8_t *hash; /* Hash, or NULL if not valid */
 static int want_abort;
 static int in_progress;
+static timestamp_t hash_start_time;
 #define VBOOT_HASH_DEFERRED true
 #define VBOOT_HASH_BLOCKING false
 
@@ -92,9 +104,7 @@ static int read_and_hash_chunk(int offset, int size)
 
 	rv = shared_mem_acquire(size, &buf);
 	if (rv == EC_ERROR_BUSY) {
-		/* Couldn't update hash right now; try again later */
-		hook_call_deferred(&vboot_hash_next_chunk_data,
-				   WORK_INTERVAL_US);
+		/* Couldn't update hash right now; caller retries later */
 		return rv;
 	} else if (rv != EC_SUCCESS) {
 		vboot_hash_abort();
@@ -119,7 +129,7 @@ static int read_and_hash_chunk(int offset, int size)
 #define SHA256_PRINT_SIZE 4
 #endif
 
-static void hash_next_chunk(size_t size)
+static int hash_next_chunk(size_t size)
 {
 #ifdef CONFIG_MAPPED_STORAGE
 	crec_flash_lock_mapped_storage(1);
@@ -128,30 +138,68 @@ static void hash_next_chunk(size_t size)
 					data_offset + curr_pos),
 		      size);
 	crec_flash_lock_mapped_storage(0);
+	return EC_SUCCESS;
 #else
-	if (read_and_hash_chunk(data_offset + curr_pos, size) != EC_SUCCESS)
-		return;
+	return read_and_hash_chunk(data_offset + curr_pos, size);
 #endif
 }
 
-static void vboot_hash_all_chunks(void)
+/**
+ * Hash consecutive chunks until the region is done or <budget_us> has
+ * elapsed. At least one chunk is hashed per call.
+ *
+ * @param budget_us	Time after which to stop starting new chunks.
+ * @return		EC_SUCCESS, or the error from the failing chunk.
+ */
+static int hash_chunks(uint32_t budget_us)
 {
-	char str_buf[hex_str_buf_size(SHA256_PRINT_SIZE)];
+	timestamp_t start = get_time();
+	size_t size;
+	int rv;
 
 	do {
-		size_t size = MIN(CHUNK_SIZE, data_size - curr_pos);
-		hash_next_chunk(size);
+		size = MIN(CHUNK_SIZE, data_size - curr_pos);
+		rv = hash_next_chunk(size);
+		if (rv != EC_SUCCESS)
+			return rv;
 		curr_pos += size;
-	} while (curr_pos < data_size);
+	} while (curr_pos < data_size && time_since32(start) < budget_us);
+
+	return EC_SUCCESS;
+}
+
+static void vboot_hash_finish(void)
+{
+	char str_buf[hex_str_buf_size(SHA256_PRINT_SIZE)];
+	uint32_t elapsed_us = time_since32(hash_start_time);
 
+	/* Store the final hash */
 	hash = SHA256_final(&ctx);
+
 	snprintf_hex_buffer(str_buf, sizeof(str_buf),
 			    HEX_BUF(hash, SHA256_PRINT_SIZE));
-	CPRINTS("hash done %s", str_buf);
+	CPRINTS("hash done %s (%u us)", str_buf, elapsed_us);
+
 	in_progress = 0;
+
 	clock_enable_module(MODULE_FAST_CPU, 0);
 
-	return;
+	update_vboot_hash_time(elapsed_us);
+}
+
+static int vboot_hash_all_chunks(void)
+{
+	int rv = hash_chunks(UINT32_MAX);
+
+	if (rv != EC_SUCCESS) {
+		in_progress = 0;
+		clock_enable_module(MODULE_FAST_CPU, 0);
+		vboot_hash_abort();
+		return rv;
+	}
+
+	vboot_hash_finish();
+	return EC_SUCCESS;
 }
 
 /**
@@ -159,8 +207,6 @@ static void vboot_hash_all_chunks(void)
  */
 static void vboot_hash_next_chunk(void)
 {
-	int size;
-
 	/* Handle abort */
 	if (want_abort) {
 		in_progress = 0;
@@ -169,24 +215,12 @@ static void vboot_hash_next_chunk(void)
 		return;
 	}
 
-	/* Compute the next chunk of hash */
-	size = MIN(CHUNK_SIZE, data_size - curr_pos);
-	hash_next_chunk(size);
-
-	curr_pos += size;
-	if (curr_pos >= data_size) {
-		char str_buf[hex_str_buf_size(SHA256_PRINT_SIZE)];
-
-		/* Store the final hash */
-		hash = SHA256_final(&ctx);
-
-		snprintf_hex_buffer(str_buf, sizeof(str_buf),
-				    HEX_BUF(hash, SHA256_PRINT_SIZE));
-		CPRINTS("hash done %s", str_buf);
-
-		in_progress = 0;
-
-		clock_enable_module(MODULE_FAST_CPU, 0);
+	/*
+	 * Compute the next chunk(s) of hash. On EC_ERROR_BUSY the chunk is
+	 * retried below; other errors have already requested an abort.
+	 */
+	if (hash_chunks(WORK_BURST_US) == EC_SUCCESS && curr_pos >= data_size) {
+		vboot_hash_finish();
 
 		/* Handle receiving abort during finalize */
 		if (want_abort)
@@ -240,6 +274,7 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	hash = NULL;
 	want_abort = 0;
 	in_progress = 1;
+	hash_start_time = get_time();
 
 	/* Restart the hash computation */
 	CPRINTS("hash start 0x%08x 0x%08x", offset, size);
@@ -250,7 +285,7 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	if (deferred)
 		hook_call_deferred(&vboot_hash_next_chunk_data, 0);
 	else
-		vboot_hash_all_chunks();
+		return vboot_hash_all_chunks();
 
 	return EC_SUCCESS;
 }
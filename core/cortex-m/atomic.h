@@ -11,6 +11,8 @@
 #include "atomic_t.h"
 #include "common.h"
 
+#include <stdbool.h>
+
 static inline atomic_val_t atomic_clear_bits(atomic_t *addr, atomic_val_t bits)
 {
 	return __atomic_fetch_and(addr, ~bits, __ATOMIC_SEQ_CST);
@@ -41,4 +43,11 @@ static inline atomic_val_t atomic_and(atomic_t *addr, atomic_val_t bits)
 	return __atomic_fetch_and(addr, bits, __ATOMIC_SEQ_CST);
 }
 
+static inline bool atomic_cas(atomic_t *addr, atomic_val_t old_value,
+			      atomic_val_t new_value)
+{
+	return __atomic_compare_exchange_n(addr, &old_value, new_value, false,
+					   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
 #endif /* __CROS_EC_ATOMIC_H */
@@ -11,6 +11,8 @@
 #include "atomic_t.h"
 #include "common.h"
 
+#include <stdbool.h>
+
 /**
  * Implements atomic arithmetic operations on 32-bit integers.
  *
@@ -74,4 +76,18 @@ static inline atomic_val_t atomic_and(atomic_t *addr, atomic_val_t bits)
 	return ATOMIC_OP(ands, addr, bits);
 }
 
+static inline bool atomic_cas(atomic_t *addr, atomic_val_t old_value,
+			      atomic_val_t new_value)
+{
+	bool ret;
+	atomic_t volatile *ptr = addr;
+
+	__asm__ __volatile__("cpsid i" : : : "memory");
+	ret = (*ptr == old_value);
+	if (ret)
+		*ptr = new_value;
+	__asm__ __volatile__("cpsie i" : : : "memory");
+	return ret;
+}
+
 #endif /* __CROS_EC_ATOMIC_H */
@@ -12,6 +12,8 @@
 #include "common.h"
 #include "util.h"
 
+#include <stdbool.h>
+
 static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
 					    uint32_t new_value)
 {
@@ -65,4 +67,11 @@ static inline atomic_val_t atomic_clear(atomic_t *addr)
 	return __atomic_exchange_n(addr, 0, __ATOMIC_SEQ_CST);
 }
 
+static inline bool atomic_cas(atomic_t *addr, atomic_val_t old_value,
+			      atomic_val_t new_value)
+{
+	return __atomic_compare_exchange_n(addr, &old_value, new_value, false,
+					   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
 #endif /* __CROS_EC_ATOMIC_H */
@@ -13,6 +13,8 @@
 #include "cpu.h"
 #include "task.h"
 
+#include <stdbool.h>
+
 static inline atomic_val_t atomic_clear_bits(atomic_t *addr, atomic_val_t bits)
 {
 	atomic_val_t ret;
@@ -85,4 +87,18 @@ static inline atomic_val_t atomic_and(atomic_t *addr, atomic_val_t bits)
 	return ret;
 }
 
+static inline bool atomic_cas(atomic_t *addr, atomic_val_t old_value,
+			      atomic_val_t new_value)
+{
+	bool ret;
+	atomic_t volatile *ptr = addr;
+	uint32_t int_mask = read_clear_int_mask();
+
+	ret = (*ptr == old_value);
+	if (ret)
+		*ptr = new_value;
+	set_int_mask(int_mask);
+	return ret;
+}
+
 #endif /* __CROS_EC_ATOMIC_H */
@@ -0,0 +1,112 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Bank of fixed point biquad low pass filters, one channel per sensor, all
+ * updated in one pass per sample.
+ *
+ * The state is kept as structure of arrays with the two taps of each
+ * channel packed in one word, so on cores with the DSP extension each pair
+ * of taps is a single SMLAD. The outputs are 16 bits; the truncation error
+ * of each one is fed back into the next, which keeps low cutoff filters
+ * (poles close to 1) within a few LSB of the exact response.
+ */
+
+#ifndef __CROS_EC_BIQUAD_BANK_H
+#define __CROS_EC_BIQUAD_BANK_H
+
+#include <stdint.h>
+
+/* Coefficients are Q14 */
+#define BIQUAD_Q 14
+/* Samples are scaled up by this many bits, so inputs range -256..255 */
+#define BIQUAD_IN_SCALE 7
+
+/*
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], a0 being
+ * 1 << BIQUAD_Q. The absolute values must add up to less than 4 << BIQUAD_Q
+ * so the accumulator can't overflow.
+ */
+struct biquad_coeff {
+	int16_t b0, b1, b2;
+	int16_t a1, a2;
+};
+
+/* Passes the input through unchanged */
+#define BIQUAD_COEFF_PASS { .b0 = 1 << BIQUAD_Q }
+
+struct biquad_bank {
+	int count;
+	/* Channels which have had a sample since the last reset */
+	uint32_t primed;
+	int32_t *b0;
+	/* b1, b2 and -a1, -a2 in the low and high halves */
+	uint32_t *b12;
+	uint32_t *a12;
+	/* x[n-1], x[n-2] and y[n-1], y[n-2] in the low and high halves */
+	uint32_t *x12;
+	uint32_t *y12;
+	/* Truncation error of the last output */
+	uint16_t *err;
+};
+
+/* Channels in one bank, one bit each in the valid and primed masks */
+#define BIQUAD_BANK_MAX_CHANNELS 32
+
+/**
+ * Define a filter bank of channels channels. Channels output 0 until
+ * biquad_bank_set() gives them coefficients.
+ */
+#define BIQUAD_BANK_DEFINE(name, channels)                           \
+	BUILD_ASSERT((channels) <= BIQUAD_BANK_MAX_CHANNELS);        \
+	static int32_t name##_b0[channels];                          \
+	static uint32_t name##_b12[channels], name##_a12[channels];  \
+	static uint32_t name##_x12[channels], name##_y12[channels];  \
+	static uint16_t name##_err[channels];                        \
+	static struct biquad_bank name = {                           \
+		.count = channels,                                   \
+		.b0 = name##_b0,                                     \
+		.b12 = name##_b12,                                   \
+		.a12 = name##_a12,                                   \
+		.x12 = name##_x12,                                   \
+		.y12 = name##_y12,                                   \
+		.err = name##_err,                                   \
+	}
+
+/**
+ * Set the coefficients of a channel.
+ *
+ * @param coeff	Coefficients, or NULL to pass the input through
+ */
+void biquad_bank_set(struct biquad_bank *bank, int ch,
+		     const struct biquad_coeff *coeff);
+
+/**
+ * Restart all channels from their next valid input, as if it had been steady.
+ */
+void biquad_bank_reset(struct biquad_bank *bank);
+
+/**
+ * Filter one sample of every channel with a valid input. The others keep
+ * their state and output, and a channel's first valid input after a reset
+ * becomes its whole history.
+ *
+ * @param in	bank->count inputs, clamped to -256..255
+ * @param valid	Bit mask of the channels whose input is valid
+ */
+void biquad_bank_update(struct biquad_bank *bank, const int *in,
+			uint32_t valid);
+
+/**
+ * Last output of a channel, in the units of the input.
+ */
+int biquad_bank_get(const struct biquad_bank *bank, int ch);
+
+/**
+ * Last output of a channel, scaled up by BIQUAD_IN_SCALE bits.
+ */
+int biquad_bank_get_scaled(const struct biquad_bank *bank, int ch);
+
+#endif /* __CROS_EC_BIQUAD_BANK_H */
@@ -62,6 +62,13 @@
 /* The amount of free entries that trigger an interrupt to the AP. */
 #undef CONFIG_ACCEL_FIFO_THRES
 
+/*
+ * Store committed fifo entries in the packed encoding (delta coded timestamps
+ * and axes), fitting about twice as many samples in CONFIG_ACCEL_FIFO_SIZE,
+ * and return it for MOTIONSENSE_FIFO_READ_PACKED.
+ */
+#undef CONFIG_ACCEL_FIFO_PACKED
+
 /*
  * Sensors in this mask are in forced mode: they needed to be polled
  * at their data rate frequency.
@@ -1858,6 +1865,17 @@
  */
 #define CONFIG_CONSOLE_CMDHELP
 
+/*
+ * Log cprints() calls as compact binary records (format string address plus
+ * raw arguments) instead of formatting them on the EC. The records are read
+ * with EC_CMD_CONSOLE_BINLOG ("ectool binlog") and formatted on the host by
+ * util/ec_binlog_decode.py. Console command output stays text.
+ */
+#undef CONFIG_CONSOLE_BINLOG
+
+/* Size of the CONFIG_CONSOLE_BINLOG record buffer; must be a power of two */
+#define CONFIG_CONSOLE_BINLOG_BUF_SIZE 1024
+
 /*
  * Add a .flags field to the console commands data structure, to distinguish
  * some commands from others. The available flags bits are defined in
@@ -1890,6 +1908,13 @@
 /* Max length of a single line of input */
 #define CONFIG_CONSOLE_INPUT_LINE_SIZE 80
 
+/*
+ * Complete console command names with the TAB key.
+ *
+ * Boards may #undef this to reduce image size.
+ */
+#define CONFIG_CONSOLE_TAB_COMPLETION
+
 /* Enable verbose output to UART console and extra timestamp print precision. */
 #define CONFIG_CONSOLE_VERBOSE
 
@@ -2073,6 +2098,12 @@
 /* Allow board custom fan control */
 #undef CONFIG_CUSTOM_FAN_CONTROL
 
+/*
+ * Predictive PI fan controller (include/fan_pi.h), for boards to use from
+ * their custom fan control.
+ */
+#undef CONFIG_FAN_PI
+
 /* Support fan control while in low-power idle */
 #undef CONFIG_FAN_DSLEEP
 
@@ -2528,6 +2559,36 @@
  */
 #undef CONFIG_HOSTCMD_SECTION_SORTED
 
+/*
+ * Build a perfect hash of the host commands when the host command task starts
+ * and use it to match a command to its handler in constant time.  Takes
+ * precedence over CONFIG_HOSTCMD_SECTION_SORTED.
+ */
+#undef CONFIG_HOSTCMD_LOOKUP_HASH
+
+/*
+ * Number of slots in the host command hash; a power of 2 no larger than 256
+ * and greater than the number of host commands.  Costs 1.25 bytes of RAM per
+ * slot.
+ */
+#define CONFIG_HOSTCMD_LOOKUP_HASH_SLOTS 256
+
+/*
+ * Record call count, min/avg/max and a histogram of dispatch latency for each
+ * host command, readable with EC_CMD_HOST_CMD_STATS and
+ * EC_CMD_HOST_CMD_LATENCY.
+ */
+#undef CONFIG_HOSTCMD_LATENCY
+
+/*
+ * Number of distinct host commands whose latency is recorded.  Once full, new
+ * commands replace the least frequent one.
+ */
+#define CONFIG_HOSTCMD_LATENCY_SLOTS 16
+
+/* Support EC_CMD_BATCH, which runs several host commands in one request. */
+#undef CONFIG_HOSTCMD_BATCH
+
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -2649,6 +2710,28 @@
 /* Enable debugging and profiling statistics for hook functions */
 #undef CONFIG_HOOK_DEBUG
 
+/*
+ * Order the hooks of each type by priority once, when the hook task starts,
+ * so that hook_notify() is a single walk instead of one pass over the whole
+ * section per priority level.  Costs one byte of RAM per hook.
+ */
+#undef CONFIG_HOOK_SORTED
+
+/*
+ * Keep the pending deferred functions in a min-heap ordered by firing time,
+ * so hook_call_deferred() is O(log n) and the hook task finds the next one
+ * to run without scanning every deferred function.  Costs four bytes of RAM
+ * per deferred function.
+ */
+#undef CONFIG_HOOK_DEFERRED_HEAP
+
+/*
+ * Number of hooks (of all types together) which CONFIG_HOOK_SORTED orders and
+ * CONFIG_HOOK_DEBUG keeps per-hook statistics for.  Hooks beyond that are
+ * still called, in the same order, just without the speedup or statistics.
+ */
+#define CONFIG_HOOK_MAX_COUNT 128
+
 /*****************************************************************************/
 /* CRC configuration */
 
@@ -2658,6 +2741,14 @@
 /* Enable the software routine for CRC computation */
 #undef CONFIG_SW_CRC
 
+/*
+ * Process this many bytes per iteration of the software CRC-32 loop
+ * (slice-by-N).  Valid values are 4 and 8; leave undefined for the
+ * byte-at-a-time loop.  Each extra slice costs 1 KiB of flash for its lookup
+ * table, so only enable this on boards that hash large images.
+ */
+#undef CONFIG_SW_CRC_SLICE_BY
+
 /*****************************************************************************/
 
 /* Enable system hibernate */
@@ -2736,6 +2827,22 @@
 #undef CONFIG_I2C_DEBUG
 #undef CONFIG_I2C_DEBUG_PASSTHRU
 #undef CONFIG_I2C_PASSTHRU_RESTRICTED
+
+/*
+ * Keep per port and per peripheral I2C statistics (transactions, bytes, bus
+ * hold time, retries, NAKs) plus a sliding-window bus utilization per port.
+ * Adds the i2cstats console command and EC_CMD_I2C_STATS.
+ */
+#undef CONFIG_I2C_STATS
+
+/* Number of (port, address) pairs tracked by CONFIG_I2C_STATS */
+#define CONFIG_I2C_STATS_ENTRIES 16
+
+/*
+ * Length of the bus utilization window of CONFIG_I2C_STATS. It is rounded up
+ * so each of its 8 buckets is a power of two of us.
+ */
+#define CONFIG_I2C_STATS_WINDOW_MS 1000
 #undef CONFIG_I2C_VIRTUAL_BATTERY
 
 /*
@@ -2785,6 +2892,20 @@
 
 /* Defines I2C operation retry count when slave nack'd(EC_ERROR_BUSY) */
 #define CONFIG_I2C_NACK_RETRY_COUNT 0
+
+/*
+ * Enable i2c_async_submit(), which queues transfers per port instead of
+ * blocking the caller.  Queued requests run and complete in the hook task;
+ * i2c_xfer() becomes a synchronous wrapper over the same queue.
+ */
+#undef CONFIG_I2C_ASYNC
+
+/*
+ * Largest block read that adjacent I2C_ASYNC_COALESCE register reads are
+ * merged into.  The merge buffer lives on the stack of the servicing task.
+ */
+#define CONFIG_I2C_ASYNC_COALESCE_MAX 32
+
 /*
  * I2C SCL gating.
  *
@@ -3112,9 +3233,26 @@
  */
 #define CONFIG_KEYBOARD_RUNTIME_KEYS
 
+/*
+ * Measure keypress latency with the 8042 protocol: from the scanner seeing a
+ * key change to its scan code being queued, and on to the host reading it.
+ * EC_CMD_KEYBOARD_LATENCY reports percentiles over the last
+ * CONFIG_KEYBOARD_LATENCY_SAMPLES scan codes.
+ */
+#undef CONFIG_KEYBOARD_LATENCY
+#define CONFIG_KEYBOARD_LATENCY_SAMPLES 32
+
 /* Add support for ADC based antighost feature */
 #undef CONFIG_KEYBOARD_SCAN_ADC
 
+/*
+ * While polling the keyboard, first drive all columns at once and skip the
+ * column by column scan if no row is active.  An idle scan then takes one
+ * output settle period instead of one per column, at the cost of one extra
+ * settle period on scans with keys pressed.
+ */
+#undef CONFIG_KEYBOARD_SCAN_IDLE_SKIP
+
 /*
  * Allow the board layer keyboard customization. If define, the board layer
  * needs to implement:
@@ -3455,6 +3593,19 @@
 /* Provide rudimentary malloc/free like services for shared memory. */
 #undef CONFIG_MALLOC
 
+/*
+ * With CONFIG_MALLOC, carve fixed pools of 64, 256, 1K and 4K byte blocks out
+ * of shared memory at init.  Requests which fit a block are served from the
+ * pools in O(1), the rest from the general best-fit chain.  The counts below
+ * give the number of blocks in each pool; a pool of zero blocks is skipped.
+ * The pools are left out if they would take more than half of shared memory.
+ */
+#undef CONFIG_SHMALLOC_POOLS
+#define CONFIG_SHMALLOC_POOL_64_COUNT 8
+#define CONFIG_SHMALLOC_POOL_256_COUNT 4
+#define CONFIG_SHMALLOC_POOL_1K_COUNT 2
+#define CONFIG_SHMALLOC_POOL_4K_COUNT 1
+
 /* Need for a math library */
 #undef CONFIG_MATH_UTIL
 
@@ -4015,7 +4166,11 @@
 /* Compute SHA256 by using chip's hardware accelerator */
 #undef CONFIG_SHA256_HW_ACCELERATE
 
-/* Unroll some loops in SHA256_transform for better performance. */
+/*
+ * Unroll the SHA256_transform rounds for better performance.  The unrolled
+ * variant also keeps the message schedule in a 16-word window, which needs
+ * less stack than the generic loop.
+ */
 #undef CONFIG_SHA256_UNROLLED
 
 /* Emulate the CLZ (Count Leading Zeros) in software for CPU lacking support */
@@ -4320,6 +4475,13 @@
 #undef CONFIG_TEMP_SENSOR_F75303 /* Fintek  F75303 sensor, on I2C bus */
 #undef CONFIG_TEMP_SENSOR_AMD_R19ME4070 /* AMD_R19ME4070 sensor, on I2C bus */
 
+/*
+ * Bank of biquad filters (include/biquad_bank.h) to low pass filter all
+ * temperature sensors in one pass, with the DSP instructions when the core
+ * has them.
+ */
+#undef CONFIG_BIQUAD_BANK
+
 /* Compile common code for thermistor support */
 #undef CONFIG_THERMISTOR
 
@@ -5664,6 +5826,13 @@
 /* Support computing hash of code for verified boot */
 #undef CONFIG_VBOOT_HASH
 
+/*
+ * Keep hashing consecutive flash chunks for up to this many microseconds per
+ * deferred call before yielding, instead of one 1 KiB chunk per call.  This
+ * shortens the RW hash at boot at the cost of longer hook task runs.
+ */
+#undef CONFIG_VBOOT_HASH_BURST_US
+
 /* Support for secure temporary storage for verified boot */
 #undef CONFIG_VSTORE
 
@@ -6202,13 +6371,15 @@
 
 /******************************************************************************/
 /*
- * Disable the built-in console history if using the experimental console.
+ * Disable the built-in console history and TAB completion if using the
+ * experimental console.
  *
  * The experimental console keeps its own session-persistent history which
  * survives EC reboot.  It also requires CRC8 for command integrity.
  */
 #ifdef CONFIG_EXPERIMENTAL_CONSOLE
 #undef CONFIG_CONSOLE_HISTORY
+#undef CONFIG_CONSOLE_TAB_COMPLETION
 #define CONFIG_CRC8
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
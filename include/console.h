@@ -11,6 +11,7 @@
 #include "common.h"
 #include "config.h"
 
+#include <stdarg.h>
 #include <stdbool.h>
 
 #ifdef CONFIG_ZEPHYR
@@ -187,6 +188,20 @@ cprintf(enum console_channel channel, const char *format, ...);
 __attribute__((__format__(__printf__, 2, 3))) int
 cprints(enum console_channel channel, const char *format, ...);
 
+/**
+ * Log a cprints() call as a binary record, to be formatted on the host.
+ *
+ * @param channel	Output channel
+ * @param format	Format string; see printf.h for valid formatting codes
+ * @param args		Arguments of the format
+ *
+ * @return EC_SUCCESS if logged, else an error and the caller prints the
+ * text: binary logging is off, the channel is CC_COMMAND, or the arguments
+ * don't fit in a record.
+ */
+int console_binlog_vprints(enum console_channel channel, const char *format,
+			   va_list args);
+
 /**
  * Flush the console output for all channels.
  */
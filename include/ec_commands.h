@@ -2900,6 +2900,57 @@ struct ec_response_motion_sense_fifo_data {
 	struct ec_response_motion_sensor_data data[0];
 } __ec_todo_packed;
 
+/*
+ * Appended to the MOTIONSENSE_CMD_FIFO_INFO and MOTIONSENSE_CMD_FIFO_FLUSH
+ * responses, after lost[], when the host sets MOTIONSENSE_FIFO_INFO_STATS.
+ */
+struct ec_response_motion_sense_fifo_stats {
+	/* Entries added to the fifo since it was last reset */
+	uint32_t total_staged;
+	/*
+	 * Entries dropped because the fifo was full since it was last reset.
+	 * total_dropped / total_staged is the drop rate.
+	 */
+	uint32_t total_dropped;
+} __ec_todo_packed;
+
+/*
+ * Packed fifo encoding, returned by MOTIONSENSE_CMD_FIFO_READ when the host
+ * sets MOTIONSENSE_FIFO_READ_PACKED. Entries follow each other without
+ * padding, and the first byte of an entry tells its layout:
+ *
+ * EC_MOTION_SENSE_PACKED clear: the unmodified
+ *   struct ec_response_motion_sensor_data. No sensor flag uses that bit, so
+ *   the plain MOTIONSENSE_CMD_FIFO_READ response is also a valid packed one.
+ * EC_MOTION_SENSE_PACKED | EC_MOTION_SENSE_PACKED_TIMESTAMP | sensor_num: an
+ *   entry whose only flag is MOTIONSENSE_SENSOR_FLAG_TIMESTAMP. Followed by
+ *   the difference from the previous timestamp as a varint.
+ * EC_MOTION_SENSE_PACKED | sensor_num: sensor data. Followed by the entry
+ *   flags and, for each of the three axes, the difference from the previous
+ *   data of the same sensor as a zigzag varint.
+ *
+ * Previous values start at 0 in each response and are updated by every
+ * entry: entries with MOTIONSENSE_SENSOR_FLAG_TIMESTAMP set the previous
+ * timestamp, and entries with neither MOTIONSENSE_SENSOR_FLAG_TIMESTAMP nor
+ * MOTIONSENSE_SENSOR_FLAG_ODR set the previous data of sensor_num, if it is
+ * below EC_MOTION_SENSE_PACKED_MAX_SENSORS. Differences wrap at the width of
+ * the field (16 bits for axes, 32 bits for timestamps).
+ *
+ * A varint is little-endian base 128: 7 bits per byte, with bit 7 set on all
+ * but the last byte. A zigzag varint encodes the signed value v as the
+ * varint (v << 1) ^ (v >> 15).
+ */
+#define EC_MOTION_SENSE_PACKED BIT(6)
+#define EC_MOTION_SENSE_PACKED_TIMESTAMP BIT(5)
+#define EC_MOTION_SENSE_PACKED_SENSOR_MASK 0x1f
+#define EC_MOTION_SENSE_PACKED_MAX_SENSORS 32
+
+/* Flags used for MOTIONSENSE_CMD_FIFO_INFO and MOTIONSENSE_CMD_FIFO_FLUSH */
+#define MOTIONSENSE_FIFO_INFO_STATS BIT(0)
+
+/* Flags used for MOTIONSENSE_CMD_FIFO_READ */
+#define MOTIONSENSE_FIFO_READ_PACKED BIT(0)
+
 /* List supported activity recognition */
 enum motionsensor_activity {
 	MOTIONSENSE_ACTIVITY_RESERVED = 0,
@@ -2932,7 +2983,7 @@ struct ec_motion_sense_activity {
 #define MOTIONSENSE_SENSOR_FLAG_WAKEUP BIT(2)
 #define MOTIONSENSE_SENSOR_FLAG_TABLET_MODE BIT(3)
 #define MOTIONSENSE_SENSOR_FLAG_ODR BIT(4)
-
+/* BIT(5) and BIT(6) are reserved, see EC_MOTION_SENSE_PACKED */
 #define MOTIONSENSE_SENSOR_FLAG_BYPASS_FIFO BIT(7)
 
 /*
@@ -3080,8 +3131,16 @@ struct ec_params_motion_sense {
 			uint16_t scale[3];
 		} sensor_scale;
 
-		/* Used for MOTIONSENSE_CMD_FIFO_INFO */
-		/* (no params) */
+		/*
+		 * Used for MOTIONSENSE_CMD_FIFO_INFO and
+		 * MOTIONSENSE_CMD_FIFO_FLUSH. Older hosts send no params, or
+		 * only sensor_num.
+		 */
+		struct __ec_todo_unpacked {
+			/* Sensor to flush, ignored by FIFO_INFO */
+			uint8_t sensor_num;
+			uint8_t flags; /* MOTIONSENSE_FIFO_INFO_* */
+		} fifo_info;
 
 		/* Used for MOTIONSENSE_CMD_FIFO_READ */
 		struct __ec_todo_unpacked {
@@ -3090,6 +3149,8 @@ struct ec_params_motion_sense {
 			 * EC may return less or 0 if none available.
 			 */
 			uint32_t max_data_vector;
+			/* Optional, MOTIONSENSE_FIFO_READ_* */
+			uint8_t flags;
 		} fifo_read;
 
 		/* Used for MOTIONSENSE_CMD_SET_ACTIVITY */
@@ -8121,6 +8182,294 @@ struct ec_response_get_boot_time {
 #define EC_PRIVATE_HOST_COMMAND_VALUE(command) \
 	(EC_CMD_BOARD_SPECIFIC_BASE + (command))
 
+/*****************************************************************************/
+/*
+ * Diagnostic commands
+ *
+ * These are private command offsets at the top of the range reserved above,
+ * clear of the public ranges and of board commands, which are numbered up
+ * from EC_CMD_BOARD_SPECIFIC_BASE. Declare their handlers with
+ * DECLARE_PRIVATE_HOST_COMMAND() and send them as
+ * EC_PRIVATE_HOST_COMMAND_VALUE(command).
+ */
+
+/*
+ * Get the dispatch latency histogram of a host command. Only a limited number
+ * of distinct commands are tracked; others return EC_RES_UNAVAILABLE.
+ */
+#define EC_CMD_HOST_CMD_LATENCY 0x01F0
+
+/*
+ * Bucket N counts dispatches that took [2^N, 2^(N+1)) us. Bucket 0 also counts
+ * 0 us and the last bucket counts everything slower.
+ */
+#define EC_HOST_CMD_LATENCY_BUCKETS 16
+
+struct ec_params_host_cmd_latency {
+	uint16_t cmd;
+} __ec_align2;
+
+struct ec_response_host_cmd_latency {
+	uint32_t hist[EC_HOST_CMD_LATENCY_BUCKETS];
+} __ec_align4;
+
+/*
+ * Get dispatch statistics of the most frequently received host commands,
+ * hottest first. Latencies cover command lookup and the handler itself.
+ */
+#define EC_CMD_HOST_CMD_STATS 0x01F1
+
+/* Clear all statistics after reading them */
+#define EC_HOST_CMD_STATS_RESET BIT(0)
+
+struct ec_params_host_cmd_stats {
+	uint8_t max_entries; /* Number of entries wanted */
+	uint8_t flags; /* EC_HOST_CMD_STATS_* */
+} __ec_align1;
+
+struct ec_host_cmd_stats_entry {
+	uint16_t cmd;
+	uint16_t reserved;
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t avg_us;
+	uint32_t max_us;
+} __ec_align4;
+
+struct ec_response_host_cmd_stats {
+	uint8_t num_entries;
+	uint8_t reserved[3];
+	struct ec_host_cmd_stats_entry entries[];
+} __ec_align4;
+
+/*
+ * Run several host commands in one request, saving a protocol round-trip per
+ * command for hosts that poll many small commands.
+ *
+ * The params are struct ec_params_batch followed by num_cmds sub-commands,
+ * each a struct ec_batch_cmd followed by param_size bytes of params. The
+ * response is struct ec_response_batch followed by one struct
+ * ec_batch_result per sub-command run, each followed by size bytes of
+ * response data.
+ *
+ * Sub-commands run in order. If the response can't hold the next
+ * sub-command's response_max bytes, it and the ones after it are not run and
+ * num_results is less than num_cmds. Batches can't be nested, and commands
+ * which respond before they complete (EC_CMD_FLASH_ERASE, EC_CMD_REBOOT_EC)
+ * can't be batched; either makes the whole batch fail with
+ * EC_RES_INVALID_PARAM.
+ *
+ * A sub-command whose response doesn't fit in its response_max gets
+ * EC_RES_RESPONSE_TOO_BIG.
+ */
+#define EC_CMD_BATCH 0x01F2
+
+struct ec_params_batch {
+	uint8_t num_cmds;
+	uint8_t reserved[3];
+	uint8_t cmds[];
+} __ec_align4;
+
+struct ec_batch_cmd {
+	uint16_t command;
+	uint8_t version;
+	uint8_t param_size;
+	uint8_t response_max; /* Largest response wanted, in bytes */
+	uint8_t reserved;
+	uint8_t params[];
+} __ec_todo_packed;
+
+struct ec_response_batch {
+	uint8_t num_results;
+	uint8_t reserved[3];
+	uint8_t results[];
+} __ec_align4;
+
+struct ec_batch_result {
+	uint16_t command;
+	uint8_t result; /* enum ec_status */
+	uint8_t size; /* Bytes of data; 0 unless result is EC_RES_SUCCESS */
+	uint8_t data[];
+} __ec_todo_packed;
+
+/*
+ * Get I2C traffic statistics: bus utilization per port over the last
+ * window_ms, and totals per (port, 7-bit address) since boot or the last
+ * reset. Entries are paged; ask again with start = start + num_entries until
+ * total_entries is reached.
+ */
+#define EC_CMD_I2C_STATS 0x01F3
+
+/* Clear all statistics after reporting them */
+#define EC_I2C_STATS_RESET BIT(0)
+
+#define EC_I2C_STATS_MAX_PORTS 8
+
+struct ec_params_i2c_stats {
+	uint8_t flags; /* EC_I2C_STATS_* */
+	uint8_t start; /* Index of the first entry to return */
+} __ec_align1;
+
+struct ec_i2c_stats_port {
+	uint8_t port;
+	uint8_t reserved;
+	uint16_t utilization; /* Bus busy time in the window, 1/1000 units */
+} __ec_align2;
+
+struct ec_i2c_stats_entry {
+	uint8_t port;
+	uint8_t addr; /* 7-bit address */
+	uint16_t reserved;
+	uint32_t count; /* Transactions */
+	uint32_t bytes; /* Bytes written and read */
+	uint32_t busy_us; /* Total time holding the bus */
+	uint32_t max_us; /* Longest transaction */
+	uint32_t retries; /* Attempts repeated after a NAK */
+	uint32_t naks; /* Attempts NAKed by the peripheral */
+	uint32_t errors; /* Transactions which ultimately failed */
+} __ec_align4;
+
+struct ec_response_i2c_stats {
+	uint16_t window_ms;
+	uint8_t num_ports;
+	uint8_t num_entries; /* Entries in this response */
+	uint8_t total_entries; /* Entries available */
+	uint8_t reserved[3];
+	struct ec_i2c_stats_port ports[EC_I2C_STATS_MAX_PORTS];
+	struct ec_i2c_stats_entry entries[];
+} __ec_align4;
+
+/*
+ * Get keypress latency percentiles over the last recorded 8042 scan codes.
+ * Each stage gives the 50th and 99th percentile and the maximum, in us.
+ */
+#define EC_CMD_KEYBOARD_LATENCY 0x01F4
+
+/* Clear the samples and counters after reporting them */
+#define EC_KEYBOARD_LATENCY_RESET BIT(0)
+
+struct ec_params_keyboard_latency {
+	uint8_t flags; /* EC_KEYBOARD_LATENCY_* */
+} __ec_align1;
+
+enum ec_keyboard_latency_stage_id {
+	/* Key change seen by the scanner to scan code queued for the host */
+	EC_KEYBOARD_LATENCY_QUEUE = 0,
+	/* Scan code queued to its last byte read by the host */
+	EC_KEYBOARD_LATENCY_HOST,
+	/* Key change seen to scan code read by the host */
+	EC_KEYBOARD_LATENCY_TOTAL,
+	EC_KEYBOARD_LATENCY_STAGE_COUNT,
+};
+
+struct ec_keyboard_latency_stage {
+	uint32_t p50_us;
+	uint32_t p99_us;
+	uint32_t max_us;
+} __ec_align4;
+
+struct ec_response_keyboard_latency {
+	uint32_t total; /* Scan codes measured since boot or the last reset */
+	uint32_t dropped; /* Scan codes not measured, too many in flight */
+	uint16_t samples; /* Most recent scan codes the percentiles cover */
+	uint16_t reserved;
+	struct ec_keyboard_latency_stage
+		stages[EC_KEYBOARD_LATENCY_STAGE_COUNT];
+} __ec_align4;
+
+/*
+ * Get as many PD log entries as fit in the response, oldest first. The
+ * entries are struct ec_response_pd_log records placed back to back, each one
+ * padded to a multiple of sizeof(struct ec_response_pd_log).
+ *
+ * Version 0 removes the entries it returns from the log.
+ *
+ * Version 1 leaves them in the log until the host asks for the entries after
+ * them, so the host can retry without losing any if a response doesn't make
+ * it. The cursor is the position of an entry in the log: pass the
+ * next_cursor of the previous response, or set EC_PD_LOG_ENTRIES_OLDEST.
+ */
+#define EC_CMD_PD_GET_LOG_ENTRIES 0x01F5
+
+struct ec_response_pd_get_log_entries {
+	uint32_t dropped; /* Entries lost since the previous read */
+	uint16_t size; /* Bytes of entries, 0 when the log is empty */
+	uint16_t reserved;
+	uint8_t entries[];
+} __ec_align4;
+
+/* Ignore the cursor and start from the oldest entry */
+#define EC_PD_LOG_ENTRIES_OLDEST BIT(0)
+
+struct ec_params_pd_get_log_entries_v1 {
+	uint32_t cursor;
+	uint8_t flags; /* EC_PD_LOG_ENTRIES_* */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_response_pd_get_log_entries_v1 {
+	/*
+	 * Position of the first entry returned. If it isn't the cursor asked
+	 * for, the entries in between were discarded before being read.
+	 */
+	uint32_t cursor;
+	uint32_t next_cursor; /* Cursor to ask for next */
+	uint32_t dropped; /* Entries lost since the previous read */
+	uint16_t size; /* Bytes of entries, 0 when there are no new ones */
+	uint16_t reserved;
+	uint8_t entries[];
+} __ec_align4;
+
+/*
+ * Read the EC console output from where the previous read stopped, straight
+ * from the console buffer, without EC_CMD_CONSOLE_SNAPSHOT. The offset counts
+ * the bytes output since the EC booted: pass the next_offset of the previous
+ * response, or set EC_CONSOLE_STREAM_OLDEST to start from the oldest output
+ * still buffered. Returns EC_RES_INVALID_PARAM if the offset is ahead of the
+ * output, i.e. the EC rebooted since the offset was returned.
+ */
+#define EC_CMD_CONSOLE_STREAM 0x01F6
+
+/* Ignore the offset and start from the oldest output */
+#define EC_CONSOLE_STREAM_OLDEST BIT(0)
+
+struct ec_params_console_stream {
+	uint32_t offset;
+	uint8_t flags; /* EC_CONSOLE_STREAM_* */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_response_console_stream {
+	uint32_t next_offset; /* Offset to ask for next */
+	uint32_t lost; /* Bytes overwritten before they could be read */
+	uint16_t size; /* Bytes of data, 0 when there is no new output */
+	uint16_t reserved;
+	char data[]; /* Not null-terminated */
+} __ec_align4;
+
+/*
+ * Read the binary console log (CONFIG_CONSOLE_BINLOG), in which cprints()
+ * calls are stored as records instead of text and formatted on the host.
+ * Params and response are the ones of EC_CMD_CONSOLE_STREAM, with offsets
+ * counting bytes of records and data holding whole records. An offset that
+ * isn't at the start of a record also returns EC_RES_INVALID_PARAM.
+ */
+#define EC_CMD_CONSOLE_BINLOG 0x01F7
+
+/*
+ * A binary console log record. The header is followed by the arguments in
+ * format order, little-endian and unaligned: 4 bytes for 32-bit values
+ * (including %c and '*' widths), 8 bytes for 64-bit ones (%ll, and %l, %z or
+ * %p where those are 64-bit) and the null-terminated string for %s.
+ */
+struct ec_binlog_record {
+	uint8_t size; /* Bytes including this header */
+	uint8_t channel; /* enum console_channel */
+	uint16_t time_hi; /* Bits 32-47 of the timestamp in us */
+	uint32_t time_lo; /* Bits 0-31 of the timestamp in us */
+	uint32_t format; /* Address of the format string in the EC image */
+} __ec_align1;
+
 /*****************************************************************************/
 /*
  * Passthru commands
@@ -18,6 +18,11 @@ struct event_log_entry {
 
 #define EVENT_LOG_SIZE_MASK 0x1f
 #define EVENT_LOG_SIZE(size) ((size)&EVENT_LOG_SIZE_MASK)
+/* Largest entry returned by the dequeue functions, payload padding included */
+#define EVENT_LOG_MAX_ENTRY_SIZE                \
+	(sizeof(struct event_log_entry) *       \
+	 (1 + DIV_ROUND_UP(EVENT_LOG_SIZE_MASK, \
+			   sizeof(struct event_log_entry))))
 
 /* The timestamp is the microsecond counter shifted to get about a ms. */
 #define EVENT_LOG_TIMESTAMP_SHIFT 10 /* 1 LSB = 1024us */
@@ -34,4 +39,38 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data, void *payload,
  */
 int log_dequeue_event(struct event_log_entry *r);
 
+/*
+ * Remove as many entries as fit in size bytes from the event log into buf,
+ * oldest first. Each entry is padded to a multiple of
+ * sizeof(struct event_log_entry).
+ * Returns the number of bytes written to buf, 0 if the log is empty.
+ */
+int log_dequeue_events(void *buf, int size);
+
+/*
+ * Read entries without removing them, for readers which must not lose any
+ * if the transfer to their consumer fails. Positions in the log count units
+ * of sizeof(struct event_log_entry).
+ *
+ * The entries before *cursor are removed, as the reader got them already.
+ * Then as many entries as fit in size bytes are copied to buf, oldest first,
+ * in the same format as log_dequeue_events(). On return, *cursor is the
+ * position of the first entry copied: if it moved forward, entries were
+ * discarded before they could be read. The position after the last entry
+ * copied, to pass as cursor next time, is *cursor + returned size /
+ * sizeof(struct event_log_entry).
+ * Returns the number of bytes written to buf, or -1 if *cursor isn't the
+ * position of an entry.
+ */
+int log_read_events(uint32_t *cursor, void *buf, int size);
+
+/* Returns the position of the oldest entry, to start log_read_events() at. */
+uint32_t log_oldest_cursor(void);
+
+/*
+ * Returns the number of events lost, either discarded to make room or
+ * rejected because the log was full, and resets the count.
+ */
+uint32_t log_clear_dropped(void);
+
 #endif /* __CROS_EC_EVENT_LOG_H */
@@ -0,0 +1,84 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Predictive PI fan controller.
+ *
+ * Each sensor's temperature is projected forward by its thermal time
+ * constant, and the hottest projection relative to its target drives a PI
+ * loop. The expected heat (the power limits) is fed forward, and the output
+ * is slewed so the fan speed never jumps.
+ *
+ * This only does arithmetic, so host tools can run it on logged data.
+ */
+
+#ifndef __CROS_EC_FAN_PI_H
+#define __CROS_EC_FAN_PI_H
+
+#include <stdint.h>
+
+#define FAN_PI_MAX_SENSORS 6
+
+/* Output and integral are in thousandths of a percent. */
+#define FAN_PI_OUTPUT_MAX 100000
+
+/* Gains are fixed point, 256 is 1.0. */
+#define FAN_PI_GAIN_ONE 256
+
+struct fan_pi_sensor {
+	/* Temperatures (mK) for no cooling, the set point and full cooling */
+	int temp_off_mk;
+	int temp_target_mk;
+	int temp_max_mk;
+	/* Thermal time constant of what the sensor measures */
+	int tau_ms;
+};
+
+struct fan_pi_config {
+	const struct fan_pi_sensor *sensors;
+	int num_sensors;
+	/*
+	 * Output for an error of the whole off..max span, and output added per
+	 * second for that error.
+	 */
+	int kp;
+	int ki;
+	/* Feed forward, in thousandths of a percent per W of power limit */
+	int ff_per_w;
+	/* Slew limits, in percent of the RPM range per second */
+	int slew_up;
+	int slew_down;
+};
+
+struct fan_pi_state {
+	int temp_mk[FAN_PI_MAX_SENSORS];
+	/* Smoothed temperature slope, mK/s */
+	int slope[FAN_PI_MAX_SENSORS];
+	int integral;
+	int output;
+	/* Sensor that drove the last update, or -1 */
+	int hottest;
+	int primed;
+};
+
+/**
+ * Forget the history, e.g. when the fan was off for a while.
+ */
+void fan_pi_reset(struct fan_pi_state *state);
+
+/**
+ * Run the controller.
+ *
+ * @param cfg		Tuning
+ * @param state		Controller state
+ * @param temps_mk	One temperature per sensor in cfg, 0 if not available
+ * @param power_mw	Power the system may dissipate now
+ * @param dt_ms		Time since the last update
+ * @return Fan demand, in thousandths of a percent of the RPM range.
+ */
+int fan_pi_update(const struct fan_pi_config *cfg, struct fan_pi_state *state,
+		  const int *temps_mk, int power_mw, int dt_ms);
+
+#endif /* __CROS_EC_FAN_PI_H */
@@ -260,6 +260,18 @@ __error("This function should only be called from Zephyr OS code")
 #endif
 	struct host_command *zephyr_find_host_command(int command);
 
+/**
+ * Get the table of host commands registered in Zephyr OS.
+ *
+ * @param count		Set to the number of registered commands
+ *
+ * Return: the first registered command.
+ */
+#ifndef CONFIG_ZEPHYR
+__error("This function should only be called from Zephyr OS code")
+#endif
+	const struct host_command *zephyr_get_host_commands(int *count);
+
 #if defined(CONFIG_ZEPHYR)
 #include "zephyr_host_command.h"
 #elif defined(HAS_TASK_HOSTCMD)
@@ -12,6 +12,9 @@
 #include "gpio_signal.h"
 #include "host_command.h"
 #include "stddef.h"
+#include "task_id.h"
+
+#include <stdbool.h>
 
 /*
  * I2C Peripheral Address encoding
@@ -177,6 +180,7 @@ struct i2c_cmd_desc_t {
  * transferred data might be capped at CONFIG_I2C_CHIP_MAX_TRANSFER_SIZE if
  * CONFIG_I2C_XFER_LARGE_TRANSFER is not defined.  The transfer is strictly
  * atomic, by locking the I2C port and performing an I2C_XFER_SINGLE transfer.
+ * With CONFIG_I2C_ASYNC it goes through the port's request queue.
  *
  * @param port		Port to access
  * @param addr_flags	Peripheral device address
@@ -199,6 +203,59 @@ int i2c_xfer_unlocked(const int port, const uint16_t addr_flags,
 		      const uint8_t *out, int out_size, uint8_t *in,
 		      int in_size, int flags);
 
+/* Flags for struct i2c_async_req */
+/* Queue ahead of all normal priority requests (e.g. PD controller traffic) */
+#define I2C_ASYNC_PRIO_HIGH BIT(0)
+/*
+ * out is a 1 or 2 byte register offset on an auto-incrementing device, so
+ * this read may be merged with adjacent reads of the following registers.
+ */
+#define I2C_ASYNC_COALESCE BIT(1)
+
+/**
+ * Asynchronous I2C transfer descriptor.  The descriptor and its buffers are
+ * owned by the caller and must stay valid until the request completes.
+ */
+struct i2c_async_req {
+	/* Port and peripheral, as for i2c_xfer() */
+	int port;
+	uint16_t addr_flags;
+	/* I2C_ASYNC_* flags */
+	uint8_t flags;
+	const uint8_t *out;
+	int out_size;
+	uint8_t *in;
+	int in_size;
+	/*
+	 * Called on completion from the hook task, so it must not block; it
+	 * may submit further requests.
+	 */
+	void (*done)(struct i2c_async_req *req);
+	/* If done is NULL, this event is sent to the submitting task instead */
+	uint32_t event;
+	/* Result of the transfer, valid once the request completed */
+	int rv;
+	/* True from submission until completion; read-only for callers */
+	volatile bool pending;
+	/* Private to the I2C layer */
+	task_id_t task;
+	struct i2c_async_req *next;
+};
+
+/**
+ * Queue an I2C transfer without waiting for it.
+ *
+ * Requests are serviced in order (high priority ones first) by a deferred
+ * handler in the hook task.  i2c_xfer() queues behind the pending requests and
+ * runs them from the calling task, but their completions are still reported
+ * from the hook task.
+ *
+ * @param req		Transfer descriptor
+ * @return EC_SUCCESS, EC_ERROR_BUSY if req is still pending, or
+ *	   EC_ERROR_INVAL if the request is malformed.
+ */
+int i2c_async_submit(struct i2c_async_req *req);
+
 #define I2C_LINE_SCL_HIGH BIT(0)
 #define I2C_LINE_SDA_HIGH BIT(1)
 #define I2C_LINE_IDLE (I2C_LINE_SCL_HIGH | I2C_LINE_SDA_HIGH)
@@ -528,6 +585,20 @@ void i2c_start_xfer_notify(const int port, const uint16_t addr_flags);
  */
 void i2c_end_xfer_notify(const int port, const uint16_t addr_flags);
 
+/**
+ * Account one transaction in the I2C statistics (CONFIG_I2C_STATS).
+ *
+ * @param port		I2C port
+ * @param addr_flags	Peripheral address and flags
+ * @param bytes		Bytes written and read
+ * @param busy_us	Time the transaction held the bus
+ * @param attempts	Number of attempts, including retries
+ * @param naks		Number of attempts NAKed by the peripheral
+ * @param rv		Final result of the transaction
+ */
+void i2c_stats_record(int port, uint16_t addr_flags, int bytes,
+		      uint32_t busy_us, int attempts, int naks, int rv);
+
 /**
  * Defined in common/i2c_trace.c, used by i2c controller to notify tracing
  * functionality of transactions.
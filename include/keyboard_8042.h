@@ -77,6 +77,12 @@ void i8042_pause_to_host_queue(bool pause);
  */
 int keyboard_host_write_avaliable(void);
 
+/**
+ * Note the time the keyboard scanner saw a key change, for the latency of
+ * the scan code it is about to send (CONFIG_KEYBOARD_LATENCY).
+ */
+void keyboard_latency_key_event(void);
+
 #ifdef TEST_BUILD
 
 /**
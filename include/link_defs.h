@@ -94,6 +94,12 @@ extern const struct deferred_data __deferred_funcs[];
 extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
+/* Only with CONFIG_HOOK_DEFERRED_HEAP */
+extern uint16_t __deferred_heap[];
+extern uint16_t __deferred_heap_end[];
+/* Only with CONFIG_HOOK_DEBUG */
+extern uint32_t __deferred_stats[];
+extern uint32_t __deferred_stats_end[];
 
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
@@ -102,10 +102,14 @@ void motion_sense_fifo_commit_data(void);
  * @param fifo_info The struct to modify with the current information about the
  *	  fifo. WARNING: This must point to a buffer big enough for the struct
  *	  and also sizeof(uint16_t) * MAX_MOTION_SENSORS of extra space.
- * @param reset Whether or not to reset statistics after reading them.
+ * @param stats If not NULL, filled with the drop statistics. Written after
+ *	  fifo_info, so it may point inside its lost[] array.
+ * @param reset Whether or not to reset the lost counters after reading them.
+ *	  The drop statistics are only reset with the fifo.
  */
 void motion_sense_fifo_get_info(
-	struct ec_response_motion_sense_fifo_info *fifo_info, int reset);
+	struct ec_response_motion_sense_fifo_info *fifo_info,
+	struct ec_response_motion_sense_fifo_stats *stats, int reset);
 
 /**
  * Check whether or not the fifo has gone over its threshold.
@@ -126,6 +130,20 @@ int motion_sense_fifo_over_thres(void);
 int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 			   uint16_t *out_size);
 
+/**
+ * Read available committed entries from the fifo, in the packed encoding
+ * described in ec_commands.h. Stops when there is no room left for an
+ * unpacked entry.
+ *
+ * @param capacity_bytes The number of bytes available to be written to `out`.
+ * @param max_count The maximum number of entries to be placed in `out`.
+ * @param out The target to copy the encoded data into.
+ * @param out_size The number of bytes written to `out`.
+ * @return The number of entries written to `out`.
+ */
+int motion_sense_fifo_read_packed(int capacity_bytes, int max_count, void *out,
+				  uint16_t *out_size);
+
 /**
  * Reset the internal data structures of the motion sense fifo.
  */
@@ -77,6 +77,20 @@
 __stdlib_compat int vfnprintf(int (*addchar)(void *context, int c),
 			      void *context, const char *format, va_list args);
 
+/**
+ * Print formatted output to a buffer, like vfnprintf() with an addchar()
+ * storing characters in the buffer, but copying runs of characters at once.
+ * The output is not null-terminated.
+ *
+ * @param str		In: where to store the output, out: its end
+ * @param size		In: room in str, out: room left
+ * @param format	Format string (see above for acceptable formats)
+ * @param args		Parameters
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the output was truncated.
+ */
+__stdlib_compat int vfnprintf_buf(char **str, size_t *size, const char *format,
+				  va_list args);
+
 #ifdef TEST_BUILD
 /**
  * Converts @val to a string written in @buf. The value is converted from
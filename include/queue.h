@@ -229,6 +229,27 @@ size_t
 queue_peek_memcpy(struct queue const *q, void *dest, size_t i, size_t count,
 		  void *(*memcpy)(void *dest, const void *src, size_t n));
 
+/*
+ * Single-producer / single-consumer fast path.
+ *
+ * Only the producer moves the tail and only the consumer moves the head.
+ * Each side reads the other's index with acquire semantics and publishes its
+ * own with release semantics, so one side may run in an interrupt handler and
+ * the other in a task without any locking.  The chunk functions above follow
+ * the same rules, so queue_get_write_chunk()/queue_advance_tail() and
+ * queue_get_read_chunk()/queue_advance_head() may be used for zero-copy
+ * access from either side.
+ *
+ * Units are copied in at most two memcpy() calls, and the policy is skipped
+ * for queues using queue_policy_null.
+ */
+
+/* Add up to count units to the queue; returns the number added. */
+size_t queue_spsc_add(struct queue const *q, const void *src, size_t count);
+
+/* Remove up to count units from the queue; returns the number removed. */
+size_t queue_spsc_remove(struct queue const *q, void *dest, size_t count);
+
 /*
  * These macros will statically select the queue functions based on the number
  * of units that are to be added or removed if they can.  The single unit add
@@ -15,4 +15,14 @@
  */
 void update_ap_boot_time(enum boot_time_param param);
 
+/**
+ * Records how long the EC took to hash its RW image.
+ *
+ * Only the first hash after boot is kept, since later hashes are requested
+ * by the AP and are not on the boot path.
+ *
+ * @param hash_us	Time from hash start to final digest, in microseconds.
+ */
+void update_vboot_hash_time(uint32_t hash_us);
+
 #endif /* __CROS_EC_SYSTEM_BOOT_TIME_H */
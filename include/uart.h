@@ -380,6 +380,33 @@ enum ec_status uart_console_read_buffer_init(void);
 int uart_console_read_buffer(uint8_t type, char *dest, uint16_t dest_size,
 			     uint16_t *write_count);
 
+/**
+ * Read console output straight from the uart buffer, without a snapshot.
+ *
+ * Output is addressed by offset, the number of bytes output before it since
+ * boot, wrapping at 2^32. Reading continues where the previous read stopped
+ * as long as the caller passes back the offset it got.
+ *
+ * @param offset	in: offset of the first byte to read,
+ *			out: offset to read from next.
+ * @param lost		bytes overwritten before they could be read.
+ * @param dest		output buffer, not null-terminated.
+ * @param dest_size	size of output buffer.
+ * @param write_count	number of bytes written.
+ *
+ * @return result status (EC_RES_*), EC_RES_INVALID_PARAM if the offset is
+ * ahead of the output, e.g. it is from before the EC rebooted.
+ */
+enum ec_status uart_console_read_stream(uint32_t *offset, uint32_t *lost,
+					char *dest, uint16_t dest_size,
+					uint16_t *write_count);
+
+/**
+ * Get the offset of the oldest output in the uart buffer, to start
+ * `uart_console_read_stream()` from.
+ */
+uint32_t uart_console_stream_oldest(void);
+
 /**
  * Initialize tx buffer head and tail
  */
@@ -0,0 +1,266 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the biquad filter bank.
+ */
+
+#include "biquad_bank.h"
+#include "common.h"
+#include "test_util.h"
+#include "util.h"
+
+enum {
+	CH_GPU_DIE,
+	CH_APU_DIE,
+	CH_RESONANT,
+	CH_PASS,
+	CH_COUNT,
+};
+
+static const struct biquad_coeff coeff[CH_COUNT] = {
+	/* The Lotus die filters */
+	[CH_GPU_DIE] = { 59, 119, 59, -29863, 13716 },
+	[CH_APU_DIE] = { 34, 68, 34, -30587, 14340 },
+	/* Low pass at 0.05 fs with a Q of 2, which overshoots */
+	[CH_RESONANT] = { 372, 744, 372, -28929, 14034 },
+	[CH_PASS] = BIQUAD_COEFF_PASS,
+};
+
+#define ALL_CH (BIT(CH_COUNT) - 1)
+
+BIQUAD_BANK_DEFINE(bank, CH_COUNT);
+
+/* Double precision reference of one channel */
+struct reference {
+	double b0, b1, b2, a1, a2;
+	double x1, x2, y1, y2;
+};
+
+static void reference_init(struct reference *r, const struct biquad_coeff *c,
+			   double start)
+{
+	r->b0 = c->b0 / 16384.0;
+	r->b1 = c->b1 / 16384.0;
+	r->b2 = c->b2 / 16384.0;
+	r->a1 = c->a1 / 16384.0;
+	r->a2 = c->a2 / 16384.0;
+	r->x1 = r->x2 = r->y1 = r->y2 = start;
+}
+
+static double reference_update(struct reference *r, double x)
+{
+	double y = r->b0 * x + r->b1 * r->x1 + r->b2 * r->x2 - r->a1 * r->y1 -
+		   r->a2 * r->y2;
+
+	r->x2 = r->x1;
+	r->x1 = x;
+	r->y2 = r->y1;
+	r->y1 = y;
+	return y;
+}
+
+static void setup(void)
+{
+	int i;
+
+	for (i = 0; i < CH_COUNT; i++)
+		biquad_bank_set(&bank, i, &coeff[i]);
+	biquad_bank_reset(&bank);
+}
+
+/*
+ * Step every channel from start to end and check that the output stays
+ * within max_err of the reference all the way.
+ */
+static int check_step(const int *start, const int *end, int samples,
+		      double max_err)
+{
+	struct reference ref[CH_COUNT];
+	double y, err, worst = 0;
+	int i, n;
+
+	setup();
+	biquad_bank_update(&bank, start, ALL_CH);
+	for (i = 0; i < CH_COUNT; i++) {
+		reference_init(&ref[i], &coeff[i], start[i]);
+		TEST_EQ(biquad_bank_get(&bank, i), start[i], "%d");
+	}
+
+	for (n = 0; n < samples; n++) {
+		biquad_bank_update(&bank, end, ALL_CH);
+		for (i = 0; i < CH_COUNT; i++) {
+			y = reference_update(&ref[i], end[i]);
+			err = biquad_bank_get_scaled(&bank, i) /
+				      (double)(1 << BIQUAD_IN_SCALE) -
+			      y;
+			if (err < 0)
+				err = -err;
+			if (err > worst)
+				worst = err;
+		}
+	}
+
+	ccprintf("worst error %d/1000\n", (int)(worst * 1000));
+	TEST_ASSERT(worst <= max_err);
+
+	return EC_SUCCESS;
+}
+
+static int test_step_up(void)
+{
+	const int start[CH_COUNT] = { 30, 30, 30, 30 };
+	const int end[CH_COUNT] = { 80, 95, 60, 70 };
+
+	return check_step(start, end, 600, 0.04);
+}
+
+static int test_step_down(void)
+{
+	const int start[CH_COUNT] = { 90, 100, 50, 40 };
+	const int end[CH_COUNT] = { 35, 30, -20, 41 };
+
+	return check_step(start, end, 600, 0.04);
+}
+
+static int test_small_step(void)
+{
+	const int start[CH_COUNT] = { 45, 45, 45, 45 };
+	const int end[CH_COUNT] = { 46, 46, 46, 46 };
+
+	/* Truncation alone would leave the APU filter off by 0.35C. */
+	return check_step(start, end, 600, 0.04);
+}
+
+static int test_settles(void)
+{
+	const int in[CH_COUNT] = { 30, 30, 30, 30 };
+	const int step[CH_COUNT] = { 80, 80, 80, 80 };
+	int i;
+
+	setup();
+	biquad_bank_update(&bank, in, ALL_CH);
+	for (i = 0; i < 600; i++)
+		biquad_bank_update(&bank, step, ALL_CH);
+
+	/* Unity DC gain, except the APU filter whose gain is 136/137 */
+	TEST_EQ(biquad_bank_get(&bank, CH_GPU_DIE), 80, "%d");
+	TEST_EQ(biquad_bank_get(&bank, CH_APU_DIE), 79, "%d");
+	TEST_EQ(biquad_bank_get(&bank, CH_RESONANT), 79, "%d");
+	TEST_EQ(biquad_bank_get(&bank, CH_PASS), 80, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_pass_through(void)
+{
+	int in[CH_COUNT] = { 0 };
+	int i;
+
+	setup();
+	biquad_bank_set(&bank, CH_GPU_DIE, NULL);
+	for (i = -40; i < 120; i += 7) {
+		in[CH_GPU_DIE] = i;
+		in[CH_PASS] = -i;
+		biquad_bank_update(&bank, in, ALL_CH);
+		TEST_EQ(biquad_bank_get(&bank, CH_GPU_DIE), i, "%d");
+		TEST_EQ(biquad_bank_get(&bank, CH_PASS), -i, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_restart(void)
+{
+	const int hot[CH_COUNT] = { 90, 90, 90, 90 };
+	const int cold[CH_COUNT] = { 25, 26, 27, 28 };
+	int i;
+
+	setup();
+	biquad_bank_update(&bank, cold, ALL_CH);
+	for (i = 0; i < 10; i++)
+		biquad_bank_update(&bank, hot, ALL_CH);
+	TEST_LT(biquad_bank_get(&bank, CH_APU_DIE), 90, "%d");
+
+	/* Restarts from the next reading, not from the old state or 0 */
+	biquad_bank_reset(&bank);
+	biquad_bank_update(&bank, cold, ALL_CH);
+	for (i = 0; i < CH_COUNT; i++)
+		TEST_EQ(biquad_bank_get(&bank, i), cold[i], "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_invalid(void)
+{
+	const int cold[CH_COUNT] = { 25, 26, 27, 28 };
+	const int hot[CH_COUNT] = { 90, 90, 90, 90 };
+	int y, i;
+
+	/* A channel without a valid reading yet isn't primed. */
+	setup();
+	biquad_bank_update(&bank, hot, BIT(CH_GPU_DIE));
+	TEST_EQ(biquad_bank_get(&bank, CH_GPU_DIE), 90, "%d");
+	biquad_bank_update(&bank, cold, ALL_CH);
+	for (i = 0; i < CH_COUNT; i++) {
+		if (i != CH_GPU_DIE)
+			TEST_EQ(biquad_bank_get(&bank, i), cold[i], "%d");
+	}
+	TEST_GT(biquad_bank_get(&bank, CH_GPU_DIE), cold[CH_GPU_DIE], "%d");
+
+	/* Invalid readings don't move the output or the history. */
+	y = biquad_bank_get(&bank, CH_APU_DIE);
+	for (i = 0; i < 10; i++)
+		biquad_bank_update(&bank, hot, ALL_CH & ~BIT(CH_APU_DIE));
+	TEST_EQ(biquad_bank_get(&bank, CH_APU_DIE), y, "%d");
+	TEST_GT(biquad_bank_get(&bank, CH_PASS), cold[CH_PASS], "%d");
+
+	/* The next valid reading carries on from the old history. */
+	biquad_bank_update(&bank, cold, ALL_CH);
+	TEST_LE(biquad_bank_get(&bank, CH_APU_DIE), y, "%d");
+	TEST_GE(biquad_bank_get(&bank, CH_APU_DIE), y - 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_saturation(void)
+{
+	const int high[CH_COUNT] = { 1000, 1000, 1000, 1000 };
+	const int low[CH_COUNT] = { -1000, -1000, -1000, -1000 };
+	int n, y, peaked = 0;
+
+	/* Inputs are clamped, and so is the resonant overshoot. */
+	setup();
+	biquad_bank_update(&bank, low, ALL_CH);
+	TEST_EQ(biquad_bank_get(&bank, CH_PASS), -256, "%d");
+	for (n = 0; n < 200; n++) {
+		biquad_bank_update(&bank, high, ALL_CH);
+
+		/* Once up, it must not wrap around to the bottom. */
+		y = biquad_bank_get(&bank, CH_RESONANT);
+		if (peaked)
+			TEST_GT(y, 0, "%d");
+		peaked |= y > 200;
+	}
+	TEST_ASSERT(peaked);
+	TEST_EQ(biquad_bank_get(&bank, CH_PASS), 255, "%d");
+	TEST_EQ(biquad_bank_get(&bank, CH_RESONANT), 254, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_step_up);
+	RUN_TEST(test_step_down);
+	RUN_TEST(test_small_step);
+	RUN_TEST(test_settles);
+	RUN_TEST(test_pass_through);
+	RUN_TEST(test_restart);
+	RUN_TEST(test_invalid);
+	RUN_TEST(test_saturation);
+
+	test_print_result();
+}
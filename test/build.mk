@@ -23,6 +23,7 @@ test-list-host = accel_cal
 test-list-host += aes
 test-list-host += always_memset
 test-list-host += base32
+test-list-host += biquad_bank
 test-list-host += battery_config
 test-list-host += battery_get_params_smart
 test-list-host += benchmark
@@ -39,11 +40,16 @@ test-list-host += charge_manager_drp_charging
 test-list-host += charge_ramp
 test-list-host += chipset
 test-list-host += compile_time_macros
+test-list-host += console_binlog
 test-list-host += console_edit
 test-list-host += crc
+test-list-host += crc_slice4
+test-list-host += crc_slice8
 test-list-host += entropy
+test-list-host += event_log
 test-list-host += extpwr_gpio
 test-list-host += fan
+test-list-host += fan_pi
 test-list-host += flash
 test-list-host += float
 test-list-host += fp
@@ -56,8 +62,13 @@ test-list-host += fpsensor_state
 test-list-host += gettimeofday
 test-list-host += gyro_cal
 test-list-host += hooks
+test-list-host += hooks_deferred_heap
+test-list-host += hooks_sorted
 test-list-host += host_command
+test-list-host += host_command_hash
+test-list-host += i2c_async
 test-list-host += i2c_bitbang
+test-list-host += i2c_stats
 test-list-host += inductive_charging
 # This test times out in the CQ, and generally doesn't seem useful.
 # It is verifying the host test scheduler, which is never used in real boards.
@@ -82,6 +93,7 @@ test-list-host += motion_angle
 test-list-host += motion_angle_tablet
 test-list-host += motion_lid
 test-list-host += motion_sense_fifo
+test-list-host += motion_sense_fifo_packed
 test-list-host += mutex
 test-list-host += newton_fit
 test-list-host += nvidia_gpu
@@ -90,6 +102,7 @@ test-list-host += online_calibration_spoof
 test-list-host += pingpong
 test-list-host += power_button
 test-list-host += printf
+test-list-host += printf_benchmark
 test-list-host += queue
 test-list-host += rgb_keyboard
 test-list-host += rollback_secret
@@ -102,6 +115,7 @@ test-list-host += scoped_fast_cpu
 test-list-host += sha256
 test-list-host += sha256_unrolled
 test-list-host += shmalloc
+test-list-host += shmalloc_pools
 test-list-host += static_if
 test-list-host += static_if_error
 # TODO(b/237823627): When building for the host, we're linking against the
@@ -181,6 +195,7 @@ aes-y=aes.o
 %/test/always_memset.o: CFLAGS += -O3
 always_memset-y=always_memset.o
 base32-y=base32.o
+biquad_bank-y=biquad_bank.o
 battery_config-y=battery_config.o
 battery_get_params_smart-y=battery_get_params_smart.o
 benchmark-y=benchmark.o
@@ -197,14 +212,19 @@ charge_manager_drp_charging-y=charge_manager.o fake_usbc.o
 charge_ramp-y+=charge_ramp.o
 chipset-y+=chipset.o
 compile_time_macros-y=compile_time_macros.o
+console_binlog-y=console_binlog.o
 console_edit-y=console_edit.o
 cortexm_fpu-y=cortexm_fpu.o
 crc-y=crc.o
+crc_slice4-y=crc.o
+crc_slice8-y=crc.o
 debug-y=debug.o
 entropy-y=entropy.o
+event_log-y=event_log.o
 exception-y=exception.o
 extpwr_gpio-y=extpwr_gpio.o
 fan-y=fan.o
+fan_pi-y=fan_pi.o
 flash-y=flash.o
 flash_physical-y=flash_physical.o
 flash_write_protect-y=flash_write_protect.o
@@ -220,8 +240,13 @@ gettimeofday-y=gettimeofday.o
 global_initialization-y=global_initialization.o
 gyro_cal-y=gyro_cal.o gyro_cal_init_for_test.o
 hooks-y=hooks.o
+hooks_deferred_heap-y=hooks.o
+hooks_sorted-y=hooks.o
 host_command-y=host_command.o
+host_command_hash-y=host_command.o
+i2c_async-y=i2c_async.o
 i2c_bitbang-y=i2c_bitbang.o
+i2c_stats-y=i2c_stats.o
 inductive_charging-y=inductive_charging.o
 interrupt-y=interrupt.o
 irq_locking-y=irq_locking.o
@@ -239,6 +264,7 @@ motion_angle-y=motion_angle.o motion_angle_data_literals.o motion_common.o
 motion_angle_tablet-y=motion_angle_tablet.o motion_angle_data_literals_tablet.o motion_common.o
 motion_lid-y=motion_lid.o
 motion_sense_fifo-y=motion_sense_fifo.o
+motion_sense_fifo_packed-y=motion_sense_fifo.o
 nvidia_gpu-y=nvidia_gpu.o
 online_calibration-y=online_calibration.o
 online_calibration_spoof-y=online_calibration_spoof.o gyro_cal_init_for_test.o
@@ -257,6 +283,7 @@ pingpong-y=pingpong.o
 power_button-y=power_button.o
 powerdemo-y=powerdemo.o
 printf-y=printf.o
+printf_benchmark-y=printf_benchmark.o
 queue-y=queue.o
 rng_benchmark-y=rng_benchmark.o
 rollback-y=rollback.o
@@ -272,6 +299,7 @@ scoped_fast_cpu-y=scoped_fast_cpu.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
 shmalloc-y=shmalloc.o
+shmalloc_pools-y=shmalloc.o
 static_if-y=static_if.o
 stdlib-y=stdlib.o
 std_vector-y=std_vector.o
@@ -0,0 +1,221 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the binary console log.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+static const char fmt_args[] = "int %d str %s wide %lld char %c hex %08x";
+static const char fmt_star[] = "%*d %.*s";
+static const char fmt_none[] = "no arguments";
+
+static union {
+	struct ec_response_console_stream r;
+	uint8_t bytes[256];
+} resp;
+
+static int read_log(uint32_t offset, uint8_t flags, int size)
+{
+	struct ec_params_console_stream p = {
+		.offset = offset,
+		.flags = flags,
+	};
+
+	return test_send_host_command(
+		EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_CONSOLE_BINLOG), 0, &p,
+		sizeof(p), &resp, size);
+}
+
+/* Offset of the end of the log, where the next record goes */
+static uint32_t log_end(void)
+{
+	uint32_t offset = 0;
+	uint8_t flags = EC_CONSOLE_STREAM_OLDEST;
+
+	do {
+		read_log(offset, flags, sizeof(resp));
+		offset = resp.r.next_offset;
+		flags = 0;
+	} while (resp.r.size);
+
+	return offset;
+}
+
+static const struct ec_binlog_record *first_record(void)
+{
+	return (const struct ec_binlog_record *)resp.r.data;
+}
+
+static int test_record_encoding(void)
+{
+	const struct ec_binlog_record *rec;
+	const uint8_t *arg;
+	uint64_t before, ts;
+	uint32_t offset = log_end();
+	int32_t i;
+	int64_t w;
+
+	before = get_time().val;
+	cprints(CC_SYSTEM, fmt_args, -5, "abc", -(1LL << 40), 'x', 0x1234);
+
+	TEST_EQ(read_log(offset, 0, sizeof(resp)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.lost, 0, "%u");
+	rec = first_record();
+	TEST_EQ(resp.r.size, rec->size, "%d");
+	TEST_EQ(resp.r.next_offset, offset + rec->size, "%u");
+	TEST_EQ(rec->channel, CC_SYSTEM, "%d");
+	TEST_EQ(rec->format, (uint32_t)(uintptr_t)fmt_args, "%u");
+	ts = ((uint64_t)rec->time_hi << 32) | rec->time_lo;
+	TEST_ASSERT(ts >= before && ts <= get_time().val);
+
+	/* int, string, 64-bit, char, int */
+	TEST_EQ(rec->size, (int)(sizeof(*rec) + 4 + 4 + 8 + 4 + 4), "%d");
+	arg = (const uint8_t *)(rec + 1);
+	memcpy(&i, arg, sizeof(i));
+	TEST_EQ(i, -5, "%d");
+	arg += sizeof(i);
+	TEST_ASSERT(!strcmp((const char *)arg, "abc"));
+	arg += 4;
+	memcpy(&w, arg, sizeof(w));
+	TEST_ASSERT(w == -(1LL << 40));
+	arg += sizeof(w);
+	memcpy(&i, arg, sizeof(i));
+	TEST_EQ(i, 'x', "%d");
+	arg += sizeof(i);
+	memcpy(&i, arg, sizeof(i));
+	TEST_EQ(i, 0x1234, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_star_arguments(void)
+{
+	const struct ec_binlog_record *rec;
+	const uint8_t *arg;
+	uint32_t offset = log_end();
+	int32_t v[3];
+
+	/* Both '*' values are logged, and the string is cut at precision. */
+	cprints(CC_SYSTEM, fmt_star, 6, 42, 2, "xyz");
+
+	TEST_EQ(read_log(offset, 0, sizeof(resp)), EC_RES_SUCCESS, "%d");
+	rec = first_record();
+	TEST_EQ(rec->size, (int)(sizeof(*rec) + sizeof(v) + 3), "%d");
+	arg = (const uint8_t *)(rec + 1);
+	memcpy(v, arg, sizeof(v));
+	TEST_EQ(v[0], 6, "%d");
+	TEST_EQ(v[1], 42, "%d");
+	TEST_EQ(v[2], 2, "%d");
+	TEST_ASSERT(!strcmp((const char *)arg + sizeof(v), "xy"));
+
+	return EC_SUCCESS;
+}
+
+static int vprints(enum console_channel channel, const char *format, ...)
+{
+	va_list args;
+	int rv;
+
+	va_start(args, format);
+	rv = console_binlog_vprints(channel, format, args);
+	va_end(args);
+
+	return rv;
+}
+
+static int test_text_fallback(void)
+{
+	char long_str[128];
+	uint32_t offset = log_end();
+
+	/* Command output and records too large to log stay text. */
+	memset(long_str, 'a', sizeof(long_str) - 1);
+	long_str[sizeof(long_str) - 1] = '\0';
+	TEST_NE(vprints(CC_COMMAND, fmt_none), EC_SUCCESS, "%d");
+	TEST_NE(vprints(CC_SYSTEM, "%s", long_str), EC_SUCCESS, "%d");
+	TEST_EQ(log_end(), offset, "%u");
+
+	TEST_EQ(vprints(CC_SYSTEM, fmt_none), EC_SUCCESS, "%d");
+	TEST_EQ(log_end(), offset + (int)sizeof(struct ec_binlog_record),
+		"%u");
+
+	return EC_SUCCESS;
+}
+
+static int test_overwrite(void)
+{
+	const struct ec_binlog_record *rec;
+	uint32_t offset = log_end();
+	int n = CONFIG_CONSOLE_BINLOG_BUF_SIZE / sizeof(*rec);
+	int i, seen = 0;
+
+	/* Twice the buffer: the first half is overwritten. */
+	for (i = 0; i < 2 * n; i++)
+		cprints(CC_SYSTEM, fmt_none);
+
+	TEST_EQ(read_log(offset, 0, sizeof(resp)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.lost, n * (int)sizeof(*rec), "%u");
+	offset += resp.r.lost;
+	do {
+		TEST_EQ(resp.r.size % (int)sizeof(*rec), 0, "%d");
+		for (i = 0; i < resp.r.size; i += sizeof(*rec)) {
+			rec = (const void *)(resp.r.data + i);
+			TEST_EQ(rec->format, (uint32_t)(uintptr_t)fmt_none,
+				"%u");
+			seen++;
+		}
+		offset += resp.r.size;
+		TEST_EQ(resp.r.next_offset, offset, "%u");
+		TEST_EQ(read_log(offset, 0, sizeof(resp)), EC_RES_SUCCESS,
+			"%d");
+		TEST_EQ(resp.r.lost, 0, "%u");
+	} while (resp.r.size);
+	TEST_EQ(seen, n, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_whole_records(void)
+{
+	uint32_t offset = log_end();
+	int size = sizeof(resp.r) + sizeof(struct ec_binlog_record);
+
+	cprints(CC_SYSTEM, fmt_none);
+	cprints(CC_SYSTEM, fmt_args, 1, "a", 2LL, 'b', 3);
+
+	/* Room for the first record only */
+	TEST_EQ(read_log(offset, 0, size + 10), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.size, (int)sizeof(struct ec_binlog_record), "%d");
+	offset = resp.r.next_offset;
+
+	/* Offsets must be at a record boundary, and not ahead of the log. */
+	TEST_EQ(read_log(offset + 1, 0, sizeof(resp)), EC_RES_INVALID_PARAM,
+		"%d");
+	TEST_EQ(read_log(log_end() + 1, 0, sizeof(resp)), EC_RES_INVALID_PARAM,
+		"%d");
+
+	TEST_EQ(read_log(offset, 0, sizeof(resp)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(first_record()->format, (uint32_t)(uintptr_t)fmt_args, "%u");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_record_encoding);
+	RUN_TEST(test_star_arguments);
+	RUN_TEST(test_text_fallback);
+	RUN_TEST(test_overwrite);
+	RUN_TEST(test_whole_records);
+
+	test_print_result();
+}
@@ -30,6 +30,15 @@ static int command_test_2(int argc, const char **argv)
 }
 DECLARE_CONSOLE_COMMAND(test2, command_test_2, NULL, NULL);
 
+static int tabtest_call_cnt;
+
+static int command_tabtest(int argc, const char **argv)
+{
+	tabtest_call_cnt++;
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(tabtest, command_tabtest, NULL, NULL);
+
 /*****************************************************************************/
 /* Test utilities */
 
@@ -314,6 +323,101 @@ static int test_buf_notify_null(void)
 	return EC_SUCCESS;
 }
 
+/* Read everything from offset on, returns the bytes read */
+static int read_stream(uint32_t *offset, char *buffer, int size)
+{
+	uint32_t lost;
+	uint16_t count;
+	int len = 0;
+
+	do {
+		if (uart_console_read_stream(offset, &lost, buffer + len,
+					     size - len, &count))
+			return -1;
+		len += count;
+	} while (count && len < size);
+
+	return len;
+}
+
+/*
+ * The test macros print to the console too, so each step drains the output
+ * first and only checks its results once it is done with the stream.
+ */
+static int test_console_stream(void)
+{
+	struct ec_params_console_stream p = {
+		.flags = EC_CONSOLE_STREAM_OLDEST,
+	};
+	struct ec_response_console_stream *r;
+	char buffer[CONFIG_UART_TX_BUF_SIZE];
+	uint32_t offset, start, lost;
+	uint16_t count, count2;
+	int i, len, len2, rv;
+
+	cflush();
+	offset = uart_console_stream_oldest();
+	TEST_ASSERT(read_stream(&offset, buffer, sizeof(buffer)) >= 0);
+
+	start = offset;
+	cputs(CC_SYSTEM, "stream me\n");
+	cflush();
+	len = read_stream(&offset, buffer, sizeof(buffer));
+	/* Nothing new after that */
+	len2 = read_stream(&offset, buffer + len, sizeof(buffer) - len);
+	TEST_EQ(len, 11, "%d");
+	TEST_ASSERT(strncmp(buffer, "stream me\r\n", 11) == 0);
+	TEST_EQ(offset, start + 11, "%u");
+	TEST_EQ(len2, 0, "%d");
+
+	/* Reads resume where the last one stopped */
+	cflush();
+	TEST_ASSERT(read_stream(&offset, buffer, sizeof(buffer)) >= 0);
+	cputs(CC_SYSTEM, "0123456789");
+	cflush();
+	uart_console_read_stream(&offset, &lost, buffer, 4, &count);
+	uart_console_read_stream(&offset, &lost, buffer + 4, 100, &count2);
+	TEST_EQ(count, 4, "%d");
+	TEST_EQ(count2, 6, "%d");
+	TEST_ASSERT(strncmp(buffer, "0123456789", 10) == 0);
+
+	/* Output overwritten before being read is reported as lost */
+	cflush();
+	TEST_ASSERT(read_stream(&offset, buffer, sizeof(buffer)) >= 0);
+	start = offset;
+	for (i = 0; i < 2 * CONFIG_UART_TX_BUF_SIZE / 10; i++) {
+		cputs(CC_SYSTEM, "abcdefghij");
+		cflush();
+	}
+	rv = uart_console_read_stream(&offset, &lost, buffer, sizeof(buffer),
+				      &count);
+	TEST_EQ(rv, EC_RES_SUCCESS, "%d");
+	TEST_EQ(lost + count, 2 * CONFIG_UART_TX_BUF_SIZE / 10 * 10, "%u");
+	TEST_EQ(count, CONFIG_UART_TX_BUF_SIZE - 1, "%d");
+	TEST_EQ(offset - start, lost + count, "%u");
+
+	/* Offsets ahead of the output are from before a reboot */
+	offset = uart_console_stream_oldest() + 2 * CONFIG_UART_TX_BUF_SIZE;
+	TEST_EQ(uart_console_read_stream(&offset, &lost, buffer,
+					 sizeof(buffer), &count),
+		EC_RES_INVALID_PARAM, "%d");
+
+	/* Same through the host command */
+	TEST_EQ(test_send_host_command(
+			EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_CONSOLE_STREAM), 0,
+			&p, sizeof(p), buffer, sizeof(buffer)),
+		EC_RES_SUCCESS, "%d");
+	r = (struct ec_response_console_stream *)buffer;
+	TEST_EQ(r->lost, 0, "%u");
+	TEST_EQ(r->size, (int)(sizeof(buffer) - sizeof(*r)), "%d");
+	offset = r->next_offset;
+	TEST_EQ(uart_console_read_stream(&offset, &lost, buffer,
+					 sizeof(buffer), &count),
+		EC_RES_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
 static const char *large_string =
 	"This is a very long string, it will cause a buffer flush at "
 	"some point while printing to the shell. Long long text. Blah "
@@ -333,6 +437,70 @@ static int test_cprints_overflow(void)
 	return EC_SUCCESS;
 }
 
+static int test_partial_match(void)
+{
+	cmd_1_call_cnt = 0;
+	cmd_2_call_cnt = 0;
+
+	/* Ambiguous prefix runs nothing */
+	UART_INJECT("test\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 0 && cmd_2_call_cnt == 0);
+
+	/* Case-insensitive full match */
+	UART_INJECT("TEST2\n");
+	msleep(30);
+	TEST_ASSERT(cmd_2_call_cnt == 1);
+
+	/* Unique prefix */
+	tabtest_call_cnt = 0;
+	UART_INJECT("tabt\n");
+	msleep(30);
+	TEST_ASSERT(tabtest_call_cnt == 1);
+	return EC_SUCCESS;
+}
+
+static int test_tab_unique(void)
+{
+	tabtest_call_cnt = 0;
+	UART_INJECT("tab\tx\n");
+	msleep(30);
+	/* Completion adds a space, so 'x' becomes an argument */
+	TEST_ASSERT(tabtest_call_cnt == 1);
+	return EC_SUCCESS;
+}
+
+static int test_tab_common_prefix(void)
+{
+	cmd_1_call_cnt = 0;
+	UART_INJECT("tes\t1\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 1);
+	return EC_SUCCESS;
+}
+
+static int test_tab_list(void)
+{
+	cmd_2_call_cnt = 0;
+	/* Second TAB can't extend the input, so it lists both commands */
+	UART_INJECT("tes\t\t2\n");
+	msleep(30);
+	TEST_ASSERT(cmd_2_call_cnt == 1);
+	return EC_SUCCESS;
+}
+
+static int test_tab_no_match(void)
+{
+	cmd_1_call_cnt = 0;
+	/* TAB after the command name, or with no match, is ignored */
+	UART_INJECT("test1 \t\n");
+	msleep(30);
+	UART_INJECT("zzz\t\b\b\btest1\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 2);
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
@@ -349,8 +517,14 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_history_edit);
 	RUN_TEST(test_history_stash);
 	RUN_TEST(test_history_list);
+	RUN_TEST(test_partial_match);
+	RUN_TEST(test_tab_unique);
+	RUN_TEST(test_tab_common_prefix);
+	RUN_TEST(test_tab_list);
+	RUN_TEST(test_tab_no_match);
 	RUN_TEST(test_output_channel);
 	RUN_TEST(test_buf_notify_null);
+	RUN_TEST(test_console_stream);
 	RUN_TEST(test_cprints_overflow);
 
 	test_print_result();
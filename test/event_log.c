@@ -0,0 +1,402 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the lock-free event log FIFO.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "event_log.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "usb_pd.h"
+#include "util.h"
+
+#define UNIT_SIZE sizeof(struct event_log_entry)
+#define UNIT_COUNT (CONFIG_EVENT_LOG_SIZE / UNIT_SIZE)
+#define ENTRY_BYTES(payload_sz) \
+	(UNIT_SIZE * (1 + DIV_ROUND_UP((payload_sz), UNIT_SIZE)))
+
+#define TYPE_TASK 1
+#define TYPE_ISR 2
+
+static uint8_t buf[CONFIG_EVENT_LOG_SIZE];
+
+/* Events produced by interrupts, when enabled */
+static volatile int isr_active;
+static volatile uint32_t isr_seq;
+
+/* No accessory to fetch logs from */
+uint8_t board_get_usb_pd_port_count(void)
+{
+	return 0;
+}
+
+uint16_t pd_get_identity_vid(int port)
+{
+	return 0;
+}
+
+int pd_fetch_acc_log_entry(int port)
+{
+	return EC_RES_SUCCESS;
+}
+
+static void add_event(uint8_t type, int payload_sz, uint16_t seq)
+{
+	uint8_t payload[16];
+	int i;
+
+	for (i = 0; i < payload_sz; i++)
+		payload[i] = seq + i;
+	log_add_event(type, payload_sz, seq, payload, 0);
+}
+
+static void log_isr(void)
+{
+	add_event(TYPE_ISR, 4, isr_seq++);
+}
+
+void interrupt_generator(void)
+{
+	while (1) {
+		udelay(10 + prng_no_seed() % 50);
+		if (isr_active)
+			task_trigger_test_interrupt(log_isr);
+	}
+}
+
+static void drain_log_only(void)
+{
+	while (log_dequeue_events(buf, sizeof(buf)))
+		;
+}
+
+static void drain(void)
+{
+	drain_log_only();
+	log_clear_dropped();
+}
+
+/* Check one dequeued entry is intact, returns its size in bytes */
+static int check_entry(const struct event_log_entry *r)
+{
+	int size = EVENT_LOG_SIZE(r->size);
+	int i;
+
+	for (i = 0; i < size; i++) {
+		if (r->payload[i] != (uint8_t)(r->data + i))
+			return 0;
+	}
+
+	return ENTRY_BYTES(size);
+}
+
+static int test_empty(void)
+{
+	struct event_log_entry r[DIV_ROUND_UP(EVENT_LOG_MAX_ENTRY_SIZE,
+					      UNIT_SIZE)];
+
+	drain();
+	TEST_EQ(log_dequeue_event(r), (int)UNIT_SIZE, "%d");
+	TEST_EQ(r[0].type, EVENT_LOG_NO_ENTRY, "%d");
+	TEST_EQ(log_dequeue_events(buf, sizeof(buf)), 0, "%d");
+	TEST_EQ(log_clear_dropped(), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_single_dequeue(void)
+{
+	struct event_log_entry r[DIV_ROUND_UP(EVENT_LOG_MAX_ENTRY_SIZE,
+					      UNIT_SIZE)];
+
+	drain();
+	add_event(TYPE_TASK, 12, 0x1234);
+	TEST_EQ(log_dequeue_event(r), (int)ENTRY_BYTES(12), "%d");
+	TEST_EQ(r[0].type, TYPE_TASK, "%d");
+	TEST_EQ(r[0].data, 0x1234, "0x%x");
+	TEST_EQ(check_entry(r), (int)ENTRY_BYTES(12), "%d");
+	TEST_EQ(log_dequeue_event(r), (int)UNIT_SIZE, "%d");
+	TEST_EQ(r[0].type, EVENT_LOG_NO_ENTRY, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_bulk_dequeue(void)
+{
+	static const int sizes[] = { 0, 4, 8, 12, 16 };
+	const struct event_log_entry *r;
+	int i, len, off, max;
+
+	drain();
+	for (i = 0; i < ARRAY_SIZE(sizes); i++)
+		add_event(TYPE_TASK, sizes[i], i);
+
+	/* Room for the first three entries and part of the fourth */
+	max = ENTRY_BYTES(0) + ENTRY_BYTES(4) + ENTRY_BYTES(8) + UNIT_SIZE;
+	len = log_dequeue_events(buf, max);
+	TEST_EQ(len, max - (int)UNIT_SIZE, "%d");
+	for (i = 0, off = 0; off < len; i++) {
+		r = (const struct event_log_entry *)(buf + off);
+		TEST_EQ(r->data, i, "%d");
+		TEST_EQ(EVENT_LOG_SIZE(r->size), sizes[i], "%d");
+		off += check_entry(r);
+	}
+	TEST_EQ(i, 3, "%d");
+
+	/* The rest is returned by the next call */
+	len = log_dequeue_events(buf, sizeof(buf));
+	TEST_EQ(len, (int)(ENTRY_BYTES(12) + ENTRY_BYTES(16)), "%d");
+	r = (const struct event_log_entry *)buf;
+	TEST_EQ(r->data, 3, "%d");
+	TEST_EQ(log_dequeue_events(buf, sizeof(buf)), 0, "%d");
+	TEST_EQ(log_clear_dropped(), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_overflow(void)
+{
+	const int fit = UNIT_COUNT / (ENTRY_BYTES(8) / UNIT_SIZE);
+	const struct event_log_entry *r;
+	int i, len;
+
+	drain();
+	for (i = 0; i < fit + 8; i++)
+		add_event(TYPE_TASK, 8, i);
+
+	/* The oldest entries were thrown away to make room */
+	TEST_EQ(log_clear_dropped(), 8, "%d");
+	TEST_EQ(log_clear_dropped(), 0, "%d");
+	len = log_dequeue_events(buf, sizeof(buf));
+	TEST_EQ(len, fit * (int)ENTRY_BYTES(8), "%d");
+	for (i = 0; i < fit; i++) {
+		r = (const struct event_log_entry *)(buf + i * ENTRY_BYTES(8));
+		TEST_EQ(r->data, i + 8, "%d");
+		TEST_ASSERT(check_entry(r));
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_read_cursor(void)
+{
+	const struct event_log_entry *r = (const void *)buf;
+	uint32_t cursor, oldest;
+	int len, i;
+
+	drain();
+	for (i = 0; i < 3; i++)
+		add_event(TYPE_TASK, 4, i);
+
+	/* Reading leaves the entries in the log */
+	oldest = cursor = log_oldest_cursor();
+	len = log_read_events(&cursor, buf, 2 * ENTRY_BYTES(4));
+	TEST_EQ(len, 2 * (int)ENTRY_BYTES(4), "%d");
+	TEST_EQ(cursor, oldest, "%u");
+	TEST_EQ(r->data, 0, "%d");
+	len = log_read_events(&cursor, buf, 2 * ENTRY_BYTES(4));
+	TEST_EQ(len, 2 * (int)ENTRY_BYTES(4), "%d");
+	TEST_EQ(r->data, 0, "%d");
+
+	/* Positions inside an entry or past the end are rejected */
+	cursor = oldest + 1;
+	TEST_EQ(log_read_events(&cursor, buf, sizeof(buf)), -1, "%d");
+	cursor = oldest + 3 * ENTRY_BYTES(4) / UNIT_SIZE + 1;
+	TEST_EQ(log_read_events(&cursor, buf, sizeof(buf)), -1, "%d");
+
+	/* Moving the cursor on removes the entries read */
+	cursor = oldest + 2 * ENTRY_BYTES(4) / UNIT_SIZE;
+	len = log_read_events(&cursor, buf, sizeof(buf));
+	TEST_EQ(len, (int)ENTRY_BYTES(4), "%d");
+	TEST_EQ(r->data, 2, "%d");
+	TEST_EQ(log_oldest_cursor(), cursor, "%u");
+
+	/* Nothing new after the last entry */
+	cursor += len / UNIT_SIZE;
+	TEST_EQ(log_read_events(&cursor, buf, sizeof(buf)), 0, "%d");
+
+	/* Entries discarded before being read move the cursor forward */
+	oldest = cursor;
+	for (i = 0; i < UNIT_COUNT + 2; i++)
+		add_event(TYPE_TASK, 0, i);
+	len = log_read_events(&cursor, buf, sizeof(buf));
+	TEST_EQ(len, (int)(UNIT_COUNT * UNIT_SIZE), "%d");
+	TEST_EQ(cursor, oldest + 2, "%u");
+	TEST_EQ(r->data, 2, "%d");
+	TEST_EQ(log_clear_dropped(), 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int get_log_entries(int version, const void *p, int p_size)
+{
+	return test_send_host_command(
+		EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_PD_GET_LOG_ENTRIES),
+		version, p, p_size, buf, sizeof(buf));
+}
+
+static int test_host_command(void)
+{
+	struct ec_response_pd_get_log_entries *r = (void *)buf;
+	const struct ec_response_pd_log *e;
+	int i;
+
+	drain();
+	for (i = 0; i < 3; i++)
+		add_event(PD_EVENT_MCU_CONNECT, 4, i);
+	log_add_event(PD_EVENT_MCU_CONNECT, 0, 0, NULL, 0);
+
+	TEST_EQ(get_log_entries(0, NULL, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->dropped, 0, "%d");
+	TEST_EQ(r->size, 3 * (int)ENTRY_BYTES(4) + (int)ENTRY_BYTES(0), "%d");
+	for (i = 0; i < 3; i++) {
+		e = (const void *)(r->entries + i * ENTRY_BYTES(4));
+		TEST_EQ(e->type, PD_EVENT_MCU_CONNECT, "%d");
+		TEST_EQ(e->data, i, "%d");
+		TEST_EQ(PD_LOG_SIZE(e->size_port), 4, "%d");
+	}
+
+	/* Empty log, with the entries lost since the last read */
+	for (i = 0; i < UNIT_COUNT + 5; i++)
+		add_event(PD_EVENT_MCU_CONNECT, 0, i);
+	drain_log_only();
+	TEST_EQ(get_log_entries(0, NULL, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->dropped, 5, "%d");
+	TEST_EQ(r->size, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_host_command_cursor(void)
+{
+	struct ec_params_pd_get_log_entries_v1 p = {
+		.flags = EC_PD_LOG_ENTRIES_OLDEST,
+	};
+	struct ec_response_pd_get_log_entries_v1 *r = (void *)buf;
+	const struct ec_response_pd_log *e;
+	int i;
+
+	drain();
+	for (i = 0; i < 3; i++)
+		add_event(PD_EVENT_MCU_CONNECT, 4, i);
+
+	TEST_EQ(get_log_entries(1, &p, sizeof(p)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->size, 3 * (int)ENTRY_BYTES(4), "%d");
+	TEST_EQ(r->next_cursor - r->cursor,
+		(uint32_t)(3 * ENTRY_BYTES(4) / UNIT_SIZE), "%u");
+
+	/* The same cursor gets the same entries again */
+	p.flags = 0;
+	p.cursor = r->cursor;
+	TEST_EQ(get_log_entries(1, &p, sizeof(p)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->cursor, p.cursor, "%u");
+	e = (const void *)r->entries;
+	TEST_EQ(e->data, 0, "%d");
+
+	/* Then nothing new, until another entry is logged */
+	p.cursor = r->next_cursor;
+	TEST_EQ(get_log_entries(1, &p, sizeof(p)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->size, 0, "%d");
+	TEST_EQ(r->next_cursor, p.cursor, "%u");
+	add_event(PD_EVENT_MCU_CONNECT, 4, 3);
+	TEST_EQ(get_log_entries(1, &p, sizeof(p)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->size, (int)ENTRY_BYTES(4), "%d");
+	TEST_EQ(e->data, 3, "%d");
+
+	p.cursor = r->next_cursor + 1;
+	TEST_EQ(get_log_entries(1, &p, sizeof(p)), EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static uint32_t received;
+static uint16_t next_task, next_isr;
+
+/* Sequence numbers are 16-bit, seq must not be before next */
+#define SEQ_IN_ORDER(seq, next) ((uint16_t)((seq) - (next)) < 0x8000)
+
+/* Dequeue everything, checking the order of each source's events */
+static int drain_and_check(void)
+{
+	const struct event_log_entry *r;
+	int len, off, size;
+
+	while ((len = log_dequeue_events(buf, sizeof(buf)))) {
+		for (off = 0; off < len; off += size) {
+			r = (const struct event_log_entry *)(buf + off);
+			size = check_entry(r);
+			TEST_ASSERT(size);
+			if (r->type == TYPE_TASK) {
+				TEST_ASSERT(SEQ_IN_ORDER(r->data, next_task));
+				next_task = r->data + 1;
+			} else {
+				TEST_EQ(r->type, TYPE_ISR, "%d");
+				TEST_ASSERT(SEQ_IN_ORDER(r->data, next_isr));
+				next_isr = r->data + 1;
+			}
+			received++;
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Interrupts add events while the task is in the middle of adding or
+ * dequeuing its own: every event must come out whole and in order, or be
+ * counted as dropped.
+ */
+static int test_concurrent_writers(void)
+{
+	timestamp_t deadline = get_time();
+	uint32_t task_seq, dropped = 0;
+
+	drain();
+	received = 0;
+	next_task = next_isr = 0;
+	isr_seq = 0;
+	isr_active = 1;
+
+	deadline.val += 200 * MSEC;
+	for (task_seq = 0; !timestamp_expired(deadline, NULL); task_seq++) {
+		add_event(TYPE_TASK, task_seq % 17, task_seq);
+		if (task_seq % 8 == 7) {
+			TEST_ASSERT(drain_and_check() == EC_SUCCESS);
+			dropped += log_clear_dropped();
+		}
+	}
+
+	/* Let a pending interrupt finish before the final count */
+	isr_active = 0;
+	udelay(1000);
+	TEST_ASSERT(drain_and_check() == EC_SUCCESS);
+	dropped += log_clear_dropped();
+
+	ccprintf("%u task + %u isr events, %u received, %u dropped\n",
+		 task_seq, isr_seq, received, dropped);
+	TEST_ASSERT(isr_seq > 0);
+	TEST_EQ(received + dropped, task_seq + isr_seq, "%u");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_empty);
+	RUN_TEST(test_single_dequeue);
+	RUN_TEST(test_bulk_dequeue);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_read_cursor);
+	RUN_TEST(test_host_command);
+	RUN_TEST(test_host_command_cursor);
+	RUN_TEST(test_concurrent_writers);
+
+	test_print_result();
+}
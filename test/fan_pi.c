@@ -0,0 +1,189 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the predictive PI fan controller.
+ */
+
+#include "common.h"
+#include "fan_pi.h"
+#include "test_util.h"
+#include "util.h"
+
+#define DT_MS 1000
+
+static const struct fan_pi_sensor sensors[] = {
+	/* A die: fast */
+	{
+		.temp_off_mk = 323000,
+		.temp_target_mk = 338000,
+		.temp_max_mk = 353000,
+		.tau_ms = 5000,
+	},
+	/* A board sensor: slow */
+	{
+		.temp_off_mk = 320000,
+		.temp_target_mk = 328000,
+		.temp_max_mk = 336000,
+		.tau_ms = 30000,
+	},
+};
+
+static const struct fan_pi_config cfg = {
+	.sensors = sensors,
+	.num_sensors = ARRAY_SIZE(sensors),
+	.kp = 2 * FAN_PI_GAIN_ONE,
+	.ki = FAN_PI_GAIN_ONE / 32,
+	.ff_per_w = 400,
+	.slew_up = 10,
+	.slew_down = 2,
+};
+
+static struct fan_pi_state state;
+
+static int run(int die_mk, int board_mk, int power_mw, int seconds)
+{
+	int temps[] = { die_mk, board_mk };
+	int out = 0;
+
+	while (seconds--)
+		out = fan_pi_update(&cfg, &state, temps, power_mw, DT_MS);
+
+	return out;
+}
+
+static int test_cold(void)
+{
+	fan_pi_reset(&state);
+
+	/* Below fan off, power limits alone don't start the fan. */
+	TEST_EQ(run(310000, 310000, 60000, 60), 0, "%d");
+	TEST_EQ(state.hottest, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_slew(void)
+{
+	int prev, out, i;
+
+	fan_pi_reset(&state);
+	run(310000, 310000, 0, 5);
+
+	/* Far too hot: full speed, no faster than 10% per second. */
+	prev = 0;
+	for (i = 0; i < 10; i++) {
+		out = run(360000, 340000, 0, 1);
+		TEST_LE(out - prev, 10 * DT_MS, "%d");
+		TEST_GT(out, prev, "%d");
+		prev = out;
+	}
+	TEST_EQ(run(360000, 340000, 0, 1), FAN_PI_OUTPUT_MAX, "%d");
+
+	/* Cold again: down at 2% per second. */
+	prev = FAN_PI_OUTPUT_MAX;
+	for (i = 0; i < 10; i++) {
+		out = run(310000, 310000, 0, 1);
+		TEST_EQ(prev - out, 2 * DT_MS, "%d");
+		prev = out;
+	}
+	TEST_EQ(run(310000, 310000, 0, 60), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_prediction(void)
+{
+	int flat, rising, t;
+
+	/* Just under the set point and steady */
+	fan_pi_reset(&state);
+	run(336000, 310000, 0, 20);
+	flat = run(336000, 310000, 0, 1);
+
+	/* Reaching the same temperature at 1K/s */
+	fan_pi_reset(&state);
+	for (t = 316000; t < 336000; t += 1000)
+		run(t, 310000, 0, 1);
+	rising = run(336000, 310000, 0, 1);
+
+	TEST_EQ(flat, 0, "%d");
+	TEST_GT(rising, 0, "%d");
+
+	/* The slow sensor rising slowly also counts, and drives. */
+	fan_pi_reset(&state);
+	for (t = 320000; t < 326000; t += 200)
+		run(310000, t, 0, 1);
+	TEST_GT(run(310000, 326000, 0, 1), 0, "%d");
+	TEST_EQ(state.hottest, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_integral(void)
+{
+	int out;
+
+	/* Held above the set point, the integral keeps pushing. */
+	fan_pi_reset(&state);
+	out = run(341000, 310000, 0, 30);
+	TEST_LT(out, run(341000, 310000, 0, 30), "%d");
+
+	/* Saturated for long, it must not wind up past the output range. */
+	run(360000, 340000, 0, 600);
+	TEST_LE(state.integral, FAN_PI_OUTPUT_MAX, "%d");
+	run(330000, 310000, 0, 120);
+	TEST_LT(state.output, FAN_PI_OUTPUT_MAX / 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_feed_forward(void)
+{
+	int idle, loaded;
+
+	/* At the set point, more power means more fan. */
+	fan_pi_reset(&state);
+	idle = run(338000, 310000, 0, 30);
+	fan_pi_reset(&state);
+	loaded = run(338000, 310000, 50000, 30);
+
+	TEST_EQ(idle, 0, "%d");
+	TEST_EQ(loaded, 50 * 400, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_missing_sensors(void)
+{
+	int out;
+
+	fan_pi_reset(&state);
+	out = run(360000, 0, 0, 30);
+	TEST_EQ(out, FAN_PI_OUTPUT_MAX, "%d");
+	TEST_EQ(state.hottest, 0, "%d");
+
+	/* Nothing to go by: hold. */
+	TEST_EQ(run(0, 0, 0, 30), out, "%d");
+	TEST_EQ(state.hottest, -1, "%d");
+
+	/* A sensor coming back doesn't look like a jump in temperature. */
+	run(330000, 0, 0, 1);
+	TEST_EQ(state.slope[0], 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_cold);
+	RUN_TEST(test_slew);
+	RUN_TEST(test_prediction);
+	RUN_TEST(test_integral);
+	RUN_TEST(test_feed_forward);
+	RUN_TEST(test_missing_sensors);
+
+	test_print_result();
+}
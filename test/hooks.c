@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "hooks.h"
+#include "link_defs.h"
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
@@ -51,6 +52,28 @@ static void second_hook(void)
 }
 DECLARE_HOOK(HOOK_SECOND, second_hook, HOOK_PRIO_DEFAULT);
 
+/* Declared out of priority order; order_a and order_b share a priority. */
+static int order[5];
+static int order_count;
+/* 2 for whichever of order_a and order_b is first in the section, else 3 */
+static int order_id_a = 2;
+static int order_id_b = 3;
+
+#define ORDER_HOOK(name, id, prio)                          \
+	static void order_##name(void)                      \
+	{                                                   \
+		if (order_count < ARRAY_SIZE(order))        \
+			order[order_count] = id;            \
+		order_count++;                              \
+	}                                                   \
+	DECLARE_HOOK(HOOK_CHIPSET_RESUME, order_##name, prio)
+
+ORDER_HOOK(last, 4, HOOK_PRIO_LAST);
+ORDER_HOOK(a, order_id_a, HOOK_PRIO_DEFAULT);
+ORDER_HOOK(first, 0, HOOK_PRIO_FIRST);
+ORDER_HOOK(b, order_id_b, HOOK_PRIO_DEFAULT);
+ORDER_HOOK(i2c, 1, HOOK_PRIO_INIT_I2C + 1);
+
 static void deferred_func(void)
 {
 	deferred_call_count++;
@@ -102,6 +125,45 @@ static int test_priority(void)
 	return EC_SUCCESS;
 }
 
+static int section_index(void (*routine)(void))
+{
+	const struct hook_data *p;
+
+	for (p = __hooks_chipset_resume; p < __hooks_chipset_resume_end; p++) {
+		if (p->routine == routine)
+			return p - __hooks_chipset_resume;
+	}
+	return -1;
+}
+
+static int test_priority_order(void)
+{
+	int i;
+
+	/* The toolchain decides which of the two it emits first. */
+	TEST_GE(section_index(order_a), 0, "%d");
+	TEST_GE(section_index(order_b), 0, "%d");
+	if (section_index(order_b) < section_index(order_a)) {
+		order_id_a = 3;
+		order_id_b = 2;
+	}
+
+	for (i = 0; i < 2; i++) {
+		order_count = 0;
+		hook_notify(HOOK_CHIPSET_RESUME);
+
+		TEST_EQ(order_count, 5, "%d");
+		TEST_EQ(order[0], 0, "%d");
+		TEST_EQ(order[1], 1, "%d");
+		/* Same priority, in section order */
+		TEST_EQ(order[2], 2, "%d");
+		TEST_EQ(order[3], 3, "%d");
+		TEST_EQ(order[4], 4, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
 static int test_deferred(void)
 {
 	deferred_call_count = 0;
@@ -131,6 +193,46 @@ static int test_deferred(void)
 	return EC_SUCCESS;
 }
 
+static int deferred_order[4];
+static int deferred_order_count;
+
+#define ORDER_DEFERRED(id)                                           \
+	static void order_deferred_##id(void)                        \
+	{                                                            \
+		if (deferred_order_count < ARRAY_SIZE(deferred_order)) \
+			deferred_order[deferred_order_count] = id;   \
+		deferred_order_count++;                              \
+	}                                                            \
+	DECLARE_DEFERRED(order_deferred_##id)
+
+ORDER_DEFERRED(0);
+ORDER_DEFERRED(1);
+ORDER_DEFERRED(2);
+ORDER_DEFERRED(3);
+
+static int test_deferred_order(void)
+{
+	deferred_order_count = 0;
+	hook_call_deferred(&order_deferred_0_data, 40 * MSEC);
+	hook_call_deferred(&order_deferred_1_data, 10 * MSEC);
+	hook_call_deferred(&order_deferred_2_data, 30 * MSEC);
+	hook_call_deferred(&order_deferred_3_data, 20 * MSEC);
+
+	/* Move one ahead of all the others and cancel another */
+	hook_call_deferred(&order_deferred_2_data, 5 * MSEC);
+	hook_call_deferred(&order_deferred_3_data, -1);
+	/* Cancelling twice is harmless */
+	hook_call_deferred(&order_deferred_3_data, -1);
+
+	usleep(100 * MSEC);
+	TEST_EQ(deferred_order_count, 3, "%d");
+	TEST_EQ(deferred_order[0], 2, "%d");
+	TEST_EQ(deferred_order[1], 1, "%d");
+	TEST_EQ(deferred_order[2], 0, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int repeating_deferred_count;
 static void deferred_repeating_func(void);
 DECLARE_DEFERRED(deferred_repeating_func);
@@ -163,7 +265,9 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_init_hook);
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
+	RUN_TEST(test_priority_order);
 	RUN_TEST(test_deferred);
+	RUN_TEST(test_deferred_order);
 	RUN_TEST(test_repeating_deferred);
 
 	test_print_result();
@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "host_command.h"
+#include "link_defs.h"
 #include "printf.h"
 #include "task.h"
 #include "test_util.h"
@@ -306,6 +307,250 @@ static int test_hostcmd_clears_unused_data(void)
 	return EC_SUCCESS;
 }
 
+static int test_hostcmd_lookup_all(void)
+{
+	const struct host_command *cmd;
+	struct ec_params_get_cmd_versions_v1 p_v1;
+	struct ec_response_get_cmd_versions r_v;
+	struct host_cmd_handler_args args = {
+		.command = EC_CMD_GET_CMD_VERSIONS,
+		.version = 1,
+		.params = &p_v1,
+		.params_size = sizeof(p_v1),
+		.response = &r_v,
+		.response_max = sizeof(r_v),
+	};
+
+	/* Every registered command must be found with its version mask. */
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		p_v1.cmd = cmd->command;
+		TEST_ASSERT(host_command_process(&args) == EC_RES_SUCCESS);
+		TEST_ASSERT(r_v.version_mask == cmd->version_mask);
+	}
+
+	/* Unregistered commands must not be found. */
+	p_v1.cmd = 0xff;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+	p_v1.cmd = 0xfffe;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_HOSTCMD_LATENCY
+static int test_hostcmd_latency(void)
+{
+	struct ec_params_host_cmd_latency p_lat = { .cmd = EC_CMD_HELLO };
+	struct ec_response_host_cmd_latency r_lat;
+	struct host_cmd_handler_args args = {
+		.command =
+			EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_LATENCY),
+		.params = &p_lat,
+		.params_size = sizeof(p_lat),
+		.response = &r_lat,
+		.response_max = sizeof(r_lat),
+	};
+	uint32_t total = 0;
+	int i;
+
+	/* EC_CMD_HELLO was dispatched successfully by earlier tests. */
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	for (i = 0; i < EC_HOST_CMD_LATENCY_BUCKETS; i++)
+		total += r_lat.hist[i];
+	TEST_ASSERT(total > 0);
+
+	/* Commands never received are not tracked. */
+	p_lat.cmd = EC_CMD_REBOOT_EC;
+	TEST_EQ(host_command_process(&args), EC_RES_UNAVAILABLE, "%d");
+
+	/* Short params */
+	args.params_size = sizeof(p_lat) - 1;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_stats(void)
+{
+	struct ec_params_host_cmd_stats p_stats = { .max_entries = 4 };
+	uint8_t buf[sizeof(struct ec_response_host_cmd_stats) +
+		    4 * sizeof(struct ec_host_cmd_stats_entry)];
+	struct ec_response_host_cmd_stats *r_stats = (void *)buf;
+	struct host_cmd_handler_args args = {
+		.command = EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_STATS),
+		.params = &p_stats,
+		.params_size = sizeof(p_stats),
+		.response = buf,
+		.response_max = sizeof(buf),
+	};
+	int i;
+
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(r_stats->num_entries > 0);
+	TEST_ASSERT(r_stats->num_entries <= 4);
+	TEST_ASSERT(args.response_size ==
+		    sizeof(*r_stats) +
+			    r_stats->num_entries * sizeof(r_stats->entries[0]));
+
+	for (i = 0; i < r_stats->num_entries; i++) {
+		struct ec_host_cmd_stats_entry *e = &r_stats->entries[i];
+
+		TEST_ASSERT(e->count > 0);
+		TEST_ASSERT(e->min_us <= e->avg_us);
+		TEST_ASSERT(e->avg_us <= e->max_us);
+		/* Hottest first */
+		if (i > 0)
+			TEST_ASSERT(e->count <= r_stats->entries[i - 1].count);
+	}
+
+	/* The command table lookup test made GET_CMD_VERSIONS the hottest. */
+	TEST_EQ(r_stats->entries[0].cmd, EC_CMD_GET_CMD_VERSIONS, "0x%x");
+
+	/* Reset clears everything, after reporting. */
+	p_stats.flags = EC_HOST_CMD_STATS_RESET;
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(r_stats->num_entries > 0);
+	p_stats.flags = 0;
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	/* Only the previous EC_CMD_HOST_CMD_STATS itself was recorded. */
+	TEST_EQ(r_stats->num_entries, 1, "%d");
+	TEST_EQ(r_stats->entries[0].cmd,
+		EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_STATS), "0x%x");
+	TEST_EQ(r_stats->entries[0].count, 1, "%d");
+
+	/* Not even room for the header */
+	args.response_max = sizeof(*r_stats) - 1;
+	TEST_EQ(host_command_process(&args), EC_RES_RESPONSE_TOO_BIG, "%d");
+	args.response_max = sizeof(buf);
+
+	/* Short params */
+	args.params_size = sizeof(p_stats) - 1;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_HOSTCMD_LATENCY */
+
+#ifdef CONFIG_HOSTCMD_BATCH
+static uint8_t *batch_add(uint8_t *in, uint16_t command, uint8_t version,
+			  const void *params, uint8_t param_size,
+			  uint8_t response_max)
+{
+	struct ec_batch_cmd cmd = {
+		.command = command,
+		.version = version,
+		.param_size = param_size,
+		.response_max = response_max,
+	};
+
+	memcpy(in, &cmd, sizeof(cmd));
+	memcpy(in + sizeof(cmd), params, param_size);
+	return in + sizeof(cmd) + param_size;
+}
+
+static int test_hostcmd_batch(void)
+{
+	struct ec_params_hello hello = { .in_data = 0x10203040 };
+	struct ec_params_get_cmd_versions_v1 versions = {
+		.cmd = EC_CMD_HELLO,
+	};
+	struct ec_response_hello r_hello;
+	struct ec_response_get_cmd_versions r_versions;
+	uint8_t params[64] __aligned(4);
+	uint8_t response[64] __aligned(4);
+	struct ec_params_batch *p = (void *)params;
+	struct ec_response_batch *r = (void *)response;
+	struct ec_batch_result res;
+#ifdef CONFIG_HOSTCMD_LATENCY
+	struct ec_params_host_cmd_latency lat = { .cmd = 0x7fff };
+#endif
+	struct host_cmd_handler_args args = {
+		.command = EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH),
+		.params = params,
+		.response = response,
+		.response_max = sizeof(response),
+	};
+	uint8_t *in = p->cmds, *out = r->results;
+
+	/* Hello, an unknown command, then an odd-sized command */
+	p->num_cmds = 3;
+	in = batch_add(in, EC_CMD_HELLO, 0, &hello, sizeof(hello),
+		       sizeof(r_hello));
+	in = batch_add(in, 0x7fff, 0, NULL, 0, 0);
+	in = batch_add(in, EC_CMD_GET_CMD_VERSIONS, 1, &versions,
+		       sizeof(versions), sizeof(r_versions));
+	args.params_size = in - params;
+
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_results, 3, "%d");
+
+	memcpy(&res, out, sizeof(res));
+	TEST_EQ(res.command, EC_CMD_HELLO, "0x%x");
+	TEST_EQ(res.result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(res.size, (int)sizeof(r_hello), "%d");
+	memcpy(&r_hello, out + sizeof(res), sizeof(r_hello));
+	TEST_EQ(r_hello.out_data, 0x11223344, "0x%x");
+	out += sizeof(res) + res.size;
+
+	memcpy(&res, out, sizeof(res));
+	TEST_EQ(res.command, 0x7fff, "0x%x");
+	TEST_EQ(res.result, EC_RES_INVALID_COMMAND, "%d");
+	TEST_EQ(res.size, 0, "%d");
+	out += sizeof(res);
+
+	memcpy(&res, out, sizeof(res));
+	TEST_EQ(res.command, EC_CMD_GET_CMD_VERSIONS, "0x%x");
+	TEST_EQ(res.result, EC_RES_SUCCESS, "%d");
+	memcpy(&r_versions, out + sizeof(res), sizeof(r_versions));
+	TEST_EQ(r_versions.version_mask, EC_VER_MASK(0), "0x%x");
+	out += sizeof(res) + res.size;
+
+	TEST_EQ(args.response_size, (int)(out - response), "%d");
+
+	/* Sub-commands which don't fit in the response aren't run */
+	args.response_max = sizeof(*r) + 3 * sizeof(res) + sizeof(r_hello) +
+			    sizeof(r_versions) - 1;
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_results, 2, "%d");
+	args.response_max = sizeof(response);
+
+	/* Truncated sub-command params */
+	args.params_size--;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+
+	/* Too little response space for a sub-command */
+	p->num_cmds = 1;
+	in = batch_add(p->cmds, EC_CMD_HELLO, 0, &hello, sizeof(hello),
+		       sizeof(r_hello) - 1);
+	args.params_size = in - params;
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+	memcpy(&res, r->results, sizeof(res));
+	TEST_EQ(res.result, EC_RES_RESPONSE_TOO_BIG, "%d");
+	TEST_EQ(res.size, 0, "%d");
+
+	/* No nesting, and no commands which respond early */
+	in = batch_add(p->cmds, EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH), 0,
+		       NULL, 0, 0);
+	args.params_size = in - params;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+	in = batch_add(p->cmds, EC_CMD_FLASH_ERASE, 0, NULL, 0, 0);
+	args.params_size = in - params;
+	TEST_EQ(host_command_process(&args), EC_RES_INVALID_PARAM, "%d");
+
+#ifdef CONFIG_HOSTCMD_LATENCY
+	/* Only the batch is counted in the stats, not its sub-commands. */
+	args.command = EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_LATENCY);
+	args.params = &lat;
+	args.params_size = sizeof(lat);
+	TEST_EQ(host_command_process(&args), EC_RES_UNAVAILABLE, "%d");
+	lat.cmd = EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH);
+	TEST_EQ(host_command_process(&args), EC_RES_SUCCESS, "%d");
+#endif
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_HOSTCMD_BATCH */
+
 void run_test(int argc, const char **argv)
 {
 	wait_for_task_started();
@@ -321,6 +566,14 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_hostcmd_invalid_checksum);
 	RUN_TEST(test_hostcmd_reuse_response_buffer);
 	RUN_TEST(test_hostcmd_clears_unused_data);
+	RUN_TEST(test_hostcmd_lookup_all);
+#ifdef CONFIG_HOSTCMD_LATENCY
+	RUN_TEST(test_hostcmd_latency);
+	RUN_TEST(test_hostcmd_stats);
+#endif
+#ifdef CONFIG_HOSTCMD_BATCH
+	RUN_TEST(test_hostcmd_batch);
+#endif
 
 	test_print_result();
 }
@@ -0,0 +1,311 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for asynchronous I2C transfers.
+ */
+
+#include "common.h"
+#include "i2c.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define PORT 0
+#define ADDR 0x2a
+#define ADDR16 0x2b
+#define EVENT_DONE TASK_EVENT_CUSTOM_BIT(0)
+
+/* Auto-incrementing register file, with 8 and 16 bit offsets */
+static uint8_t regs[512];
+static int xfer_count;
+static int last_in_size;
+
+static int regs_xfer(const int port, const uint16_t addr_flags,
+		     const uint8_t *out, int out_size, uint8_t *in,
+		     int in_size, int flags)
+{
+	int offset;
+
+	if (port != PORT)
+		return EC_ERROR_INVAL;
+	if (I2C_STRIP_FLAGS(addr_flags) == ADDR && out_size == 1)
+		offset = out[0];
+	else if (I2C_STRIP_FLAGS(addr_flags) == ADDR16 && out_size == 2)
+		offset = (out[0] << 8) | out[1];
+	else
+		return EC_ERROR_INVAL;
+
+	if (offset + in_size > sizeof(regs))
+		return EC_ERROR_UNKNOWN;
+
+	memcpy(in, regs + offset, in_size);
+	xfer_count++;
+	last_in_size = in_size;
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(regs_xfer);
+
+static struct i2c_async_req *done_order[8];
+static int done_count;
+static int done_elsewhere;
+
+static void record_done(struct i2c_async_req *req)
+{
+	if (done_count < ARRAY_SIZE(done_order))
+		done_order[done_count] = req;
+	done_count++;
+	if (task_get_current() != TASK_ID_HOOKS)
+		done_elsewhere++;
+}
+
+/* Give the hook task time to complete count requests. */
+static int wait_done(int count)
+{
+	int i;
+
+	for (i = 0; i < 100 && done_count < count; i++)
+		msleep(1);
+
+	return done_count;
+}
+
+static uint8_t offsets[8];
+static uint8_t data[8][4];
+static struct i2c_async_req reqs[8];
+
+static void setup_read(int i, uint8_t offset, int len, uint8_t flags)
+{
+	offsets[i] = offset;
+	memset(data[i], 0, sizeof(data[i]));
+	reqs[i] = (struct i2c_async_req){
+		.port = PORT,
+		.addr_flags = ADDR,
+		.flags = flags,
+		.out = &offsets[i],
+		.out_size = 1,
+		.in = data[i],
+		.in_size = len,
+		.done = record_done,
+	};
+}
+
+static void reset(void)
+{
+	xfer_count = 0;
+	done_count = 0;
+	done_elsewhere = 0;
+}
+
+static int test_submit_event(void)
+{
+	uint32_t events;
+
+	reset();
+	setup_read(0, 0x10, 2, 0);
+	reqs[0].done = NULL;
+	reqs[0].event = EVENT_DONE;
+
+	TEST_EQ(i2c_async_submit(&reqs[0]), EC_SUCCESS, "%d");
+	TEST_ASSERT(reqs[0].pending);
+	TEST_EQ(i2c_async_submit(&reqs[0]), EC_ERROR_BUSY, "%d");
+
+	/* The hook task services the queue. */
+	events = task_wait_event_mask(EVENT_DONE, 100 * MSEC);
+	TEST_ASSERT(events & EVENT_DONE);
+	TEST_ASSERT(!reqs[0].pending);
+	TEST_EQ(reqs[0].rv, EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+	TEST_EQ(data[0][0], 0x10, "0x%x");
+	TEST_EQ(data[0][1], 0x11, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_coalesce(void)
+{
+	int i;
+
+	reset();
+	/* Holding the port queues everything until it is released. */
+	i2c_lock(PORT, 1);
+	for (i = 0; i < 4; i++) {
+		setup_read(i, 0x20 + 2 * i, 2, I2C_ASYNC_COALESCE);
+		TEST_EQ(i2c_async_submit(&reqs[i]), EC_SUCCESS, "%d");
+	}
+	TEST_EQ(done_count, 0, "%d");
+	i2c_lock(PORT, 0);
+
+	/* Releasing the port doesn't run the queue, the hook task does. */
+	TEST_EQ(xfer_count, 0, "%d");
+	TEST_EQ(wait_done(4), 4, "%d");
+	TEST_EQ(done_elsewhere, 0, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+	TEST_EQ(last_in_size, 8, "%d");
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT(done_order[i] == &reqs[i]);
+		TEST_ASSERT(reqs[i].rv == EC_SUCCESS);
+		TEST_ASSERT(data[i][0] == 0x20 + 2 * i);
+		TEST_ASSERT(data[i][1] == 0x21 + 2 * i);
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_coalesce_offset16(void)
+{
+	static const uint8_t off[2][2] = { { 0x01, 0x02 }, { 0x01, 0x05 } };
+	int i;
+
+	reset();
+	i2c_lock(PORT, 1);
+	for (i = 0; i < 2; i++) {
+		setup_read(i, 0, 3, I2C_ASYNC_COALESCE);
+		reqs[i].addr_flags = ADDR16;
+		reqs[i].out = off[i];
+		reqs[i].out_size = 2;
+		TEST_EQ(i2c_async_submit(&reqs[i]), EC_SUCCESS, "%d");
+	}
+	i2c_lock(PORT, 0);
+
+	TEST_EQ(wait_done(2), 2, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+	TEST_EQ(last_in_size, 6, "%d");
+	TEST_EQ(data[1][0], 0x05, "0x%x");
+	TEST_EQ(data[1][2], 0x07, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_no_coalesce(void)
+{
+	reset();
+	i2c_lock(PORT, 1);
+	/* Gap between registers */
+	setup_read(0, 0x30, 2, I2C_ASYNC_COALESCE);
+	setup_read(1, 0x33, 2, I2C_ASYNC_COALESCE);
+	/* Not marked as coalescable */
+	setup_read(2, 0x35, 2, 0);
+	/* Different device */
+	setup_read(3, 0x37, 2, I2C_ASYNC_COALESCE);
+	reqs[3].addr_flags = ADDR16;
+	reqs[3].out_size = 2;
+	reqs[3].out = (const uint8_t *)"\x00\x37";
+	/* Too long once merged */
+	setup_read(4, 0x39, 4, I2C_ASYNC_COALESCE);
+	reqs[4].in_size = CONFIG_I2C_ASYNC_COALESCE_MAX - 1;
+	reqs[4].in = regs + 0x100;
+	setup_read(5, 0x39 + CONFIG_I2C_ASYNC_COALESCE_MAX - 1, 2,
+		   I2C_ASYNC_COALESCE);
+	for (int i = 0; i < 6; i++)
+		TEST_EQ(i2c_async_submit(&reqs[i]), EC_SUCCESS, "%d");
+	i2c_lock(PORT, 0);
+
+	TEST_EQ(wait_done(6), 6, "%d");
+	TEST_EQ(xfer_count, 6, "%d");
+	TEST_EQ(data[3][0], 0x37, "0x%x");
+
+	/* Coalescing needs a register offset */
+	setup_read(0, 0, 2, I2C_ASYNC_COALESCE);
+	reqs[0].out_size = 0;
+	TEST_EQ(i2c_async_submit(&reqs[0]), EC_ERROR_INVAL, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_priority(void)
+{
+	reset();
+	i2c_lock(PORT, 1);
+	setup_read(0, 0x40, 1, 0);
+	setup_read(1, 0x41, 1, 0);
+	setup_read(2, 0x42, 1, I2C_ASYNC_PRIO_HIGH);
+	setup_read(3, 0x43, 1, I2C_ASYNC_PRIO_HIGH);
+	for (int i = 0; i < 4; i++)
+		TEST_EQ(i2c_async_submit(&reqs[i]), EC_SUCCESS, "%d");
+	i2c_lock(PORT, 0);
+
+	TEST_EQ(wait_done(4), 4, "%d");
+	TEST_ASSERT(done_order[0] == &reqs[2]);
+	TEST_ASSERT(done_order[1] == &reqs[3]);
+	TEST_ASSERT(done_order[2] == &reqs[0]);
+	TEST_ASSERT(done_order[3] == &reqs[1]);
+
+	return EC_SUCCESS;
+}
+
+static int test_sync_drains_queue(void)
+{
+	uint8_t offset = 0x50, val;
+
+	reset();
+
+	/* A synchronous transfer runs whatever got queued ahead of it... */
+	setup_read(0, 0x60, 1, 0);
+	setup_read(1, 0x61, 1, 0);
+	TEST_EQ(i2c_async_submit(&reqs[0]), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_async_submit(&reqs[1]), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer(PORT, ADDR, &offset, 1, &val, 1), EC_SUCCESS, "%d");
+	TEST_EQ(val, 0x50, "0x%x");
+	TEST_EQ(xfer_count, 3, "%d");
+	TEST_EQ(data[0][0], 0x60, "0x%x");
+	TEST_EQ(data[1][0], 0x61, "0x%x");
+
+	/* ...but leaves their completion to the hook task. */
+	TEST_EQ(done_count, 0, "%d");
+	TEST_EQ(wait_done(2), 2, "%d");
+	TEST_EQ(done_elsewhere, 0, "%d");
+	TEST_ASSERT(done_order[0] == &reqs[0]);
+	TEST_ASSERT(done_order[1] == &reqs[1]);
+
+	/* Errors are still reported */
+	TEST_NE(i2c_xfer(PORT, 0x7f, &offset, 1, &val, 1), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer(I2C_PORT_COUNT, ADDR, &offset, 1, &val, 1),
+		EC_ERROR_INVAL, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_error(void)
+{
+	reset();
+	i2c_lock(PORT, 1);
+	setup_read(0, 0xfe, 2, I2C_ASYNC_COALESCE);
+	setup_read(1, 0x00, 2, I2C_ASYNC_COALESCE);
+	setup_read(2, 0x02, 2, I2C_ASYNC_COALESCE);
+	/* The merged read of 0x00..0x03 fails for both requests. */
+	reqs[1].addr_flags = reqs[2].addr_flags = 0x7f;
+	for (int i = 0; i < 3; i++)
+		TEST_EQ(i2c_async_submit(&reqs[i]), EC_SUCCESS, "%d");
+	i2c_lock(PORT, 0);
+
+	TEST_EQ(wait_done(3), 3, "%d");
+	TEST_EQ(reqs[0].rv, EC_SUCCESS, "%d");
+	TEST_NE(reqs[1].rv, EC_SUCCESS, "%d");
+	TEST_NE(reqs[2].rv, EC_SUCCESS, "%d");
+	TEST_EQ(data[1][0], 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	int i;
+
+	for (i = 0; i < sizeof(regs); i++)
+		regs[i] = i;
+
+	test_reset();
+
+	RUN_TEST(test_submit_event);
+	RUN_TEST(test_coalesce);
+	RUN_TEST(test_coalesce_offset16);
+	RUN_TEST(test_no_coalesce);
+	RUN_TEST(test_priority);
+	RUN_TEST(test_sync_drains_queue);
+	RUN_TEST(test_error);
+
+	test_print_result();
+}
@@ -0,0 +1,197 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for I2C traffic statistics.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "i2c.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define PORT 0
+#define ADDR_OK 0x2a
+#define ADDR_SLOW 0x2b
+#define ADDR_NAK 0x2c
+
+/* Number of NAKs ADDR_NAK still answers with */
+static int naks_left;
+
+static int stats_xfer(const int port, const uint16_t addr_flags,
+		      const uint8_t *out, int out_size, uint8_t *in,
+		      int in_size, int flags)
+{
+	if (port != PORT)
+		return EC_ERROR_INVAL;
+
+	switch (I2C_STRIP_FLAGS(addr_flags)) {
+	case ADDR_OK:
+		return EC_SUCCESS;
+	case ADDR_SLOW:
+		udelay(2 * MSEC);
+		return EC_SUCCESS;
+	case ADDR_NAK:
+		if (naks_left > 0) {
+			naks_left--;
+			return EC_ERROR_BUSY;
+		}
+		return EC_SUCCESS;
+	}
+
+	return EC_ERROR_INVAL;
+}
+DECLARE_TEST_I2C_XFER(stats_xfer);
+
+static uint8_t response[256] __aligned(4);
+
+static int get_stats(int flags, int start, struct ec_response_i2c_stats **r)
+{
+	struct ec_params_i2c_stats p = { .flags = flags, .start = start };
+	struct host_cmd_handler_args args = {
+		.command = EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_I2C_STATS),
+		.params = &p,
+		.params_size = sizeof(p),
+		.response = response,
+		.response_max = sizeof(response),
+	};
+
+	*r = (void *)response;
+	return host_command_process(&args);
+}
+
+static const struct ec_i2c_stats_entry *
+find_entry(const struct ec_response_i2c_stats *r, int addr)
+{
+	int i;
+
+	for (i = 0; i < r->num_entries; i++) {
+		if (r->entries[i].port == PORT && r->entries[i].addr == addr)
+			return &r->entries[i];
+	}
+	return NULL;
+}
+
+static int test_counts(void)
+{
+	struct ec_response_i2c_stats *r;
+	const struct ec_i2c_stats_entry *e;
+	uint8_t buf[4] = { 0 };
+	int i;
+
+	for (i = 0; i < 3; i++)
+		TEST_EQ(i2c_xfer(PORT, ADDR_OK, buf, 1, buf, 2), EC_SUCCESS,
+			"%d");
+	TEST_EQ(i2c_xfer(PORT, ADDR_OK, buf, 4, NULL, 0), EC_SUCCESS, "%d");
+
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	/* Rounded up to a power of two of us per bucket */
+	TEST_GE(r->window_ms, CONFIG_I2C_STATS_WINDOW_MS, "%d");
+	TEST_LT(r->window_ms, 2 * CONFIG_I2C_STATS_WINDOW_MS, "%d");
+	TEST_EQ(r->total_entries, 1, "%d");
+	e = find_entry(r, ADDR_OK);
+	TEST_ASSERT(e);
+	TEST_EQ(e->count, 4, "%d");
+	TEST_EQ(e->bytes, 3 * 3 + 4, "%d");
+	TEST_EQ(e->retries, 0, "%d");
+	TEST_EQ(e->naks, 0, "%d");
+	TEST_EQ(e->errors, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_naks(void)
+{
+	struct ec_response_i2c_stats *r;
+	const struct ec_i2c_stats_entry *e;
+	uint8_t buf = 0;
+
+	/* Succeeds on the last retry */
+	naks_left = 2;
+	TEST_EQ(i2c_xfer(PORT, ADDR_NAK, &buf, 1, NULL, 0), EC_SUCCESS, "%d");
+	/* Gives up after CONFIG_I2C_NACK_RETRY_COUNT retries */
+	naks_left = 5;
+	TEST_EQ(i2c_xfer(PORT, ADDR_NAK, &buf, 1, NULL, 0), EC_ERROR_BUSY,
+		"%d");
+
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	e = find_entry(r, ADDR_NAK);
+	TEST_ASSERT(e);
+	TEST_EQ(e->count, 2, "%d");
+	TEST_EQ(e->retries, 4, "%d");
+	TEST_EQ(e->naks, 5, "%d");
+	TEST_EQ(e->errors, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_utilization(void)
+{
+	struct ec_response_i2c_stats *r;
+	const struct ec_i2c_stats_entry *e;
+	uint8_t buf = 0;
+	int i;
+
+	for (i = 0; i < 5; i++)
+		i2c_xfer(PORT, ADDR_SLOW, &buf, 1, NULL, 0);
+
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	e = find_entry(r, ADDR_SLOW);
+	TEST_ASSERT(e);
+	TEST_GE(e->busy_us, 5 * 2 * MSEC, "%d");
+	TEST_GE(e->max_us, 2 * MSEC, "%d");
+
+	/* At least 10 ms busy in a window of about 1 s */
+	TEST_EQ(r->num_ports, 1, "%d");
+	TEST_EQ(r->ports[0].port, PORT, "%d");
+	TEST_GE(r->ports[0].utilization, 10, "%d");
+
+	/* Busy time falls out of the window */
+	msleep(r->window_ms + 200);
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->ports[0].utilization, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_paging_and_reset(void)
+{
+	struct ec_response_i2c_stats *r;
+	uint8_t buf = 0;
+	int i;
+
+	/* Fill the table; the fifth peripheral isn't tracked. */
+	for (i = 0; i < CONFIG_I2C_STATS_ENTRIES + 1; i++)
+		i2c_xfer(PORT, 0x40 + i, &buf, 1, NULL, 0);
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->total_entries, CONFIG_I2C_STATS_ENTRIES, "%d");
+
+	TEST_EQ(get_stats(0, 2, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_entries, CONFIG_I2C_STATS_ENTRIES - 2, "%d");
+
+	TEST_EQ(get_stats(EC_I2C_STATS_RESET, CONFIG_I2C_STATS_ENTRIES, &r),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_entries, 0, "%d");
+
+	TEST_EQ(get_stats(0, 0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->total_entries, 0, "%d");
+	TEST_EQ(r->num_ports, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_counts);
+	RUN_TEST(test_naks);
+	RUN_TEST(test_utilization);
+	RUN_TEST(test_paging_and_reset);
+
+	test_print_result();
+}
@@ -575,6 +575,77 @@ test_static int test_single_key_press(void)
 	return EC_SUCCESS;
 }
 
+static int get_keyboard_latency(uint8_t flags,
+				struct ec_response_keyboard_latency *r)
+{
+	struct ec_params_keyboard_latency p = { .flags = flags };
+
+	return test_send_host_command(
+		EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_KEYBOARD_LATENCY), 0, &p,
+		sizeof(p), r, sizeof(*r));
+}
+
+test_static int test_keyboard_latency(void)
+{
+	struct ec_response_keyboard_latency r;
+	const struct ec_keyboard_latency_stage *host;
+
+	host = &r.stages[EC_KEYBOARD_LATENCY_HOST];
+	TEST_EQ(get_keyboard_latency(EC_KEYBOARD_LATENCY_RESET, &r),
+		EC_RES_SUCCESS, "%d");
+
+	ENABLE_KEYSTROKE(1);
+	press_key(1, 1, 1);
+	/* Leave the byte for a while before the host reads it */
+	VERIFY_LPC_CHAR_DELAY("\x01", 20);
+	press_key(1, 1, 0);
+	VERIFY_LPC_CHAR("\x81");
+	/* Two byte scan code, done once the host read both bytes */
+	press_key(12, 6, 1);
+	VERIFY_LPC_CHAR("\xe0\x4d");
+	press_key(12, 6, 0);
+	VERIFY_LPC_CHAR("\xe0\xcd");
+	msleep(10);
+
+	TEST_EQ(get_keyboard_latency(0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.total, 4, "%d");
+	TEST_EQ(r.samples, 4, "%d");
+	TEST_EQ(r.dropped, 0, "%d");
+	TEST_GE(host->max_us, 20 * MSEC, "%d");
+	TEST_LT(host->p50_us, 20 * MSEC, "%d");
+	TEST_LE(host->p50_us, host->p99_us, "%d");
+	TEST_LE(host->p99_us, host->max_us, "%d");
+	TEST_GE(r.stages[EC_KEYBOARD_LATENCY_TOTAL].max_us, host->max_us,
+		"%d");
+
+	/* Keystrokes disabled: nothing is sent, nothing measured */
+	ENABLE_KEYSTROKE(0);
+	press_key(1, 1, 1);
+	VERIFY_NO_CHAR();
+	press_key(1, 1, 0);
+	VERIFY_NO_CHAR();
+	TEST_EQ(get_keyboard_latency(EC_KEYBOARD_LATENCY_RESET, &r),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.total, 4, "%d");
+	TEST_EQ(get_keyboard_latency(0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.total, 0, "%d");
+	TEST_EQ(r.samples, 0, "%d");
+
+	/* Replies to the host's keyboard commands aren't key presses */
+	ENABLE_KEYSTROKE(1);
+	RESET_8042_DEF();
+	msleep(10);
+	TEST_EQ(get_keyboard_latency(0, &r), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.total, 0, "%d");
+
+	TEST_EQ(test_send_host_command(
+			EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_KEYBOARD_LATENCY),
+			0, NULL, 0, &r, sizeof(r)),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
 test_static int test_disable_keystroke(void)
 {
 	ENABLE_KEYSTROKE(0);
@@ -1030,6 +1101,7 @@ void run_test(int argc, const char **argv)
 		RUN_TEST(test_atkbd_reset);
 		RUN_TEST(test_single_key_press);
 		RUN_TEST(test_disable_keystroke);
+		RUN_TEST(test_keyboard_latency);
 		RUN_TEST(test_typematic);
 		RUN_TEST(test_scancode_set2);
 		RUN_TEST(test_power_button);
@@ -65,9 +65,14 @@ int lid_is_open(void)
 }
 #endif
 
+/* Number of times a single column was driven */
+static int column_drives;
+
 void keyboard_raw_drive_column(int out)
 {
 	column_driven = out;
+	if (out >= 0)
+		column_drives++;
 }
 
 int keyboard_raw_read_rows(void)
@@ -240,6 +245,30 @@ static int deghost_test(void)
 	return EC_SUCCESS;
 }
 
+static int idle_skip_test(void)
+{
+	reset_key_state();
+
+	/* Keep polling after a key release without driving single columns */
+	mock_key(1, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(1, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	column_drives = 0;
+	msleep(20);
+	TEST_EQ(column_drives, 0, "%d");
+
+	/* A key press still gets the full scan */
+	mock_key(2, 3, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	TEST_ASSERT(column_drives > 0);
+	TEST_EQ(key_state[3], BIT(2), "0x%x");
+	mock_key(2, 3, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	return EC_SUCCESS;
+}
+
 static int strict_debounce_test(void)
 {
 	reset_key_state();
@@ -587,6 +616,9 @@ static void run_test_step1(void)
 	else
 		RUN_TEST(debounce_test);
 
+	if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_IDLE_SKIP))
+		RUN_TEST(idle_skip_test);
+
 	if (0) /* crbug.com/976974 */
 		RUN_TEST(simulate_key_test);
 #ifdef EMU_BUILD
@@ -177,7 +177,7 @@ static int test_stage_data_remove_all_oversampling(void)
 	 * Check that count is 0 and total_lost is 0, oversampling should be
 	 * removing the data before it touches the FIFO.
 	 */
-	motion_sense_fifo_get_info(fifo_info, /*reset=*/false);
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/false);
 	TEST_EQ(fifo_info->count, 0, "%d");
 	TEST_EQ(fifo_info->total_lost, 0, "%d");
 
@@ -215,7 +215,7 @@ static int test_stage_data_evicts_data_with_timestamp(void)
 	 * Check that count is 1 smaller than the total size and total_lost is 2
 	 * because 2 entries were evicted together.
 	 */
-	motion_sense_fifo_get_info(fifo_info, /*reset=*/false);
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/false);
 	TEST_EQ(fifo_info->count, CONFIG_ACCEL_FIFO_SIZE - 1, "%d");
 	TEST_EQ(fifo_info->total_lost, 2, "%d");
 
@@ -412,8 +412,16 @@ static int test_get_info_size(void)
 	struct ec_response_motion_sense_fifo_info *fifo_info =
 		(void *)fifo_info_buffer;
 
-	motion_sense_fifo_get_info(fifo_info, /*reset=*/false);
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/false);
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	/* As many 2 byte timestamps as fit */
+	TEST_EQ(fifo_info->size,
+		CONFIG_ACCEL_FIFO_SIZE *
+			(int)sizeof(struct ec_response_motion_sensor_data) / 2,
+		"%d");
+#else
 	TEST_EQ(fifo_info->size, CONFIG_ACCEL_FIFO_SIZE, "%d");
+#endif
 
 	return EC_SUCCESS;
 }
@@ -491,6 +499,285 @@ static int test_check_ap_interval_set_multiple_sample(void)
 	return EC_SUCCESS;
 }
 
+static int test_get_stats(void)
+{
+	uint8_t fifo_info_buffer
+		[sizeof(struct ec_response_motion_sense_fifo_info) +
+		 sizeof(uint16_t) * MAX_MOTION_SENSORS];
+	struct ec_response_motion_sense_fifo_info *fifo_info =
+		(void *)fifo_info_buffer;
+	struct ec_response_motion_sense_fifo_stats stats;
+	int i;
+
+	/* Stage 5 timestamp + data pairs more than fit */
+	motion_sensors[0].oversampling_ratio = 1;
+	for (i = 0; i < CONFIG_ACCEL_FIFO_SIZE / 2 + 5; i++)
+		motion_sense_fifo_stage_data(data, motion_sensors, 3, i);
+	motion_sense_fifo_commit_data();
+
+	motion_sense_fifo_get_info(fifo_info, &stats, /*reset=*/true);
+	TEST_EQ(fifo_info->total_lost, 10, "%d");
+	TEST_EQ(stats.total_staged, CONFIG_ACCEL_FIFO_SIZE + 10, "%d");
+	TEST_EQ(stats.total_dropped, 10, "%d");
+
+	/* Resetting the lost counters doesn't reset them */
+	motion_sense_fifo_get_info(fifo_info, &stats, /*reset=*/false);
+	TEST_EQ(fifo_info->total_lost, 0, "%d");
+	TEST_EQ(stats.total_staged, CONFIG_ACCEL_FIFO_SIZE + 10, "%d");
+	TEST_EQ(stats.total_dropped, 10, "%d");
+
+	/* Resetting the fifo does */
+	motion_sense_fifo_reset();
+	motion_sense_fifo_get_info(fifo_info, &stats, /*reset=*/false);
+	TEST_EQ(stats.total_staged, 0, "%d");
+	TEST_EQ(stats.total_dropped, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+static const uint8_t *get_varint(const uint8_t *p, uint32_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	do {
+		*v |= (uint32_t)(*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+	return p;
+}
+
+/* Reference decoder for the packed encoding described in ec_commands.h. */
+static int unpack_fifo(const uint8_t *p, int size,
+		       struct ec_response_motion_sensor_data *out)
+{
+	const uint8_t sensor_mask = EC_MOTION_SENSE_PACKED_SENSOR_MASK;
+	const uint8_t *end = p + size;
+	int16_t prev[EC_MOTION_SENSE_PACKED_MAX_SENSORS][3] = {};
+	uint32_t prev_ts = 0, v;
+	int count = 0, i;
+
+	while (p < end) {
+		struct ec_response_motion_sensor_data *e = &out[count++];
+
+		memset(e, 0, sizeof(*e));
+		if (!(*p & EC_MOTION_SENSE_PACKED)) {
+			memcpy(e, p, sizeof(*e));
+			p += sizeof(*e);
+		} else if (*p & EC_MOTION_SENSE_PACKED_TIMESTAMP) {
+			e->flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
+			e->sensor_num = *p++ & sensor_mask;
+			p = get_varint(p, &v);
+			e->timestamp = prev_ts + v;
+		} else {
+			e->sensor_num = *p++ & sensor_mask;
+			e->flags = *p++;
+			for (i = 0; i < 3; i++) {
+				p = get_varint(p, &v);
+				e->data[i] = prev[e->sensor_num][i] +
+					     (int16_t)((v >> 1) ^ -(v & 1));
+			}
+		}
+
+		if (e->flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP)
+			prev_ts = e->timestamp;
+		else if (!(e->flags & MOTIONSENSE_SENSOR_FLAG_ODR) &&
+			 e->sensor_num < EC_MOTION_SENSE_PACKED_MAX_SENSORS)
+			memcpy(prev[e->sensor_num], e->data, sizeof(e->data));
+	}
+	return count;
+}
+
+/* Stage a fixed mix of data, timestamps and async events. */
+static void stage_packed_pattern(uint32_t now)
+{
+	struct ec_response_motion_sensor_data v = {};
+	int i;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[1].oversampling_ratio = 1;
+	for (i = 0; i < 20; i++) {
+		v.sensor_num = i & 1;
+		v.data[X] = 100 + i;
+		v.data[Y] = -200 - 3 * i;
+		/* Large jumps have to fall back to raw entries */
+		v.data[Z] = (i == 10) ? INT16_MAX : 1000 - (i & 3);
+		motion_sense_fifo_stage_data(&v, &motion_sensors[i & 1], 3,
+					     now + i * 1000);
+		motion_sense_fifo_commit_data();
+	}
+	motion_sense_fifo_insert_async_event(motion_sensors, ASYNC_EVENT_FLUSH);
+}
+
+/* Check the entries read back from stage_packed_pattern(now). */
+static int check_packed_pattern(uint32_t now,
+				const struct ec_response_motion_sensor_data *e,
+				int count)
+{
+	int i;
+
+	TEST_EQ(count, 41, "%d");
+	for (i = 0; i < 20; i++, e += 2) {
+		TEST_EQ(e[0].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP, "%d");
+		TEST_EQ(e[0].sensor_num, i & 1, "%d");
+		TEST_EQ(e[0].timestamp, now + i * 1000, "%u");
+		TEST_EQ(e[1].flags, 0, "%d");
+		TEST_EQ(e[1].sensor_num, i & 1, "%d");
+		TEST_EQ(e[1].data[X], 100 + i, "%d");
+		TEST_EQ(e[1].data[Y], -200 - 3 * i, "%d");
+		TEST_EQ(e[1].data[Z], (i == 10) ? INT16_MAX : 1000 - (i & 3),
+			"%d");
+	}
+	TEST_BITS_SET(e[0].flags, ASYNC_EVENT_FLUSH);
+
+	return EC_SUCCESS;
+}
+
+static int test_packed_round_trip(void)
+{
+	uint32_t now = __hw_clock_source_read();
+	int read_count;
+
+	stage_packed_pattern(now);
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+
+	return check_packed_pattern(now, data, read_count);
+}
+
+static int test_read_packed(void)
+{
+	static uint8_t packed[sizeof(data)];
+	uint32_t now = __hw_clock_source_read();
+	uint16_t packed_bytes;
+	int read_count, plain_bytes;
+
+	stage_packed_pattern(now);
+	read_count = motion_sense_fifo_read_packed(
+		sizeof(packed), CONFIG_ACCEL_FIFO_SIZE, packed, &packed_bytes);
+
+	TEST_EQ(unpack_fifo(packed, packed_bytes, data), read_count, "%d");
+	TEST_ASSERT(check_packed_pattern(now, data, read_count) == EC_SUCCESS);
+
+	/* Even with the raw fallbacks this is well under the plain size */
+	plain_bytes = read_count * sizeof(*data);
+	TEST_LE(packed_bytes * 3, plain_bytes * 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_read_packed_capacity(void)
+{
+	uint8_t packed[16];
+	uint16_t packed_bytes;
+	int read_count;
+
+	stage_packed_pattern(__hw_clock_source_read());
+
+	/* Only whole entries are returned */
+	read_count = motion_sense_fifo_read_packed(
+		sizeof(packed), CONFIG_ACCEL_FIFO_SIZE, packed, &packed_bytes);
+	TEST_GT(read_count, 0, "%d");
+	TEST_LE(packed_bytes, (uint16_t)sizeof(packed), "%d");
+	TEST_EQ(unpack_fifo(packed, packed_bytes, data), read_count, "%d");
+
+	/* The rest is still there; max_count is honoured */
+	read_count = motion_sense_fifo_read_packed(sizeof(packed), 1, packed,
+						   &packed_bytes);
+	TEST_EQ(read_count, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Commit samples one at a time, like the motion sense task does, with small
+ * changes between them.
+ */
+static void commit_samples(int first, int count)
+{
+	struct ec_response_motion_sensor_data v = {};
+	int i;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	for (i = first; i < first + count; i++) {
+		v.data[X] = i & 7;
+		v.data[Y] = -(i & 3);
+		v.data[Z] = 1000;
+		motion_sense_fifo_stage_data(&v, motion_sensors, 3, i * 5000);
+		motion_sense_fifo_commit_data();
+	}
+}
+
+static int test_packed_depth(void)
+{
+	static struct ec_response_motion_sensor_data
+		out[2 * CONFIG_ACCEL_FIFO_SIZE];
+	uint8_t fifo_info_buffer
+		[sizeof(struct ec_response_motion_sense_fifo_info) +
+		 sizeof(uint16_t) * MAX_MOTION_SENSORS];
+	struct ec_response_motion_sense_fifo_info *fifo_info =
+		(void *)fifo_info_buffer;
+	/*
+	 * Twice as many samples as fit unpacked, less the room kept free for
+	 * staging a sample unpacked.
+	 */
+	const int samples = CONFIG_ACCEL_FIFO_SIZE - 4;
+	int i, read_count;
+
+	commit_samples(1, samples);
+
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/false);
+	TEST_EQ(fifo_info->total_lost, 0, "%d");
+	TEST_EQ(fifo_info->count, 2 * samples, "%d");
+
+	read_count = motion_sense_fifo_read(sizeof(out), ARRAY_SIZE(out), out,
+					    &data_bytes_read);
+	TEST_EQ(read_count, 2 * samples, "%d");
+	for (i = 0; i < samples; i++) {
+		TEST_EQ(out[2 * i].timestamp, (i + 1) * 5000, "%u");
+		TEST_EQ(out[2 * i + 1].data[X], (i + 1) & 7, "%d");
+		TEST_EQ(out[2 * i + 1].data[Y], -((i + 1) & 3), "%d");
+		TEST_EQ(out[2 * i + 1].data[Z], 1000, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_packed_evicts_committed(void)
+{
+	uint8_t fifo_info_buffer
+		[sizeof(struct ec_response_motion_sense_fifo_info) +
+		 sizeof(uint16_t) * MAX_MOTION_SENSORS];
+	struct ec_response_motion_sense_fifo_info *fifo_info =
+		(void *)fifo_info_buffer;
+	int i, first, read_count;
+
+	/* Overflow with packed entries */
+	commit_samples(1, 2 * CONFIG_ACCEL_FIFO_SIZE);
+
+	motion_sense_fifo_get_info(fifo_info, NULL, /*reset=*/false);
+	TEST_GT(fifo_info->total_lost, 0, "%d");
+	TEST_EQ(fifo_info->total_lost % 2, 0, "%d");
+	TEST_EQ(fifo_info->count + fifo_info->total_lost,
+		4 * CONFIG_ACCEL_FIFO_SIZE, "%d");
+
+	/* Evicted in pairs, and what is left still unpacks correctly */
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	first = fifo_info->total_lost / 2 + 1;
+	for (i = 0; i < read_count / 2; i++) {
+		TEST_EQ(data[2 * i].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP,
+			"%d");
+		TEST_EQ(data[2 * i].timestamp, (first + i) * 5000, "%u");
+		TEST_EQ(data[2 * i + 1].data[X], (first + i) & 7, "%d");
+		TEST_EQ(data[2 * i + 1].data[Y], -((first + i) & 3), "%d");
+	}
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_ACCEL_FIFO_PACKED */
+
 void before_test(void)
 {
 	motion_sense_fifo_commit_data();
@@ -523,6 +810,14 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_get_info_size);
 	RUN_TEST(test_check_ap_interval_set_one_sample);
 	RUN_TEST(test_check_ap_interval_set_multiple_sample);
+	RUN_TEST(test_get_stats);
+#ifdef CONFIG_ACCEL_FIFO_PACKED
+	RUN_TEST(test_packed_round_trip);
+	RUN_TEST(test_read_packed);
+	RUN_TEST(test_read_packed_capacity);
+	RUN_TEST(test_packed_depth);
+	RUN_TEST(test_packed_evicts_committed);
+#endif
 
 	test_print_result();
 }
@@ -677,6 +677,52 @@ test_static int test_uint64_to_str(void)
 	return EC_SUCCESS;
 }
 
+/* Check decimal conversion against the compiler's 64-bit division */
+static int check_decimal(uint64_t val)
+{
+	char buf[21], expect[21];
+	char *str, *e = expect + sizeof(expect) - 1;
+	uint64_t v = val;
+
+	*e = '\0';
+	do {
+		*(--e) = '0' + v % 10;
+		v /= 10;
+	} while (v);
+
+	str = uint64_to_str(buf, sizeof(buf), val, /*precision=*/-1,
+			    /*base=*/10, /*uppercase=*/false);
+	TEST_ASSERT(str != NULL);
+	TEST_ASSERT(!strcmp(str, e));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_uint64_to_str_decimal(void)
+{
+	uint64_t val = 1;
+	int i, d;
+
+	/* Powers of 2 and 10, and their neighbors */
+	for (i = 0; i < 64; i++) {
+		for (d = -1; d <= 1; d++)
+			TEST_ASSERT(check_decimal((1ULL << i) + d) ==
+				    EC_SUCCESS);
+	}
+	for (i = 0; i < 20; i++, val *= 10) {
+		for (d = -1; d <= 1; d++)
+			TEST_ASSERT(check_decimal(val + d) == EC_SUCCESS);
+	}
+
+	/* Pseudo-random values */
+	for (i = 0; i < 1000; i++) {
+		val = val * 6364136223846793005ULL + 1442695040888963407ULL;
+		TEST_ASSERT(check_decimal(val) == EC_SUCCESS);
+	}
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
@@ -690,6 +736,7 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_vsnprintf_strings);
 	RUN_TEST(test_vsnprintf_combined);
 	RUN_TEST(test_uint64_to_str);
+	RUN_TEST(test_uint64_to_str_decimal);
 	RUN_TEST(test_snprintf_timestamp);
 	RUN_TEST(test_snprintf_hex_buffer);
 
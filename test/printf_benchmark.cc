@@ -0,0 +1,136 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Measure the cost of formatting typical CPRINTS() lines, through an
+ * addchar() callback per character (the UART path) and straight into a
+ * buffer (snprintf(), used by the Zephyr console).
+ */
+
+#include "benchmark.h"
+
+#include <cstdarg>
+#include <cstdint>
+
+extern "C" {
+#include "printf.h"
+#include "test_util.h"
+}
+
+constexpr int kIterations = 10;
+/* Lines formatted per benchmark iteration */
+constexpr int kLines = 100;
+
+static char line[128];
+
+struct line_context {
+	char *str;
+	int size;
+};
+
+static int line_addchar(void *context, int c)
+{
+	auto *ctx = static_cast<struct line_context *>(context);
+
+	if (!ctx->size)
+		return 1;
+	*ctx->str++ = c;
+	ctx->size--;
+	return 0;
+}
+
+static void format_per_char(const char *format, ...)
+{
+	struct line_context ctx = { line, sizeof(line) - 1 };
+	va_list args;
+
+	va_start(args, format);
+	vfnprintf(line_addchar, &ctx, format, args);
+	va_end(args);
+	*ctx.str = '\0';
+}
+
+static void format_buf(const char *format, ...)
+{
+	char *end = line;
+	size_t size = sizeof(line) - 1;
+	va_list args;
+
+	va_start(args, format);
+	vfnprintf_buf(&end, &size, format, args);
+	va_end(args);
+	*end = '\0';
+}
+
+/* A PD state transition, as printed by CPRINTS() with its timestamp */
+#define PD_LINE_FORMAT "[%s C%d: %s -> %s, vbus %dmV, cc 0x%08x]\n"
+
+static void pd_line(void (*format)(const char *, ...))
+{
+	char ts[PRINTF_TIMESTAMP_BUF_SIZE];
+	uint64_t t = 1234567890123ULL;
+
+	for (int i = 0; i < kLines; i++) {
+		snprintf_timestamp(ts, sizeof(ts), t + i * 997);
+		format(PD_LINE_FORMAT, ts, i & 1, "SNK_READY", "SNK_TRANSITION",
+		       20000 + i, 0x1234abcd + i);
+	}
+}
+
+static void print_cycles_per_line(const BenchmarkResult &result)
+{
+	uint64_t cycles = static_cast<uint64_t>(result.elapsed_time) *
+			  (clock_get_freq() / 1000000);
+
+	ccprintf("%s: %u cycles per line\n", result.name.data(),
+		 static_cast<uint32_t>(cycles / (kIterations * kLines)));
+	cflush();
+}
+
+test_static int test_printf_benchmark()
+{
+	Benchmark benchmark({ .num_iterations = kIterations });
+	uint64_t t = 1234567890123ULL;
+
+	auto per_char = benchmark.run(
+		"vfnprintf_per_char", []() { pd_line(format_per_char); });
+	TEST_ASSERT(per_char.has_value());
+	auto buf = benchmark.run("vfnprintf_buf",
+				 []() { pd_line(format_buf); });
+	TEST_ASSERT(buf.has_value());
+
+	/* Both paths print the same line */
+	format_per_char("%lld %-6s|%5d|%x", t, "ab", -42, 0xbeef);
+	TEST_ASSERT(!strcmp(line, "1234567890123 ab    |  -42|beef"));
+	format_buf("%lld %-6s|%5d|%x", t, "ab", -42, 0xbeef);
+	TEST_ASSERT(!strcmp(line, "1234567890123 ab    |  -42|beef"));
+
+	auto u64 = benchmark.run("u64_decimal", [t]() {
+		for (int i = 0; i < kLines; i++)
+			format_buf("%lld", t * i);
+	});
+	TEST_ASSERT(u64.has_value());
+	auto timestamp = benchmark.run("timestamp", [t]() {
+		char ts[PRINTF_TIMESTAMP_BUF_SIZE];
+
+		for (int i = 0; i < kLines; i++)
+			snprintf_timestamp(ts, sizeof(ts), t * i);
+	});
+	TEST_ASSERT(timestamp.has_value());
+
+	benchmark.print_results();
+	BenchmarkResult::compare(*per_char, *buf);
+	print_cycles_per_line(*per_char);
+	print_cycles_per_line(*buf);
+	print_cycles_per_line(*u64);
+	print_cycles_per_line(*timestamp);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+	RUN_TEST(test_printf_benchmark);
+	test_print_result();
+}
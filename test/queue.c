@@ -14,6 +14,10 @@
 
 static struct queue const test_queue8 = QUEUE_NULL(8, char);
 static struct queue const test_queue2 = QUEUE_NULL(2, int16_t);
+static struct queue const bench_queue = QUEUE_NULL(256, uint8_t);
+
+/* Bytes moved through bench_queue by each benchmark pass. */
+#define QUEUE_BENCH_TOTAL (64 * 1024)
 
 static int test_queue8_empty(void)
 {
@@ -415,10 +419,136 @@ static int test_queue8_iterate_next_reset_on_change(void)
 	return EC_SUCCESS;
 }
 
+static int test_queue8_spsc(void)
+{
+	char buf1[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	char buf2[8];
+
+	/* Partial add when the queue fills up */
+	TEST_ASSERT(queue_spsc_add(&test_queue8, buf1, 5) == 5);
+	TEST_ASSERT(queue_spsc_add(&test_queue8, buf1 + 5, 8) == 3);
+	TEST_ASSERT(queue_is_full(&test_queue8));
+	TEST_ASSERT(queue_spsc_add(&test_queue8, buf1, 1) == 0);
+
+	TEST_ASSERT(queue_spsc_remove(&test_queue8, buf2, 3) == 3);
+	TEST_ASSERT_ARRAY_EQ(buf1, buf2, 3);
+
+	/* Wrap around the end of the buffer on both sides */
+	TEST_ASSERT(queue_spsc_add(&test_queue8, buf1, 3) == 3);
+	TEST_ASSERT(queue_spsc_remove(&test_queue8, buf2, 8) == 8);
+	TEST_ASSERT_ARRAY_EQ(buf1 + 3, buf2, 5);
+	TEST_ASSERT_ARRAY_EQ(buf1, buf2 + 5, 3);
+
+	TEST_ASSERT(queue_is_empty(&test_queue8));
+	TEST_ASSERT(queue_spsc_remove(&test_queue8, buf2, 1) == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_queue2_spsc(void)
+{
+	int16_t buf1[3] = { -1, 2, -3 };
+	int16_t buf2[3];
+
+	TEST_ASSERT(queue_spsc_add(&test_queue2, buf1, 1) == 1);
+	TEST_ASSERT(queue_spsc_remove(&test_queue2, buf2, 1) == 1);
+	TEST_ASSERT(buf2[0] == -1);
+
+	/* Wrapped two-unit transfer */
+	TEST_ASSERT(queue_spsc_add(&test_queue2, buf1, 3) == 2);
+	TEST_ASSERT(queue_spsc_remove(&test_queue2, buf2, 3) == 2);
+	TEST_ASSERT_ARRAY_EQ(buf1, buf2, 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_queue8_spsc_chunks(void)
+{
+	struct queue_chunk chunk;
+	char buf[4] = { 1, 2, 3, 4 };
+	char out[4];
+
+	/* Producer writes in place, consumer copies out */
+	chunk = queue_get_write_chunk(&test_queue8, 0);
+	TEST_ASSERT(chunk.count == 8);
+	memcpy(chunk.buffer, buf, 4);
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 4) == 4);
+	TEST_ASSERT(queue_spsc_remove(&test_queue8, out, 4) == 4);
+	TEST_ASSERT_ARRAY_EQ(buf, out, 4);
+
+	/* Producer copies in, consumer reads in place */
+	TEST_ASSERT(queue_spsc_add(&test_queue8, buf, 4) == 4);
+	chunk = queue_get_read_chunk(&test_queue8);
+	TEST_ASSERT(chunk.count == 4);
+	TEST_ASSERT_ARRAY_EQ((char *)chunk.buffer, buf, 4);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 4) == 4);
+	TEST_ASSERT(queue_is_empty(&test_queue8));
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Report throughput of the per-unit, generic bulk and SPSC queue paths,
+ * passing QUEUE_BENCH_TOTAL bytes through bench_queue in blocks of the given
+ * size.  Time is virtual on the host emulator, so only on-device numbers are
+ * meaningful.
+ */
+static int test_queue_benchmark(void)
+{
+	static uint8_t src[64], dest[64];
+	timestamp_t t0;
+	uint64_t unit_us, bulk_us, spsc_us;
+	int block, i, j, rounds;
+
+	for (i = 0; i < sizeof(src); i++)
+		src[i] = i;
+
+	for (block = 1; block <= sizeof(src); block *= 4) {
+		rounds = QUEUE_BENCH_TOTAL / block;
+
+		t0 = get_time();
+		for (i = 0; i < rounds; i++) {
+			for (j = 0; j < block; j++)
+				queue_add_unit(&bench_queue, &src[j]);
+			for (j = 0; j < block; j++)
+				queue_remove_unit(&bench_queue, &dest[j]);
+		}
+		unit_us = get_time().val - t0.val;
+		TEST_ASSERT_ARRAY_EQ(src, dest, block);
+
+		t0 = get_time();
+		for (i = 0; i < rounds; i++) {
+			queue_add_units(&bench_queue, src, block);
+			queue_remove_units(&bench_queue, dest, block);
+		}
+		bulk_us = get_time().val - t0.val;
+		TEST_ASSERT_ARRAY_EQ(src, dest, block);
+
+		t0 = get_time();
+		for (i = 0; i < rounds; i++) {
+			queue_spsc_add(&bench_queue, src, block);
+			queue_spsc_remove(&bench_queue, dest, block);
+		}
+		spsc_us = get_time().val - t0.val;
+		TEST_ASSERT_ARRAY_EQ(src, dest, block);
+		TEST_ASSERT(queue_is_empty(&bench_queue));
+
+		/* Bytes per microsecond is MB/s. */
+		ccprintf("queue %2d B: unit %4d MB/s, bulk %4d MB/s, "
+			 "spsc %4d MB/s\n",
+			 block, (int)(QUEUE_BENCH_TOTAL / MAX(unit_us, 1)),
+			 (int)(QUEUE_BENCH_TOTAL / MAX(bulk_us, 1)),
+			 (int)(QUEUE_BENCH_TOTAL / MAX(spsc_us, 1)));
+	}
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	queue_init(&test_queue2);
 	queue_init(&test_queue8);
+	queue_init(&bench_queue);
 }
 
 void run_test(int argc, const char **argv)
@@ -442,6 +572,10 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_queue8_iterate_next);
 	RUN_TEST(test_queue2_iterate_next_full);
 	RUN_TEST(test_queue8_iterate_next_reset_on_change);
+	RUN_TEST(test_queue8_spsc);
+	RUN_TEST(test_queue2_spsc);
+	RUN_TEST(test_queue8_spsc_chunks);
+	RUN_TEST(test_queue_benchmark);
 
 	test_print_result();
 }
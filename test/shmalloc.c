@@ -15,6 +15,137 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef TEST_SHMALLOC_POOLS
+/*
+ * CONFIG_SHMALLOC_POOLS build: the pools are opaque, so check them through
+ * the public interface only.
+ */
+
+static int test_pool_reuse(void)
+{
+	char *bufs[CONFIG_SHMALLOC_POOL_64_COUNT];
+	char *again;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(bufs); i++) {
+		TEST_EQ(shared_mem_acquire(40, &bufs[i]), EC_SUCCESS, "%d");
+		if (i)
+			TEST_EQ(abs(bufs[i] - bufs[i - 1]), 64, "%d");
+	}
+
+	/* The most recently freed block is handed out first. */
+	shared_mem_release(bufs[3]);
+	shared_mem_release(bufs[5]);
+	TEST_EQ(shared_mem_acquire(64, &again), EC_SUCCESS, "%d");
+	TEST_ASSERT(again == bufs[5]);
+	TEST_EQ(shared_mem_acquire(1, &again), EC_SUCCESS, "%d");
+	TEST_ASSERT(again == bufs[3]);
+
+	/* With the 64 byte pool empty, a bigger block is used. */
+	TEST_EQ(shared_mem_acquire(64, &again), EC_SUCCESS, "%d");
+	for (i = 0; i < ARRAY_SIZE(bufs); i++)
+		TEST_ASSERT(again + 64 <= bufs[i] || again >= bufs[i] + 64);
+	shared_mem_release(again);
+
+	for (i = 0; i < ARRAY_SIZE(bufs); i++)
+		shared_mem_release(bufs[i]);
+
+	return EC_SUCCESS;
+}
+
+/* Live buffers of the stress test, and the pattern each one is filled with */
+static struct {
+	char *buf;
+	int size;
+	uint8_t fill;
+} stress[24];
+
+static uint32_t next = 127;
+static uint32_t myrand(void)
+{
+	next = next * 1103515245 + 12345;
+	return ((uint32_t)(next / 65536) % 32768);
+}
+
+static int stress_check(int i)
+{
+	int j;
+
+	for (j = 0; j < stress[i].size; j++) {
+		if ((uint8_t)stress[i].buf[j] != stress[i].fill) {
+			ccprintf("buffer %d corrupted at %d\n", i, j);
+			return 0;
+		}
+	}
+
+	/* Must not overlap any other live buffer */
+	for (j = 0; j < ARRAY_SIZE(stress); j++) {
+		if (j == i || !stress[j].buf)
+			continue;
+		if (stress[i].buf < stress[j].buf + stress[j].size &&
+		    stress[j].buf < stress[i].buf + stress[i].size) {
+			ccprintf("buffers %d and %d overlap\n", i, j);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int test_pool_stress(void)
+{
+	const int initial_size = shared_mem_size();
+	int n, i;
+
+	for (n = 0; n < 100000; n++) {
+		uint32_t r = myrand();
+
+		i = r % ARRAY_SIZE(stress);
+		if (stress[i].buf) {
+			TEST_ASSERT(stress_check(i));
+			shared_mem_release(stress[i].buf);
+			stress[i].buf = NULL;
+			continue;
+		}
+
+		/* Mostly pool sized requests, with the odd big one */
+		stress[i].size = (r >> 5) % (r & 0x10 ? 6000 : 1100);
+		if (shared_mem_acquire(stress[i].size, &stress[i].buf) !=
+		    EC_SUCCESS) {
+			stress[i].buf = NULL;
+			continue;
+		}
+		stress[i].fill = n;
+		memset(stress[i].buf, stress[i].fill, stress[i].size);
+		TEST_ASSERT(stress_check(i));
+	}
+
+	for (i = 0; i < ARRAY_SIZE(stress); i++) {
+		if (stress[i].buf) {
+			TEST_ASSERT(stress_check(i));
+			shared_mem_release(stress[i].buf);
+		}
+	}
+
+	/* Everything went back where it came from. */
+	TEST_EQ(shared_mem_size(), initial_size, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_pool_reuse);
+	RUN_TEST(test_pool_stress);
+
+	test_print_result();
+}
+
+#else /* !TEST_SHMALLOC_POOLS */
 
 /*
  * Total size of memory in the malloc pool (shared between free and allocated
@@ -301,3 +432,4 @@ void set_map_bit(uint32_t mask)
 {
 	test_map |= mask;
 }
+#endif /* TEST_SHMALLOC_POOLS */
@@ -68,6 +68,7 @@
 #define CONFIG_KEYBOARD_PROTOCOL_8042
 #define CONFIG_8042_AUX
 #define CONFIG_KEYBOARD_DEBUG
+#define CONFIG_KEYBOARD_LATENCY
 #endif
 
 #ifdef TEST_KB_MKBP
@@ -82,6 +83,8 @@
 #define CONFIG_MKBP_USE_GPIO
 #ifdef TEST_KB_SCAN_STRICT
 #define CONFIG_KEYBOARD_STRICT_DEBOUNCE
+#else
+#define CONFIG_KEYBOARD_SCAN_IDLE_SKIP
 #endif
 #endif
 
@@ -140,6 +143,13 @@
 #define CONFIG_ACCEL_FIFO_THRES 10
 #endif
 
+#ifdef TEST_MOTION_SENSE_FIFO_PACKED
+#define CONFIG_ACCEL_FIFO
+#define CONFIG_ACCEL_FIFO_SIZE 256
+#define CONFIG_ACCEL_FIFO_THRES 10
+#define CONFIG_ACCEL_FIFO_PACKED
+#endif
+
 #ifdef TEST_KASA
 #define CONFIG_FPU
 #define CONFIG_ONLINE_CALIB
@@ -209,6 +219,7 @@
 #if defined(CONFIG_ONLINE_CALIB) || defined(TEST_BODY_DETECTION) ||        \
 	defined(TEST_MOTION_ANGLE) || defined(TEST_MOTION_ANGLE_TABLET) || \
 	defined(TEST_MOTION_LID) || defined(TEST_MOTION_SENSE_FIFO) ||     \
+	defined(TEST_MOTION_SENSE_FIFO_PACKED) ||                          \
 	defined(TEST_TABLET_BROKEN_SENSOR)
 enum sensor_id {
 	BASE,
@@ -285,11 +296,39 @@ enum sensor_id {
 
 #endif
 
+#ifdef TEST_HOOKS_SORTED
+#define CONFIG_HOOK_SORTED
+#define CONFIG_HOOK_DEBUG
+#endif
+
+#ifdef TEST_HOOKS_DEFERRED_HEAP
+#define CONFIG_HOOK_DEFERRED_HEAP
+#define CONFIG_HOOK_DEBUG
+#endif
+
+#ifdef TEST_HOST_COMMAND_HASH
+#define CONFIG_HOSTCMD_LOOKUP_HASH
+#define CONFIG_HOSTCMD_LATENCY
+#define CONFIG_HOSTCMD_BATCH
+#endif
+
 #ifdef TEST_CRC
 #define CONFIG_CRC8
 #define CONFIG_SW_CRC
 #endif
 
+#ifdef TEST_CRC_SLICE4
+#define CONFIG_CRC8
+#define CONFIG_SW_CRC
+#define CONFIG_SW_CRC_SLICE_BY 4
+#endif
+
+#ifdef TEST_CRC_SLICE8
+#define CONFIG_CRC8
+#define CONFIG_SW_CRC
+#define CONFIG_SW_CRC_SLICE_BY 8
+#endif
+
 #ifdef TEST_RSA
 #define CONFIG_RSA
 #ifdef CONFIG_RSA_EXPONENT_3
@@ -317,6 +356,14 @@ enum sensor_id {
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_SHMALLOC_POOLS
+#define CONFIG_MALLOC
+#define CONFIG_SHMALLOC_POOLS
+/* The host has 8K of shared memory, the pools may take half of it. */
+#undef CONFIG_SHMALLOC_POOL_4K_COUNT
+#define CONFIG_SHMALLOC_POOL_4K_COUNT 0
+#endif
+
 #ifdef TEST_SBS_CHARGING
 #define CONFIG_BATTERY
 #define CONFIG_BATTERY_V2
@@ -352,10 +399,28 @@ int board_discharge_on_ac(int enabled);
 int ncp15wb_calculate_temp(uint16_t adc);
 #endif
 
+#ifdef TEST_CONSOLE_BINLOG
+#define CONFIG_CONSOLE_BINLOG
+#undef CONFIG_CONSOLE_BINLOG_BUF_SIZE
+#define CONFIG_CONSOLE_BINLOG_BUF_SIZE 256
+#endif
+
+#ifdef TEST_EVENT_LOG
+#define CONFIG_USB_PD_LOGGING
+#endif
+
 #ifdef TEST_FAN
 #define CONFIG_FANS 1
 #endif
 
+#ifdef TEST_FAN_PI
+#define CONFIG_FAN_PI
+#endif
+
+#ifdef TEST_BIQUAD_BANK
+#define CONFIG_BIQUAD_BANK
+#endif
+
 #ifdef TEST_BUTTON
 #define CONFIG_KEYBOARD_PROTOCOL_8042
 #undef CONFIG_KEYBOARD_VIVALDI
@@ -705,6 +770,12 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_CURVE25519
 #endif /* TEST_X25519 */
 
+#ifdef TEST_I2C_ASYNC
+#define CONFIG_I2C
+#define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_ASYNC
+#endif
+
 #ifdef TEST_I2C_BITBANG
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
@@ -712,6 +783,16 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define I2C_BITBANG_PORT_COUNT 1
 #endif
 
+#ifdef TEST_I2C_STATS
+#define CONFIG_I2C
+#define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_STATS
+#undef CONFIG_I2C_STATS_ENTRIES
+#define CONFIG_I2C_STATS_ENTRIES 4
+#undef CONFIG_I2C_NACK_RETRY_COUNT
+#define CONFIG_I2C_NACK_RETRY_COUNT 2
+#endif
+
 #ifdef TEST_PANIC
 #undef CONFIG_PANIC_STRIP_GPR
 #endif
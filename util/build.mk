@@ -7,7 +7,7 @@
 #
 
 # See Makefile for description.
-host-util-bin-y += cbi-util iteflash
+host-util-bin-y += cbi-util iteflash fan_replay
 host-util-bin-cxx-y += ectool ec_parse_panicinfo lbplay stm32mon lbcc
 build-util-art-y += util/export_taskinfo.so
 
@@ -104,6 +104,7 @@ deps-y += $(out)/util/gen_touchpad_hash.d
 endif # CONFIG_TOUCHPAD_VIRTUAL_OFF
 
 cbi-util-objs=../common/crc8.o ../common/cbi.o
+fan_replay-objs=../common/fan_pi.o
 
 $(out)/util/export_taskinfo.so: $(out)/util/export_taskinfo_ro.o \
 			$(out)/util/export_taskinfo_rw.o
@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+# Copyright 2026 The ChromiumOS Authors
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Decode the EC binary console log (CONFIG_CONSOLE_BINLOG).
+
+The EC logs cprints() calls as records holding the address of the format
+string and the raw arguments. This looks the format strings up in the ELF
+of the running EC image and prints the lines the EC would have printed:
+
+  ectool binlog > binlog.bin
+  util/ec_binlog_decode.py build/<board>/RW/ec.RW.elf binlog.bin
+
+or, to follow the log as it grows:
+
+  ectool binlog --follow | util/ec_binlog_decode.py <elf> -
+"""
+
+import argparse
+import struct
+import sys
+
+
+# struct ec_binlog_record in include/ec_commands.h
+_RECORD = struct.Struct("<BBHII")
+
+_SHF_ALLOC = 0x2
+_SHT_NOBITS = 8
+
+
+class Elf:
+    """The loaded sections of an ELF file, to read strings by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+
+        self.is_64bit = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if self.is_64bit:
+            header = struct.unpack_from(endian + "16xHHIQQQIHHHHHH", self.data)
+            section = struct.Struct(endian + "IIQQQQIIQQ")
+        else:
+            header = struct.unpack_from(endian + "16xHHIIIIIHHHHHH", self.data)
+            section = struct.Struct(endian + "IIIIIIIIII")
+        shoff, shentsize, shnum = header[5], header[10], header[11]
+
+        # (address, file offset, size) of the sections loaded in memory
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = section.unpack_from(
+                self.data, shoff + i * shentsize
+            )[:6]
+            if flags & _SHF_ALLOC and sh_type != _SHT_NOBITS and size:
+                self.sections.append((addr, offset, size))
+
+    def string_at(self, address):
+        """Returns the null-terminated string at address, or None."""
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                if end < 0:
+                    return None
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+class _Args:
+    """Reads the raw arguments of a record in order."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def int(self, size, signed=False):
+        """Returns the next integer argument of size bytes."""
+        if self.pos + size > len(self.data):
+            raise IndexError("missing argument")
+        value = int.from_bytes(
+            self.data[self.pos : self.pos + size], "little", signed=signed
+        )
+        self.pos += size
+        return value
+
+    def string(self):
+        """Returns the next string argument."""
+        end = self.data.find(b"\0", self.pos)
+        if end < 0:
+            raise IndexError("missing argument")
+        value = self.data[self.pos : end].decode("utf-8", "replace")
+        self.pos = end + 1
+        return value
+
+
+def _number(value, precision, base, upper):
+    """Formats like uint64_to_str(): precision is a fixed-point position."""
+    digits = "0123456789ABCDEF" if upper else "0123456789abcdef"
+    text = ""
+    if precision >= 0:
+        for _ in range(precision):
+            value, digit = divmod(value, 10)
+            text = digits[digit] + text
+        text = "." + text
+    if not value:
+        text = "0" + text
+    while value:
+        value, digit = divmod(value, base)
+        text = digits[digit] + text
+    return text
+
+
+def format_ec(fmt, args, word_size):
+    """Formats a record the way vfnprintf() in common/printf.c does."""
+    out = []
+    i = 0
+
+    def next_char():
+        nonlocal i
+        c = fmt[i] if i < len(fmt) else "\0"
+        i += 1
+        return c
+
+    while i < len(fmt):
+        c = next_char()
+        if c != "%":
+            out.append(c)
+            continue
+
+        c = next_char()
+        if c in "%\0":
+            out.append("%")
+            if c == "\0":
+                break
+            continue
+        if c == "c":
+            out.append(chr(args.int(4) & 0xFF))
+            continue
+
+        left = c == "-"
+        if left:
+            c = next_char()
+        plus = c == "+"
+        if plus:
+            c = next_char()
+        zero = c == "0"
+        if zero:
+            c = next_char()
+
+        width = 0
+        if c == "*":
+            width = args.int(4, signed=True)
+            c = next_char()
+        else:
+            while c.isdigit():
+                width = 10 * width + int(c)
+                c = next_char()
+
+        precision = -1
+        if c == ".":
+            c = next_char()
+            if c == "*":
+                precision = args.int(4, signed=True)
+                c = next_char()
+            else:
+                precision = 0
+                while c.isdigit():
+                    precision = 10 * precision + int(c)
+                    c = next_char()
+
+        if c == "s":
+            text = args.string()
+        else:
+            size = 4
+            if c == "l":
+                size = word_size
+                c = next_char()
+                if c == "l":
+                    size = 8
+                    c = next_char()
+            elif c == "z":
+                size = word_size
+                c = next_char()
+            if c == "p":
+                size = word_size
+
+            if c in "di":
+                value = args.int(size, signed=True)
+                sign = "-" if value < 0 else "+" if plus else ""
+                text = sign + _number(abs(value), precision, 10, False)
+            elif c in "uT":
+                text = _number(args.int(size), precision, 10, False)
+            elif c in "xXp":
+                text = _number(args.int(size), precision, 16, c == "X")
+            else:
+                out.append("ERROR")
+                continue
+            precision = -1
+
+        if 0 <= precision < width:
+            width = precision
+        if precision >= 0:
+            text = text[:precision]
+        pad = max(width - len(text), 0)
+        if left:
+            out.append(text + " " * pad)
+        else:
+            out.append(("0" if zero else " ") * pad + text)
+
+    return "".join(out)
+
+
+def decode(elf, data, out):
+    """Prints the whole records in data, returns the bytes used."""
+    word_size = 8 if elf.is_64bit else 4
+    pos = 0
+    while pos + _RECORD.size <= len(data):
+        size, _, time_hi, time_lo, address = _RECORD.unpack_from(data, pos)
+        if size < _RECORD.size:
+            print(f"--- bad record at {pos} ---", file=sys.stderr)
+            return len(data)
+        if pos + size > len(data):
+            # The rest of the record is still to come.
+            break
+        args = _Args(data[pos + _RECORD.size : pos + size])
+        pos += size
+
+        timestamp = (time_hi << 32) | time_lo
+        fmt = elf.string_at(address)
+        if fmt is None:
+            text = f"<unknown format 0x{address:08x}>"
+        else:
+            try:
+                text = format_ec(fmt, args, word_size)
+            except IndexError:
+                text = f"<bad arguments for {fmt!r}>"
+        out.write(
+            f"[{timestamp // 1000000}.{timestamp % 1000000:06d} {text}]\n"
+        )
+    return pos
+
+
+def main(argv):
+    """Decodes a binary log dump, or follows a stream of one."""
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("elf", help="ELF file of the running EC image")
+    parser.add_argument(
+        "log",
+        type=argparse.FileType("rb"),
+        help="output of 'ectool binlog', or - for stdin",
+    )
+    args = parser.parse_args(argv)
+
+    elf = Elf(args.elf)
+    pending = b""
+    while True:
+        # read1() returns what is available, so --follow output shows up
+        # as soon as it arrives.
+        chunk = args.log.read1(65536)
+        if not chunk:
+            break
+        pending += chunk
+        pending = pending[decode(elf, pending, sys.stdout) :]
+        sys.stdout.flush()
+
+    if pending:
+        print(f"--- {len(pending)} trailing bytes ---", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -87,12 +87,18 @@ const char help_str[] =
 	"      Enable/disable LCD backlight\n"
 	"  basestate [attach | detach | reset]\n"
 	"      Manually force base state to attached, detached or reset.\n"
+	"  batch [-b count] <cmd>[:<ver>[:<resp_max>]][=<hex params>] ...\n"
+	"      Send several host commands in one round-trip, or compare\n"
+	"      against individual commands with -b\n"
 	"  battery\n"
 	"      Prints battery info\n"
 	"  batterycutoff [at-shutdown]\n"
 	"      Cut off battery output power\n"
 	"  batteryparam\n"
 	"      Read or write board-specific battery parameter\n"
+	"  binlog [--follow [<interval_ms>]]\n"
+	"      Dumps the binary console log records, for\n"
+	"      util/ec_binlog_decode.py\n"
 	"  boardversion\n"
 	"      Prints the board version\n"
 	"  button [vup|vdown|rec] <Delay-ms>\n"
@@ -114,8 +120,9 @@ const char help_str[] =
 	"      Prints chip info\n"
 	"  cmdversions <cmd>\n"
 	"      Prints supported version mask for a command number\n"
-	"  console\n"
-	"      Prints the last output to the EC debug console\n"
+	"  console [--follow [<interval_ms>]]\n"
+	"      Prints the last output to the EC debug console, with --follow\n"
+	"      keeps streaming new output\n"
 	"  cec\n"
 	"      Read or write CEC messages and settings\n"
 	"  echash [CMDS]\n"
@@ -195,12 +202,16 @@ const char help_str[] =
 	"      Report host sleep state to the EC\n"
 	"  hostevent\n"
 	"      Get & set host event masks.\n"
+	"  hoststats [-r] [count]\n"
+	"      Prints dispatch statistics of the hottest host commands\n"
 	"  i2cprotect <port> [status]\n"
 	"      Protect EC's I2C bus\n"
 	"  i2cread\n"
 	"      Read I2C bus\n"
 	"  i2cspeed <port> [speed]\n"
 	"      Get or set EC's I2C bus speed\n"
+	"  i2cstats [-r]\n"
+	"      Prints I2C bus utilization and per-peripheral statistics\n"
 	"  i2cwrite\n"
 	"      Write I2C bus\n"
 	"  i2cxfer <port> <peripheral_addr> <read_count> [write bytes...]\n"
@@ -217,6 +228,8 @@ const char help_str[] =
 	"      Dump keyboard matrix dimensions\n"
 	"  kbpress\n"
 	"      Simulate key press\n"
+	"  keylatency [-r]\n"
+	"      Get keypress latency percentiles, -r to reset them\n"
 	"  keyscan <beat_us> <filename>\n"
 	"      Test low-level key scanning\n"
 	"  led <name> <query | auto | off | <color> | <color>=<value>...>\n"
@@ -243,8 +256,9 @@ const char help_str[] =
 	"      Controls the PD chip\n"
 	"  pdchipinfo <port>\n"
 	"      Get PD chip information\n"
-	"  pdlog\n"
-	"      Prints the PD event log entries\n"
+	"  pdlog [--follow [<interval_ms>]]\n"
+	"      Prints the PD event log entries, with --follow keeps polling for\n"
+	"      new ones\n"
 	"  pdwritelog <type> <port>\n"
 	"      Writes a PD event log of the given <type>\n"
 	"  pdgetmode <port>\n"
@@ -838,6 +852,229 @@ int cmd_hostsleepstate(int argc, char *argv[])
 	return 0;
 }
 
+static void print_host_cmd_latency(uint16_t cmd)
+{
+	struct ec_params_host_cmd_latency p = { .cmd = cmd };
+	struct ec_response_host_cmd_latency r;
+	int last = EC_HOST_CMD_LATENCY_BUCKETS - 1;
+	int b;
+
+	if (ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_LATENCY),
+		       0, &p, sizeof(p), &r, sizeof(r)) < 0)
+		return;
+
+	for (b = 0; b < last; b++) {
+		if (r.hist[b])
+			printf(" <%uus:%u", 2U << b, r.hist[b]);
+	}
+	if (r.hist[last])
+		printf(" >=%uus:%u", 1U << last, r.hist[last]);
+}
+
+int cmd_hoststats(int argc, char *argv[])
+{
+	struct ec_params_host_cmd_stats p = { .max_entries = 10 };
+	struct ec_response_host_cmd_stats *r =
+		(struct ec_response_host_cmd_stats *)ec_inbuf;
+	char *e;
+	int rv, i;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-r")) {
+			p.flags |= EC_HOST_CMD_STATS_RESET;
+		} else {
+			p.max_entries = strtol(argv[i], &e, 0);
+			if (*e) {
+				fprintf(stderr, "Usage: %s [-r] [count]\n",
+					argv[0]);
+				return -1;
+			}
+		}
+	}
+
+	rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_HOST_CMD_STATS), 0,
+			&p, sizeof(p), r, ec_max_insize);
+	if (rv < 0) {
+		fprintf(stderr, "EC_CMD_HOST_CMD_STATS failed: %d\n", rv);
+		return rv;
+	}
+
+	printf("cmd     count       min_us  avg_us  max_us  histogram\n");
+	for (i = 0; i < r->num_entries; i++) {
+		struct ec_host_cmd_stats_entry *s = &r->entries[i];
+
+		printf("0x%04x  %-10u  %-6u  %-6u  %-6u ", s->cmd, s->count,
+		       s->min_us, s->avg_us, s->max_us);
+		/* Histograms are gone once the statistics were reset. */
+		if (!(p.flags & EC_HOST_CMD_STATS_RESET))
+			print_host_cmd_latency(s->cmd);
+		printf("\n");
+	}
+
+	return 0;
+}
+
+struct batch_entry {
+	uint16_t command;
+	uint8_t version;
+	int response_max;
+	std::vector<uint8_t> params;
+};
+
+static int batch_parse_entry(const char *arg, struct batch_entry *b)
+{
+	char *e;
+	int nibble;
+
+	b->command = strtol(arg, &e, 0);
+	b->version = 0;
+	b->response_max = -1;
+	if (*e == ':') {
+		b->version = strtol(e + 1, &e, 0);
+		if (*e == ':')
+			b->response_max = strtol(e + 1, &e, 0);
+	}
+	if (*e == '=') {
+		for (e++, nibble = 0; isxdigit(*e); e++, nibble++) {
+			int v = isdigit(*e) ? *e - '0' : tolower(*e) - 'a' + 10;
+
+			if (nibble & 1)
+				b->params.back() = (b->params.back() << 4) | v;
+			else
+				b->params.push_back(v);
+		}
+		if (nibble & 1)
+			return -1;
+	}
+	if (*e || b->params.size() > UINT8_MAX || b->response_max > UINT8_MAX)
+		return -1;
+
+	return 0;
+}
+
+static uint64_t batch_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int cmd_batch(int argc, char *argv[])
+{
+	std::vector<struct batch_entry> cmds;
+	std::vector<uint8_t> req;
+	struct ec_params_batch p = {};
+	struct ec_response_batch *r = (struct ec_response_batch *)ec_inbuf;
+	struct ec_batch_result res;
+	uint8_t resp[UINT8_MAX];
+	uint64_t t_batch, t_single;
+	int bench = 0, spare, rv, i, j, off;
+	char *e;
+
+	for (i = 1; i < argc; i++) {
+		struct batch_entry b;
+
+		if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+			bench = strtol(argv[++i], &e, 0);
+			if (*e || bench <= 0) {
+				fprintf(stderr, "Bad count '%s'\n", argv[i]);
+				return -1;
+			}
+			continue;
+		}
+		if (batch_parse_entry(argv[i], &b)) {
+			fprintf(stderr, "Bad command '%s'\n", argv[i]);
+			return -1;
+		}
+		cmds.push_back(b);
+	}
+	if (cmds.empty() || cmds.size() > UINT8_MAX) {
+		fprintf(stderr,
+			"Usage: %s [-b count] "
+			"<cmd>[:<ver>[:<resp_max>]][=<hex params>] ...\n",
+			argv[0]);
+		return -1;
+	}
+
+	/* Share whatever response space is left among unsized commands. */
+	spare = ec_max_insize - sizeof(*r);
+	for (auto &b : cmds)
+		spare -= sizeof(res) + (b.response_max < 0 ? 0 : b.response_max);
+	spare /= (int)cmds.size();
+	for (auto &b : cmds) {
+		if (b.response_max < 0)
+			b.response_max = CLAMP(spare, 0, UINT8_MAX);
+	}
+
+	p.num_cmds = cmds.size();
+	req.insert(req.end(), (uint8_t *)&p, (uint8_t *)&p + sizeof(p));
+	for (auto &b : cmds) {
+		struct ec_batch_cmd c = {};
+
+		c.command = b.command;
+		c.version = b.version;
+		c.param_size = b.params.size();
+		c.response_max = b.response_max;
+		req.insert(req.end(), (uint8_t *)&c, (uint8_t *)&c + sizeof(c));
+		req.insert(req.end(), b.params.begin(), b.params.end());
+	}
+	if (req.size() > (size_t)ec_max_outsize) {
+		fprintf(stderr, "Batch too big (%zu > %d bytes)\n", req.size(),
+			ec_max_outsize);
+		return -1;
+	}
+
+	rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH), 0,
+			req.data(), req.size(), r, ec_max_insize);
+	if (rv < 0) {
+		fprintf(stderr, "EC_CMD_BATCH failed: %d\n", rv);
+		return rv;
+	}
+
+	for (i = 0, off = 0; i < r->num_results; i++) {
+		memcpy(&res, r->results + off, sizeof(res));
+		printf("0x%04x  result %d  size %d", res.command, res.result,
+		       res.size);
+		for (j = 0; j < res.size; j++)
+			printf("%s%02x", j % 16 ? " " : "\n    ",
+			       r->results[off + sizeof(res) + j]);
+		printf("\n");
+		off += sizeof(res) + res.size;
+	}
+	if (r->num_results < cmds.size())
+		printf("%zu command(s) did not fit in the response\n",
+		       cmds.size() - r->num_results);
+
+	if (!bench)
+		return 0;
+
+	t_batch = batch_time_us();
+	for (i = 0; i < bench; i++) {
+		rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_BATCH), 0,
+				req.data(), req.size(), r, ec_max_insize);
+		if (rv < 0)
+			return rv;
+	}
+	t_batch = batch_time_us() - t_batch;
+
+	t_single = batch_time_us();
+	for (i = 0; i < bench; i++) {
+		for (auto &b : cmds)
+			ec_command(b.command, b.version, b.params.data(),
+				   b.params.size(), resp, b.response_max);
+	}
+	t_single = batch_time_us() - t_single;
+
+	printf("%d x batch:      %" PRIu64 " us (%" PRIu64 " us each)\n",
+	       bench, t_batch, t_batch / bench);
+	printf("%d x individual: %" PRIu64 " us (%" PRIu64 " us each)\n",
+	       bench, t_single, t_single / bench);
+	printf("%zu round-trips saved per batch\n", cmds.size() - 1);
+
+	return 0;
+}
+
 int cmd_test(int argc, char *argv[])
 {
 	struct ec_params_test_protocol p = {
@@ -5259,8 +5496,9 @@ static const struct {
 	ST_BOTH_SIZES(sensor_range),
 	ST_BOTH_SIZES(kb_wake_angle),
 	ST_BOTH_SIZES(data),
-	{ ST_CMD_SIZE,
-	  ST_RSP_SIZE(fifo_info) + sizeof(uint16_t) * ECTOOL_MAX_SENSOR },
+	{ ST_PRM_SIZE(fifo_info),
+	  ST_RSP_SIZE(fifo_info) + sizeof(uint16_t) * ECTOOL_MAX_SENSOR +
+		  sizeof(struct ec_response_motion_sense_fifo_stats) },
 	ST_BOTH_SIZES(fifo_flush),
 	ST_BOTH_SIZES(fifo_read),
 	ST_BOTH_SIZES(perform_calib),
@@ -5341,6 +5579,86 @@ static void motionsense_display_activities(uint32_t activities)
 		       MOTIONSENSE_ACTIVITY_BODY_DETECTION);
 }
 
+static void ms_print_fifo_vector(const struct ec_response_motion_sensor_data *v)
+{
+	if (v->flags &
+	    (MOTIONSENSE_SENSOR_FLAG_TIMESTAMP | MOTIONSENSE_SENSOR_FLAG_FLUSH)) {
+		printf("Timestamp:%" PRIx32 "%s\n", v->timestamp,
+		       (v->flags & MOTIONSENSE_SENSOR_FLAG_FLUSH ? " - Flush" :
+								   ""));
+	} else {
+		printf("Sensor %d: %d\t%d\t%d "
+		       "(as uint16: %u\t%u\t%u)\n",
+		       v->sensor_num, v->data[0], v->data[1], v->data[2],
+		       v->data[0], v->data[1], v->data[2]);
+	}
+}
+
+static const uint8_t *ms_get_varint(const uint8_t *p, const uint8_t *end,
+				    uint32_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	while (p < end && shift < 32) {
+		*v |= (uint32_t)(*p & 0x7f) << shift;
+		shift += 7;
+		if (!(*p++ & 0x80))
+			return p;
+	}
+	return NULL;
+}
+
+/*
+ * Decode and print one MOTIONSENSE_CMD_FIFO_READ response in the packed
+ * encoding, see EC_MOTION_SENSE_PACKED in ec_commands.h.
+ */
+static int ms_unpack_fifo(const uint8_t *p, const uint8_t *end)
+{
+	const uint8_t sensor_mask = EC_MOTION_SENSE_PACKED_SENSOR_MASK;
+	int16_t prev[EC_MOTION_SENSE_PACKED_MAX_SENSORS][3] = {};
+	uint32_t prev_ts = 0, v;
+	struct ec_response_motion_sensor_data e;
+	int count = 0, i;
+
+	while (p && p < end) {
+		memset(&e, 0, sizeof(e));
+		if (!(*p & EC_MOTION_SENSE_PACKED)) {
+			if (end - p < (ptrdiff_t)sizeof(e))
+				return -1;
+			memcpy(&e, p, sizeof(e));
+			p += sizeof(e);
+		} else if (*p & EC_MOTION_SENSE_PACKED_TIMESTAMP) {
+			e.flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
+			e.sensor_num = *p++ & sensor_mask;
+			p = ms_get_varint(p, end, &v);
+			e.timestamp = prev_ts + v;
+		} else {
+			e.sensor_num = *p++ & sensor_mask;
+			if (p >= end)
+				return -1;
+			e.flags = *p++;
+			for (i = 0; i < 3 && p; i++) {
+				p = ms_get_varint(p, end, &v);
+				e.data[i] = prev[e.sensor_num][i] +
+					    (int16_t)((v >> 1) ^ -(v & 1));
+			}
+		}
+		if (!p)
+			return -1;
+
+		if (e.flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP)
+			prev_ts = e.timestamp;
+		else if (!(e.flags & MOTIONSENSE_SENSOR_FLAG_ODR) &&
+			 e.sensor_num < EC_MOTION_SENSE_PACKED_MAX_SENSORS)
+			memcpy(prev[e.sensor_num], e.data, sizeof(e.data));
+
+		ms_print_fifo_vector(&e);
+		count++;
+	}
+	return count;
+}
+
 static int cmd_motionsense(int argc, char **argv)
 {
 	int i, rv, status_only = (argc == 2);
@@ -5794,6 +6112,8 @@ static int cmd_motionsense(int argc, char **argv)
 	}
 
 	if (argc == 2 && !strcasecmp(argv[1], "fifo_info")) {
+		struct ec_response_motion_sense_fifo_stats stats;
+		double pct;
 		int sensor_count;
 
 		param.cmd = MOTIONSENSE_CMD_DUMP;
@@ -5806,6 +6126,8 @@ static int cmd_motionsense(int argc, char **argv)
 		sensor_count = resp->dump.sensor_count;
 
 		param.cmd = MOTIONSENSE_CMD_FIFO_INFO;
+		param.fifo_info.sensor_num = 0;
+		param.fifo_info.flags = MOTIONSENSE_FIFO_INFO_STATS;
 		rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 2, &param,
 				ms_command_sizes[param.cmd].outsize, resp,
 				ms_command_sizes[param.cmd].insize);
@@ -5821,6 +6143,20 @@ static int cmd_motionsense(int argc, char **argv)
 			if (lost != 0)
 				printf("Lost %d:     %d\n", i, lost);
 		}
+
+		/* Drop statistics, if the EC keeps them */
+		if (rv >= (int)(sizeof(resp->fifo_info) +
+				sizeof(uint16_t) * sensor_count +
+				sizeof(stats))) {
+			memcpy(&stats, &resp->fifo_info.lost[sensor_count],
+			       sizeof(stats));
+			printf("Staged:   %" PRIu32 "\n", stats.total_staged);
+			pct = stats.total_staged ? 100.0 * stats.total_dropped /
+							   stats.total_staged :
+						   0.0;
+			printf("Dropped:  %" PRIu32 " (%.2f%%)\n",
+			       stats.total_dropped, pct);
+		}
 		return 0;
 	}
 
@@ -5856,11 +6192,11 @@ static int cmd_motionsense(int argc, char **argv)
 		}
 		while (fifo_read_buffer.number_data != 0 &&
 		       print_data < max_data) {
-			struct ec_response_motion_sensor_data *vector;
 			param.cmd = MOTIONSENSE_CMD_FIFO_READ;
 			param.fifo_read.max_data_vector =
 				MIN(ARRAY_SIZE(fifo_read_buffer.data),
 				    max_data - print_data);
+			param.fifo_read.flags = MOTIONSENSE_FIFO_READ_PACKED;
 
 			rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 2, &param,
 					ms_command_sizes[param.cmd].outsize,
@@ -5868,27 +6204,14 @@ static int cmd_motionsense(int argc, char **argv)
 			if (rv < 0)
 				return rv;
 
-			print_data += fifo_read_buffer.number_data;
-			for (i = 0; i < fifo_read_buffer.number_data; i++) {
-				vector = &fifo_read_buffer.data[i];
-				if (vector->flags &
-				    (MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
-				     MOTIONSENSE_SENSOR_FLAG_FLUSH)) {
-					printf("Timestamp:%" PRIx32 "%s\n",
-					       vector->timestamp,
-					       (vector->flags & MOTIONSENSE_SENSOR_FLAG_FLUSH ?
-							" - Flush" :
-							""));
-				} else {
-					printf("Sensor %d: %d\t%d\t%d "
-					       "(as uint16: %u\t%u\t%u)\n",
-					       vector->sensor_num,
-					       vector->data[0], vector->data[1],
-					       vector->data[2], vector->data[0],
-					       vector->data[1],
-					       vector->data[2]);
-				}
+			if (rv < (int)sizeof(fifo_read_buffer.number_data) ||
+			    ms_unpack_fifo((uint8_t *)fifo_read_buffer.data,
+					   (uint8_t *)&fifo_read_buffer + rv) !=
+				    (int)fifo_read_buffer.number_data) {
+				fprintf(stderr, "Bad fifo data.\n");
+				return -1;
 			}
+			print_data += fifo_read_buffer.number_data;
 		}
 		return 0;
 	}
@@ -8995,11 +9318,100 @@ int cmd_rtc_get_alarm(int argc, char *argv[])
 	return 0;
 }
 
+/*
+ * Stream the console (EC_CMD_CONSOLE_STREAM) or the binary console log
+ * (EC_CMD_CONSOLE_BINLOG) with an offset cursor, straight from the EC's
+ * buffer. cmd is the private command offset. With follow, keep polling for
+ * new output every interval_ms.
+ * Notices go to stderr for the binary log, to keep stdout decodable.
+ */
+static int console_stream(int cmd, bool follow, int interval_ms)
+{
+	struct ec_params_console_stream p = {
+		.flags = EC_CONSOLE_STREAM_OLDEST,
+	};
+	struct ec_response_console_stream *r =
+		(struct ec_response_console_stream *)ec_inbuf;
+	FILE *notice = cmd == EC_CMD_CONSOLE_BINLOG ? stderr : stdout;
+	int rv;
+
+	while (1) {
+		rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(cmd), 0, &p,
+				sizeof(p), ec_inbuf, ec_max_insize);
+		if (rv == -EECRESULT - EC_RES_INVALID_PARAM &&
+		    !(p.flags & EC_CONSOLE_STREAM_OLDEST)) {
+			/* The offset is ahead of the EC, so it has rebooted. */
+			fprintf(notice, "\n--- EC reset ---\n");
+			p.flags = EC_CONSOLE_STREAM_OLDEST;
+			continue;
+		}
+		if (rv < 0)
+			return rv;
+
+		if (r->lost)
+			fprintf(notice, "\n--- %u bytes lost ---\n", r->lost);
+		fwrite(r->data, 1, r->size, stdout);
+
+		p.flags = 0;
+		p.offset = r->next_offset;
+		if (r->size)
+			continue;
+		if (!follow)
+			break;
+		fflush(stdout);
+		usleep(interval_ms * 1000);
+	}
+
+	if (cmd == EC_CMD_CONSOLE_STREAM)
+		printf("\n");
+	return 0;
+}
+
+/* Parse [--follow [<interval_ms>]], returns non-zero on error */
+static int parse_follow_args(int argc, char *argv[], bool *follow,
+			     int *interval_ms)
+{
+	char *e;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "--follow")) {
+			fprintf(stderr,
+				"Usage: %s [--follow [<interval_ms>]]\n",
+				argv[0]);
+			return -1;
+		}
+		*follow = true;
+	}
+	if (argc > 2) {
+		*interval_ms = strtol(argv[2], &e, 0);
+		if ((e && *e) || *interval_ms <= 0) {
+			fprintf(stderr, "Bad interval.\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int cmd_console(int argc, char *argv[])
 {
 	char *out = (char *)ec_inbuf;
+	bool follow = false;
+	int interval_ms = 100;
 	int rv;
 
+	if (parse_follow_args(argc, argv, &follow, &interval_ms))
+		return -1;
+
+	if (ec_cmd_version_supported(
+		    EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_CONSOLE_STREAM), 0))
+		return console_stream(EC_CMD_CONSOLE_STREAM, follow,
+				      interval_ms);
+	if (follow) {
+		fprintf(stderr, "EC does not support console streaming.\n");
+		return -1;
+	}
+
 	/* Snapshot the EC console */
 	rv = ec_command(EC_CMD_CONSOLE_SNAPSHOT, 0, NULL, 0, NULL, 0);
 	if (rv < 0)
@@ -9023,6 +9435,18 @@ int cmd_console(int argc, char *argv[])
 	printf("\n");
 	return 0;
 }
+
+int cmd_binlog(int argc, char *argv[])
+{
+	bool follow = false;
+	int interval_ms = 100;
+
+	if (parse_follow_args(argc, argv, &follow, &interval_ms))
+		return -1;
+
+	return console_stream(EC_CMD_CONSOLE_BINLOG, follow, interval_ms);
+}
+
 struct param_info {
 	const char *name; /* name of this parameter */
 	const char *help; /* help message */
@@ -9150,6 +9574,45 @@ static int cmd_kbinfo(int argc, char *argv[])
 	return 0;
 }
 
+static int cmd_keylatency(int argc, char *argv[])
+{
+	/* In enum ec_keyboard_latency_stage_id order */
+	static const char *const stage_names[] = {
+		"scan to queue",
+		"queue to host",
+		"total",
+	};
+	struct ec_params_keyboard_latency p = {};
+	struct ec_response_keyboard_latency r;
+	int rv, i;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "-r"))) {
+		fprintf(stderr, "Usage: %s [-r]\n", argv[0]);
+		return -1;
+	}
+	if (argc == 2)
+		p.flags = EC_KEYBOARD_LATENCY_RESET;
+
+	rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_KEYBOARD_LATENCY),
+			0, &p, sizeof(p), &r, sizeof(r));
+	if (rv < 0)
+		return rv;
+
+	printf("Scan codes: %u measured, %u dropped\n", r.total, r.dropped);
+	if (!r.samples)
+		return 0;
+
+	printf("Over the last %u:\n", r.samples);
+	printf("%-14s %10s %10s %10s\n", "stage", "p50_us", "p99_us",
+	       "max_us");
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT; i++)
+		printf("%-14s %10u %10u %10u\n", stage_names[i],
+		       r.stages[i].p50_us, r.stages[i].p99_us,
+		       r.stages[i].max_us);
+
+	return 0;
+}
+
 static int cmd_keyconfig(int argc, char *argv[])
 {
 	struct ec_params_mkbp_set_config req;
@@ -10361,90 +10824,172 @@ static int cmd_pchg(int argc, char *argv[])
 	return -1;
 }
 
-int cmd_pd_log(int argc, char *argv[])
+static void print_pd_log_entry(const struct ec_response_pd_log *r, time_t now)
 {
-	union {
-		struct ec_response_pd_log r;
-		uint32_t words[8]; /* space for the payload */
-	} u;
 	struct mcdp_info minfo;
 	struct ec_response_usb_pd_power_info pinfo;
-	int rv;
 	unsigned long long milliseconds;
 	unsigned int seconds;
-	time_t now;
 	struct tm ltime;
 	char time_str[64];
 
+	/* the timestamp is in 1024th of seconds */
+	milliseconds =
+		((uint64_t)r->timestamp << PD_LOG_TIMESTAMP_SHIFT) / 1000;
+	/* the timestamp is the number of milliseconds in the past */
+	seconds = (milliseconds + 999) / 1000;
+	milliseconds -= seconds * 1000;
+	now -= seconds;
+	localtime_r(&now, &ltime);
+	strftime(time_str, sizeof(time_str), "%F %T", &ltime);
+	printf("%s.%03lld P%d ", time_str, -milliseconds,
+	       PD_LOG_PORT(r->size_port));
+	if (r->type == PD_EVENT_MCU_CHARGE) {
+		if (r->data & CHARGE_FLAGS_OVERRIDE)
+			printf("override ");
+		if (r->data & CHARGE_FLAGS_DELAYED_OVERRIDE)
+			printf("pending_override ");
+		memcpy(&pinfo.meas, r->payload,
+		       sizeof(struct usb_chg_measures));
+		pinfo.dualrole = !!(r->data & CHARGE_FLAGS_DUAL_ROLE);
+		pinfo.role = r->data & CHARGE_FLAGS_ROLE_MASK;
+		pinfo.type = (r->data & CHARGE_FLAGS_TYPE_MASK) >>
+			     CHARGE_FLAGS_TYPE_SHIFT;
+		pinfo.max_power = 0;
+		print_pd_power_info(&pinfo);
+	} else if (r->type == PD_EVENT_MCU_CONNECT) {
+		printf("New connection\n");
+	} else if (r->type == PD_EVENT_MCU_BOARD_CUSTOM) {
+		printf("Board-custom event\n");
+	} else if (r->type == PD_EVENT_ACC_RW_FAIL) {
+		printf("RW signature check failed\n");
+	} else if (r->type == PD_EVENT_PS_FAULT) {
+		static const char *const fault_names[] = {
+			"---", "OCP", "fast OCP", "OVP", "Discharge"
+		};
+		const char *fault = r->data < ARRAY_SIZE(fault_names) ?
+					    fault_names[r->data] :
+					    "???";
+		printf("Power supply fault: %s\n", fault);
+	} else if (r->type == PD_EVENT_VIDEO_DP_MODE) {
+		printf("DP mode %sabled\n", (r->data == 1) ? "en" : "dis");
+	} else if (r->type == PD_EVENT_VIDEO_CODEC) {
+		memcpy(&minfo, r->payload, sizeof(struct mcdp_info));
+		printf("HDMI info: family:%04x chipid:%04x "
+		       "irom:%d.%d.%d fw:%d.%d.%d\n",
+		       MCDP_FAMILY(minfo.family), MCDP_CHIPID(minfo.chipid),
+		       minfo.irom.major, minfo.irom.minor, minfo.irom.build,
+		       minfo.fw.major, minfo.fw.minor, minfo.fw.build);
+	} else { /* Unknown type */
+		int i;
+		printf("Event %02x (%04x) [", r->type, r->data);
+		for (i = 0; i < PD_LOG_SIZE(r->size_port); i++)
+			printf("%02x ", r->payload[i]);
+		printf("]\n");
+	}
+}
+
+static const int pd_get_log_entries =
+	EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_PD_GET_LOG_ENTRIES);
+
+/* Size of a log entry in a EC_CMD_PD_GET_LOG_ENTRIES response */
+static int pd_log_entry_size(const struct ec_response_pd_log *r)
+{
+	return sizeof(*r) *
+	       (1 + DIV_ROUND_UP(PD_LOG_SIZE(r->size_port), sizeof(*r)));
+}
+
+/*
+ * Read the log in batches with a cursor, so no entry is lost if a command
+ * fails. With follow, keep polling for new entries every interval_ms.
+ */
+static int pd_log_stream(bool follow, int interval_ms)
+{
+	struct ec_params_pd_get_log_entries_v1 p = {
+		.flags = EC_PD_LOG_ENTRIES_OLDEST,
+	};
+	struct ec_response_pd_get_log_entries_v1 *r =
+		(struct ec_response_pd_get_log_entries_v1 *)ec_inbuf;
+	const struct ec_response_pd_log *e;
+	time_t now;
+	int rv, off, busy_ms = 0;
+
 	while (1) {
 		now = time(NULL);
+		rv = ec_command(pd_get_log_entries, 1, &p, sizeof(p), ec_inbuf,
+				ec_max_insize);
+		/* When following, back off up to the interval while busy */
+		if (rv == -EECRESULT - EC_RES_BUSY && follow) {
+			busy_ms = MIN(busy_ms ? busy_ms * 2 : 10, interval_ms);
+			usleep(busy_ms * 1000);
+			continue;
+		}
+		if (rv < 0)
+			return rv;
+		busy_ms = 0;
+
+		/* The EC moved past entries we didn't read yet */
+		if (!(p.flags & EC_PD_LOG_ENTRIES_OLDEST) &&
+		    r->cursor != p.cursor)
+			printf("--- entries discarded before being read ---\n");
+		if (r->dropped)
+			printf("--- %u entries dropped ---\n", r->dropped);
+
+		for (off = 0; off + (int)sizeof(*e) <= r->size;
+		     off += pd_log_entry_size(e)) {
+			e = (const struct ec_response_pd_log *)(r->entries +
+								 off);
+			print_pd_log_entry(e, now);
+		}
+
+		p.flags = 0;
+		p.cursor = r->next_cursor;
+		if (r->size)
+			continue;
+		if (!follow) {
+			printf("--- END OF LOG ---\n");
+			break;
+		}
+		fflush(stdout);
+		usleep(interval_ms * 1000);
+	}
+
+	return 0;
+}
+
+int cmd_pd_log(int argc, char *argv[])
+{
+	union {
+		struct ec_response_pd_log r;
+		uint32_t words[8]; /* space for the payload */
+	} u;
+	bool follow = false;
+	int interval_ms = 1000;
+	int rv;
+
+	if (parse_follow_args(argc, argv, &follow, &interval_ms))
+		return -1;
+
+	if (ec_cmd_version_supported(pd_get_log_entries, 1))
+		return pd_log_stream(follow, interval_ms);
+
+	while (1) {
 		rv = ec_command(EC_CMD_PD_GET_LOG_ENTRY, 0, NULL, 0, &u,
 				sizeof(u));
 		if (rv < 0)
 			return rv;
 
 		if (u.r.type == PD_EVENT_NO_ENTRY) {
+			if (follow) {
+				fflush(stdout);
+				usleep(interval_ms * 1000);
+				continue;
+			}
 			printf("--- END OF LOG ---\n");
 			break;
 		}
 
-		/* the timestamp is in 1024th of seconds */
-		milliseconds =
-			((uint64_t)u.r.timestamp << PD_LOG_TIMESTAMP_SHIFT) /
-			1000;
-		/* the timestamp is the number of milliseconds in the past */
-		seconds = (milliseconds + 999) / 1000;
-		milliseconds -= seconds * 1000;
-		now -= seconds;
-		localtime_r(&now, &ltime);
-		strftime(time_str, sizeof(time_str), "%F %T", &ltime);
-		printf("%s.%03lld P%d ", time_str, -milliseconds,
-		       PD_LOG_PORT(u.r.size_port));
-		if (u.r.type == PD_EVENT_MCU_CHARGE) {
-			if (u.r.data & CHARGE_FLAGS_OVERRIDE)
-				printf("override ");
-			if (u.r.data & CHARGE_FLAGS_DELAYED_OVERRIDE)
-				printf("pending_override ");
-			memcpy(&pinfo.meas, u.r.payload,
-			       sizeof(struct usb_chg_measures));
-			pinfo.dualrole = !!(u.r.data & CHARGE_FLAGS_DUAL_ROLE);
-			pinfo.role = u.r.data & CHARGE_FLAGS_ROLE_MASK;
-			pinfo.type = (u.r.data & CHARGE_FLAGS_TYPE_MASK) >>
-				     CHARGE_FLAGS_TYPE_SHIFT;
-			pinfo.max_power = 0;
-			print_pd_power_info(&pinfo);
-		} else if (u.r.type == PD_EVENT_MCU_CONNECT) {
-			printf("New connection\n");
-		} else if (u.r.type == PD_EVENT_MCU_BOARD_CUSTOM) {
-			printf("Board-custom event\n");
-		} else if (u.r.type == PD_EVENT_ACC_RW_FAIL) {
-			printf("RW signature check failed\n");
-		} else if (u.r.type == PD_EVENT_PS_FAULT) {
-			static const char *const fault_names[] = {
-				"---", "OCP", "fast OCP", "OVP", "Discharge"
-			};
-			const char *fault = u.r.data < ARRAY_SIZE(fault_names) ?
-						    fault_names[u.r.data] :
-						    "???";
-			printf("Power supply fault: %s\n", fault);
-		} else if (u.r.type == PD_EVENT_VIDEO_DP_MODE) {
-			printf("DP mode %sabled\n",
-			       (u.r.data == 1) ? "en" : "dis");
-		} else if (u.r.type == PD_EVENT_VIDEO_CODEC) {
-			memcpy(&minfo, u.r.payload, sizeof(struct mcdp_info));
-			printf("HDMI info: family:%04x chipid:%04x "
-			       "irom:%d.%d.%d fw:%d.%d.%d\n",
-			       MCDP_FAMILY(minfo.family),
-			       MCDP_CHIPID(minfo.chipid), minfo.irom.major,
-			       minfo.irom.minor, minfo.irom.build,
-			       minfo.fw.major, minfo.fw.minor, minfo.fw.build);
-		} else { /* Unknown type */
-			int i;
-			printf("Event %02x (%04x) [", u.r.type, u.r.data);
-			for (i = 0; i < PD_LOG_SIZE(u.r.size_port); i++)
-				printf("%02x ", u.r.payload[i]);
-			printf("]\n");
-		}
+		print_pd_log_entry(&u.r, time(NULL));
 	}
 
 	return 0;
@@ -11461,9 +12006,11 @@ const struct command commands[] = {
 	{ "autofanctrl", cmd_thermal_auto_fan_ctrl },
 	{ "backlight", cmd_lcd_backlight },
 	{ "basestate", cmd_basestate },
+	{ "batch", cmd_batch },
 	{ "battery", cmd_battery },
 	{ "batterycutoff", cmd_battery_cut_off },
 	{ "batteryparam", cmd_battery_vendor_param },
+	{ "binlog", cmd_binlog },
 	{ "boardversion", cmd_board_version },
 	{ "boottime", cmd_boottime },
 	{ "button", cmd_button },
@@ -11514,10 +12061,12 @@ const struct command commands[] = {
 	{ "hibdelay", cmd_hibdelay },
 	{ "hostevent", cmd_hostevent },
 	{ "hostsleepstate", cmd_hostsleepstate },
+	{ "hoststats", cmd_hoststats },
 	{ "locatechip", cmd_locate_chip },
 	{ "i2cprotect", cmd_i2c_protect },
 	{ "i2cread", cmd_i2c_read },
 	{ "i2cspeed", cmd_i2c_speed },
+	{ "i2cstats", cmd_i2c_stats },
 	{ "i2cwrite", cmd_i2c_write },
 	{ "i2cxfer", cmd_i2c_xfer },
 	{ "infopddev", cmd_pd_device_info },
@@ -11528,6 +12077,7 @@ const struct command commands[] = {
 	{ "kbinfo", cmd_kbinfo },
 	{ "kbpress", cmd_kbpress },
 	{ "keyconfig", cmd_keyconfig },
+	{ "keylatency", cmd_keylatency },
 	{ "keyscan", cmd_keyscan },
 	{ "memory_dump", cmd_memory_dump },
 	{ "mkbpget", cmd_mkbp_get },
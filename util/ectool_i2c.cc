@@ -405,3 +405,60 @@ int cmd_i2c_speed(int argc, char *argv[])
 
 	return i2c_set(port, speed);
 }
+
+int cmd_i2c_stats(int argc, char *argv[])
+{
+	struct ec_params_i2c_stats p = {};
+	struct ec_response_i2c_stats *r =
+		(struct ec_response_i2c_stats *)ec_inbuf;
+	uint8_t flags = 0;
+	int rv, i;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "-r"))) {
+		fprintf(stderr, "Usage: %s [-r]\n", argv[0]);
+		return -1;
+	}
+	if (argc == 2)
+		flags = EC_I2C_STATS_RESET;
+
+	do {
+		rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_I2C_STATS),
+				0, &p, sizeof(p), r, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr, "EC_CMD_I2C_STATS failed: %d\n", rv);
+			return rv;
+		}
+
+		if (p.start == 0) {
+			printf("Utilization over %u ms:\n", r->window_ms);
+			for (i = 0; i < r->num_ports; i++)
+				printf("  port %u: %u.%u%%\n", r->ports[i].port,
+				       r->ports[i].utilization / 10,
+				       r->ports[i].utilization % 10);
+			printf("port addr  count      bytes      busy_us    "
+			       "max_us  retry  nak    err\n");
+		}
+		for (i = 0; i < r->num_entries; i++) {
+			struct ec_i2c_stats_entry *s = &r->entries[i];
+
+			printf("%-4u 0x%02x  %-10u %-10u %-10u %-7u %-6u %-6u "
+			       "%u\n",
+			       s->port, s->addr, s->count, s->bytes,
+			       s->busy_us, s->max_us, s->retries, s->naks,
+			       s->errors);
+		}
+		p.start += r->num_entries;
+	} while (r->num_entries && p.start < r->total_entries);
+
+	/* Reset only once everything was read. */
+	if (flags) {
+		p.flags = flags;
+		p.start = r->total_entries;
+		rv = ec_command(EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_I2C_STATS),
+				0, &p, sizeof(p), r, ec_max_insize);
+		if (rv < 0)
+			return rv;
+	}
+
+	return 0;
+}
@@ -0,0 +1,398 @@
+/* Copyright 2026 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Replay a Lotus 'thermallog en' capture through the predictive PI fan
+ * controller (common/fan_pi.c), and compare the fan speeds it asks for with
+ * the ones in the capture.
+ *
+ * The replay is open loop: the temperatures are the ones the captured fan
+ * speeds produced, so this shows how calm the new controller is and how it
+ * reacts to the same heat, not the temperatures it would end up at.
+ */
+
+#include "fan_pi.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Sensors, in the order of pi_sensor in lotus/src/thermal.c */
+enum {
+	S_APU,
+	S_APU_DIE,
+	S_GPU_VR,
+	S_GPU_DIE,
+	S_COUNT,
+};
+
+static const char *const sensor_names[S_COUNT] = { "apu", "apu_die", "gpu_vr",
+						   "gpu_die" };
+
+/* Columns of the thermallog line after "Thrm", empty ones skipped */
+enum {
+	COL_GPU_VR_MK,
+	COL_GPU_VRAM_MK,
+	COL_APU_MK,
+	COL_GPU_DIE_C,
+	COL_APU_DIE_C,
+	COL_GPU_FILT_C,
+	COL_APU_FILT_C,
+	COL_PCT,
+	COL_GPU_PCT,
+	COL_GPU_FILT_PCT,
+	COL_APU_PCT,
+	COL_APU_FILT_PCT,
+	COL_RPM,
+	COL_FAN,
+	/* Only in captures taken with the power columns */
+	COL_APU_MW,
+	COL_GPU_MW,
+	COL_PI,
+	COL_COUNT,
+};
+
+#define COL_REQUIRED (COL_FAN + 1)
+
+/* Moves smaller than this don't count as a change of direction. */
+#define RPM_DEADBAND 50
+
+/* Lotus defaults: temp_fan_off/max from the devicetree, tau in thermal.c */
+static int temp_off_c[S_COUNT] = { 47, 65, 50, 50 };
+static int temp_max_c[S_COUNT] = { 62, 97, 74, 80 };
+static int tau_ms[S_COUNT] = { 30000, 5000, 40000, 5000 };
+
+static struct fan_pi_sensor sensors[S_COUNT];
+static struct fan_pi_config cfg = {
+	.sensors = sensors,
+	.num_sensors = S_COUNT,
+	.kp = 2 * FAN_PI_GAIN_ONE,
+	.ki = FAN_PI_GAIN_ONE / 32,
+	.ff_per_w = 400,
+	.slew_up = 10,
+	.slew_down = 2,
+};
+
+static int rpm_min = 1000;
+static int rpm_max = 4000;
+static int verbose;
+
+struct fan_stats {
+	long long rpm_sum;
+	long long hot_rpm_sum;
+	long long travel;
+	int max_slew;
+	int reversals;
+	int starts;
+	/* Last RPM, and direction of the last move past the deadband */
+	int rpm;
+	int anchor;
+	int dir;
+};
+
+/* Same mapping as fan_percent_to_rpm() in lotus/src/thermal.c */
+static int percent_to_rpm(int pct)
+{
+	if (pct <= 0)
+		return 0;
+	return ((pct - 1) * rpm_max + (100 - pct) * rpm_min) / 99;
+}
+
+static void stats_add(struct fan_stats *s, int rpm, int dt_ms, int hot,
+		      int first)
+{
+	int delta = rpm - s->rpm;
+	int dir;
+
+	s->rpm_sum += rpm;
+	if (hot)
+		s->hot_rpm_sum += rpm;
+
+	if (first) {
+		s->rpm = s->anchor = rpm;
+		return;
+	}
+
+	s->travel += abs(delta);
+	if (dt_ms > 0 && abs(delta) * 1000LL / dt_ms > s->max_slew)
+		s->max_slew = abs(delta) * 1000LL / dt_ms;
+	if (!s->rpm && rpm)
+		s->starts++;
+
+	/* Count reversals of direction, ignoring jitter. */
+	if (abs(rpm - s->anchor) >= RPM_DEADBAND) {
+		dir = rpm > s->anchor ? 1 : -1;
+		if (s->dir && dir != s->dir)
+			s->reversals++;
+		s->dir = dir;
+		s->anchor = rpm;
+	} else if (s->dir * (rpm - s->anchor) > 0) {
+		s->anchor = rpm;
+	}
+
+	s->rpm = rpm;
+}
+
+/*
+ * Split a thermallog line into its columns. Returns the number of columns,
+ * or 0 if this is not a thermallog line. time_us is left alone when the line
+ * has no timestamp.
+ */
+static int parse_line(char *line, long long *cols, long long *time_us)
+{
+	char *p = strstr(line, "Thrm");
+	char *tok, *save, *end;
+	long long sec, usec;
+	int n = 0;
+
+	if (!p)
+		return 0;
+
+	if (sscanf(line, " [%lld.%lld", &sec, &usec) == 2)
+		*time_us = sec * 1000000 + usec;
+
+	for (tok = strtok_r(p + 4, "\t\r\n]", &save); tok && n < COL_COUNT;
+	     tok = strtok_r(NULL, "\t\r\n]", &save)) {
+		cols[n] = strtoll(tok, &end, 10);
+		/* The header line, or something else */
+		if (end == tok)
+			return 0;
+		n++;
+	}
+
+	return n;
+}
+
+static void print_help(const char *cmd)
+{
+	int i;
+
+	printf("Usage: %s [options] <thermallog capture, or - for stdin>\n"
+	       "\n"
+	       "Replays the temperatures and power limits of a Lotus\n"
+	       "'thermallog en' capture through the predictive PI fan\n"
+	       "controller and compares its fan speeds with the captured\n"
+	       "ones.\n"
+	       "\n"
+	       "  --kp N, --ki N        PI gains, %d is 1.0 (%d, %d)\n"
+	       "  --ff N                Feed forward, 0.001%% per W (%d)\n"
+	       "  --slew-up N           Spin up limit, %%/s (%d)\n"
+	       "  --slew-down N         Spin down limit, %%/s (%d)\n"
+	       "  --sensor NAME:OFF:MAX:TAU\n"
+	       "                        Fan off and max temperatures (C) and\n"
+	       "                        time constant (ms) of a sensor\n"
+	       "  --rpm-min N, --rpm-max N\n"
+	       "                        Fan speed range (%d, %d)\n"
+	       "  -v, --verbose         Print every sample\n"
+	       "\n"
+	       "Sensors:",
+	       cmd, FAN_PI_GAIN_ONE, cfg.kp, cfg.ki, cfg.ff_per_w, cfg.slew_up,
+	       cfg.slew_down, rpm_min, rpm_max);
+	for (i = 0; i < S_COUNT; i++)
+		printf(" %s:%d:%d:%d", sensor_names[i], temp_off_c[i],
+		       temp_max_c[i], tau_ms[i]);
+	printf("\n");
+}
+
+static int parse_sensor(const char *arg)
+{
+	char name[16];
+	int off, max, tau, i;
+
+	if (sscanf(arg, "%15[^:]:%d:%d:%d", name, &off, &max, &tau) != 4 ||
+	    off >= max || tau < 0)
+		return -1;
+
+	for (i = 0; i < S_COUNT; i++) {
+		if (!strcmp(name, sensor_names[i])) {
+			temp_off_c[i] = off;
+			temp_max_c[i] = max;
+			tau_ms[i] = tau;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+enum {
+	OPT_KP = 256,
+	OPT_KI,
+	OPT_FF,
+	OPT_SLEW_UP,
+	OPT_SLEW_DOWN,
+	OPT_SENSOR,
+	OPT_RPM_MIN,
+	OPT_RPM_MAX,
+};
+
+static const struct option opts[] = {
+	{ "kp", 1, 0, OPT_KP },
+	{ "ki", 1, 0, OPT_KI },
+	{ "ff", 1, 0, OPT_FF },
+	{ "slew-up", 1, 0, OPT_SLEW_UP },
+	{ "slew-down", 1, 0, OPT_SLEW_DOWN },
+	{ "sensor", 1, 0, OPT_SENSOR },
+	{ "rpm-min", 1, 0, OPT_RPM_MIN },
+	{ "rpm-max", 1, 0, OPT_RPM_MAX },
+	{ "verbose", 0, 0, 'v' },
+	{ "help", 0, 0, 'h' },
+	{ NULL, 0, 0, 0 },
+};
+
+static void print_row(const char *name, long long captured, long long replay)
+{
+	printf("%-20s %10lld %10lld\n", name, captured, replay);
+}
+
+int main(int argc, char *argv[])
+{
+	struct fan_pi_state state;
+	struct fan_stats captured = { 0 }, replay = { 0 };
+	long long cols[COL_COUNT];
+	long long time_us = 0, last_us = -1, elapsed_ms = 0, hot_ms = 0;
+	int temps_mk[S_COUNT];
+	int samples = 0, hot_samples = 0;
+	int i, n, dt_ms, hot, power_mw, out, pct, rpm;
+	char line[512];
+	FILE *f;
+
+	while ((i = getopt_long(argc, argv, "vh", opts, NULL)) != -1) {
+		switch (i) {
+		case OPT_KP:
+			cfg.kp = atoi(optarg);
+			break;
+		case OPT_KI:
+			cfg.ki = atoi(optarg);
+			break;
+		case OPT_FF:
+			cfg.ff_per_w = atoi(optarg);
+			break;
+		case OPT_SLEW_UP:
+			cfg.slew_up = atoi(optarg);
+			break;
+		case OPT_SLEW_DOWN:
+			cfg.slew_down = atoi(optarg);
+			break;
+		case OPT_SENSOR:
+			if (parse_sensor(optarg)) {
+				fprintf(stderr, "Bad sensor '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case OPT_RPM_MIN:
+			rpm_min = atoi(optarg);
+			break;
+		case OPT_RPM_MAX:
+			rpm_max = atoi(optarg);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		case 'h':
+			print_help(argv[0]);
+			return 0;
+		default:
+			print_help(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc - 1) {
+		print_help(argv[0]);
+		return 1;
+	}
+	if (!strcmp(argv[optind], "-")) {
+		f = stdin;
+	} else {
+		f = fopen(argv[optind], "r");
+		if (!f) {
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+
+	/* Set points halfway, as lotus/src/thermal.c does */
+	for (i = 0; i < S_COUNT; i++) {
+		sensors[i].temp_off_mk = (temp_off_c[i] + 273) * 1000;
+		sensors[i].temp_max_mk = (temp_max_c[i] + 273) * 1000;
+		sensors[i].temp_target_mk =
+			(sensors[i].temp_off_mk + sensors[i].temp_max_mk) / 2;
+		sensors[i].tau_ms = tau_ms[i];
+	}
+	fan_pi_reset(&state);
+
+	if (verbose)
+		printf("time\tRPM\tPI%%\tPI_RPM\thot\n");
+
+	while (fgets(line, sizeof(line), f)) {
+		n = parse_line(line, cols, &time_us);
+		if (n < COL_REQUIRED)
+			continue;
+
+		/* Without timestamps, assume the 1s thermal period. */
+		if (last_us < 0 || time_us <= last_us)
+			dt_ms = 1000;
+		else
+			dt_ms = (time_us - last_us) / 1000;
+		last_us = time_us;
+
+		temps_mk[S_APU] = cols[COL_APU_MK];
+		temps_mk[S_APU_DIE] = (cols[COL_APU_DIE_C] + 273) * 1000;
+		temps_mk[S_GPU_VR] = cols[COL_GPU_VR_MK];
+		temps_mk[S_GPU_DIE] = (cols[COL_GPU_DIE_C] + 273) * 1000;
+
+		hot = 0;
+		for (i = 0; i < S_COUNT; i++)
+			hot |= temps_mk[i] > sensors[i].temp_max_mk;
+
+		/* Older captures have no power limits: no feed forward. */
+		power_mw = 0;
+		if (n > COL_GPU_MW)
+			power_mw = cols[COL_APU_MW] + cols[COL_GPU_MW];
+
+		out = fan_pi_update(&cfg, &state, temps_mk, power_mw, dt_ms);
+		pct = (out + 999) / 1000;
+		rpm = percent_to_rpm(pct);
+
+		stats_add(&captured, cols[COL_RPM], dt_ms, hot, !samples);
+		stats_add(&replay, rpm, dt_ms, hot, !samples);
+		samples++;
+		if (samples > 1)
+			elapsed_ms += dt_ms;
+		if (hot) {
+			hot_samples++;
+			hot_ms += dt_ms;
+		}
+
+		if (verbose)
+			printf("%lld.%03lld\t%lld\t%d\t%d\t%d\n",
+			       time_us / 1000000, time_us / 1000 % 1000,
+			       cols[COL_RPM], pct, rpm, hot);
+	}
+
+	if (f != stdin)
+		fclose(f);
+
+	if (!samples) {
+		fprintf(stderr, "No thermallog lines found\n");
+		return 1;
+	}
+
+	printf("%d samples over %llds, %llds with a sensor above its max\n",
+	       samples, elapsed_ms / 1000, hot_ms / 1000);
+	printf("%-20s %10s %10s\n", "", "captured", "replay");
+	print_row("mean RPM", captured.rpm_sum / samples,
+		  replay.rpm_sum / samples);
+	if (hot_samples)
+		print_row("mean RPM when hot",
+			  captured.hot_rpm_sum / hot_samples,
+			  replay.hot_rpm_sum / hot_samples);
+	print_row("RPM travel", captured.travel, replay.travel);
+	print_row("max RPM/s", captured.max_slew, replay.max_slew);
+	print_row("reversals", captured.reversals, replay.reversals);
+	print_row("fan starts", captured.starts, replay.starts);
+
+	return 0;
+}
@@ -458,4 +458,11 @@ enum battery_extender_cmd {
 	BATT_EXTENDER_READ_CMD,
 };
 
+/*****************************************************************************/
+/*
+ * Notify the EC that the host wrote a UCSI command to the memmap and set
+ * UCSI_EVENT. Once the host sends this, the EC stops polling the flag.
+ */
+#define EC_CMD_UCSI_NOTIFY	0x3E25
+
 #endif /* __BOARD_HOST_COMMAND_H */
@@ -232,8 +232,7 @@ enum pd_task_evt {
 	CCG_EVT_AC_PRESENT =  BIT(4),
 	CCG_EVT_S_CHANGE = BIT(5),
 	CCG_EVT_PLT_RESET = BIT(6),
-	CCG_EVT_UCSI_POLL_CTRL_0 = BIT(7),
-	CCG_EVT_UCSI_POLL_CTRL_1 = BIT(8),
+	CCG_EVT_UCSI_POLL = BIT(7),
 	CCG_EVT_RETIMER_PWR = BIT(9),
 	CCG_EVT_UPDATE_PWRSTAT = BIT(10),
 	CCG_EVT_PORT_ENABLE = BIT(11),
@@ -2,28 +2,25 @@
  * Use of this source code is governed by a BSD-style license that can be
  * found in the LICENSE file.
  *
- * Low pass filter for on die temperature
+ * Low pass filter for the temperature sensors
  */
 #ifndef __CROS_EC_TEMPERATURE_FILTER_H
 #define __CROS_EC_TEMPERATURE_FILTER_H
 
-#include "util.h"
-#include "math_util.h"
-
-#define Q_SCALE 14
-/* scale input up to improve filter performance */
-#define IN_SCALE 7
-
-struct biquad {
-	/* State values x[n-1], x[n-2], y[n-1], y[n-2] */
-	int32_t state[4];
-	const int32_t *coeff;
-};
-
-void thermal_filter_reset(struct biquad *filter);
+/*
+ * Restart the filters from the next readings, e.g. after the sensors were
+ * powered off.
+ */
+void thermal_filter_reset(void);
 
-int thermal_filter_update(struct biquad *filter, int value);
+/*
+ * Read every temperature sensor and filter the readings (degrees C), indexed
+ * by TEMP_SENSOR_ID(). A sensor that can't be read keeps its last output.
+ * Sensors without filter-coefficients in the devicetree are passed through.
+ */
+void thermal_filter_update(void);
 
-int thermal_filter_get(struct biquad *filter);
+/* Filtered temperature of a sensor, in degrees C */
+int thermal_filter_get(int sensor);
 
 #endif /* __CROS_EC_TEMPERATURE_FILTER_H */
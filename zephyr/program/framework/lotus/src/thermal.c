@@ -6,6 +6,7 @@
 #include "amd_stt.h"
 #include "chipset.h"
 #include "common.h"
+#include "common_cpu_power.h"
 #include "console.h"
 #include "fan.h"
 #include "gpu.h"
@@ -16,6 +17,7 @@
 #include "util.h"
 #include "gpu_configuration.h"
 #include "temperature_filter.h"
+#include "fan_pi.h"
 
 #include "temp_sensor/f75303.h"
 
@@ -28,26 +30,18 @@ uint16_t board_fan_min[2];
 #define FAN_STOP_DELAY_S (5 * SECOND)
 
 
-/*coeff in the form b0, b1, b2, A0, a1, a2 note: drop a0*/
-/* 1590,-3130,1590,-31527,15193,14 */
-/* */
-const int32_t gpu_coeff[6] = {
-	59, 119,  59, 16384, -29863, 13716
-};
-const int32_t apu_coeff[6] = {
-	34, 68, 34, 16384, -30587, 14340
-};
-struct biquad gpu_filtered = {
-	.coeff = gpu_coeff,
-};
-struct biquad apu_filtered = {
-	.coeff = apu_coeff,
-};
+#ifdef CONFIG_FAN_PI
+static struct fan_pi_state pi_state;
+static timestamp_t pi_last;
+#endif
 
 static void board_temperature_reset(void)
 {
-	thermal_filter_reset(&gpu_filtered);
-	thermal_filter_reset(&apu_filtered);
+	thermal_filter_reset();
+#ifdef CONFIG_FAN_PI
+	fan_pi_reset(&pi_state);
+	pi_last.val = 0;
+#endif
 }
 
 DECLARE_HOOK(HOOK_CHIPSET_RESUME, board_temperature_reset, HOOK_PRIO_DEFAULT);
@@ -125,6 +119,107 @@ bool log_thermal;
 #define TEMP_GPU TEMP_SENSOR_ID(DT_NODELABEL(temp_sensor_gpu))
 #define TEMP_GPU_DIE TEMP_SENSOR_ID(DT_NODELABEL(temp_sensor_gpu_die))
 #define TEMP_APU_DIE TEMP_SENSOR_ID(DT_NODELABEL(temp_sensor_apu_die))
+
+/*
+ * Power the APU and GPU may draw now. With the GPU on, SPPT is shared
+ * between the two and the APU is held to its APU only SPPT.
+ */
+static void board_get_power_limits(int *apu_mw, int *gpu_mw)
+{
+	int sppt = power_limit[target_func[TYPE_SPPT]].mwatt[TYPE_SPPT];
+	int apu_only =
+		power_limit[target_func[TYPE_APU_ONLY_SPPT]].mwatt[TYPE_APU_ONLY_SPPT];
+
+	if (gpu_power_enable() && apu_only) {
+		*apu_mw = apu_only;
+		*gpu_mw = MAX(sppt - apu_only, 0);
+	} else {
+		*apu_mw = power_limit[target_func[TYPE_SPL]].mwatt[TYPE_SPL];
+		*gpu_mw = 0;
+	}
+}
+
+#ifdef CONFIG_FAN_PI
+enum pi_sensor {
+	PI_APU,
+	PI_APU_DIE,
+	PI_GPU_VR,
+	PI_GPU_DIE,
+	PI_COUNT,
+};
+
+static const int pi_temp_sensor[PI_COUNT] = {
+	[PI_APU] = TEMP_APU,
+	[PI_APU_DIE] = TEMP_APU_DIE,
+	[PI_GPU_VR] = TEMP_GPU,
+	[PI_GPU_DIE] = TEMP_GPU_DIE,
+};
+
+/*
+ * The dies follow the load within seconds, the board sensors lag behind
+ * them by the heatpipe and VR thermal mass.
+ */
+static const int pi_tau_ms[PI_COUNT] = {
+	[PI_APU] = 30000,
+	[PI_APU_DIE] = 5000,
+	[PI_GPU_VR] = 40000,
+	[PI_GPU_DIE] = 5000,
+};
+
+static struct fan_pi_sensor pi_sensors[PI_COUNT];
+
+static const struct fan_pi_config pi_config = {
+	.sensors = pi_sensors,
+	.num_sensors = PI_COUNT,
+	/* Full speed from the set point to temp_fan_max */
+	.kp = 2 * FAN_PI_GAIN_ONE,
+	.ki = FAN_PI_GAIN_ONE / 32,
+	.ff_per_w = 400,
+	/* Spin up over 10s, spin down over 50s */
+	.slew_up = 10,
+	.slew_down = 2,
+};
+
+/*
+ * Fan percent from the PI controller, run once per thermal period for both
+ * fans. The set point of each sensor is halfway between temp_fan_off and
+ * temp_fan_max, so the host tables still tune it.
+ */
+static int board_fan_pi_percent(int *temp, int apu_temp_mk, int gpu_temp_mk,
+				int power_mw)
+{
+	int temps_mk[PI_COUNT];
+	timestamp_t now = get_time();
+	int dt_ms = pi_last.val ? (now.val - pi_last.val) / MSEC : 1000;
+	int i;
+
+	temps_mk[PI_APU] = apu_temp_mk;
+	temps_mk[PI_APU_DIE] = C_TO_K(temp[TEMP_APU_DIE]) * 1000;
+	temps_mk[PI_GPU_VR] = gpu_power_enable() ? gpu_temp_mk : 0;
+	temps_mk[PI_GPU_DIE] =
+		gpu_power_enable() ? C_TO_K(temp[TEMP_GPU_DIE]) * 1000 : 0;
+
+	for (i = 0; i < PI_COUNT; i++) {
+		const struct ec_thermal_config *p =
+			&thermal_params[pi_temp_sensor[i]];
+
+		if (!p->temp_fan_off || !p->temp_fan_max) {
+			temps_mk[i] = 0;
+			continue;
+		}
+		pi_sensors[i].temp_off_mk = p->temp_fan_off * 1000;
+		pi_sensors[i].temp_max_mk = p->temp_fan_max * 1000;
+		pi_sensors[i].temp_target_mk =
+			(p->temp_fan_off + p->temp_fan_max) * 1000 / 2;
+		pi_sensors[i].tau_ms = pi_tau_ms[i];
+	}
+
+	pi_last = now;
+	return DIV_ROUND_UP(fan_pi_update(&pi_config, &pi_state, temps_mk,
+					  power_mw, dt_ms), 1000);
+}
+#endif /* CONFIG_FAN_PI */
+
 void board_override_fan_control(int fan, int *temp)
 {
 	int actual_rpm, new_rpm;
@@ -145,6 +240,8 @@ void board_override_fan_control(int fan, int *temp)
 	int apu_filtered_temp = 0;
 	int apu_filtered_pct = 0;
 	int temps_mk[5];
+	int apu_power_mw, gpu_power_mw;
+	static int pi_pct;
 
 	static timestamp_t deadline;
 	timestamp_t now = get_time();
@@ -176,12 +273,11 @@ void board_override_fan_control(int fan, int *temp)
 						apu_temp_mk);
 		}
 
-		if (fan == 0) {
-			thermal_filter_update(&gpu_filtered, temp[TEMP_GPU_DIE]);
-			thermal_filter_update(&apu_filtered, temp[TEMP_APU_DIE]);
-		}
+		/* The die filters are set in the devicetree. */
+		if (fan == 0)
+			thermal_filter_update();
 
-		apu_filtered_temp = thermal_filter_get(&apu_filtered);
+		apu_filtered_temp = thermal_filter_get(TEMP_APU_DIE);
 		if (thermal_params[TEMP_APU_DIE].temp_fan_off &&
 			thermal_params[TEMP_APU_DIE].temp_fan_max) {
 			apu_filtered_pct = thermal_fan_percent(thermal_params[TEMP_APU_DIE].temp_fan_off*1000,
@@ -189,7 +285,7 @@ void board_override_fan_control(int fan, int *temp)
 						C_TO_K(apu_filtered_temp)*1000);
 		}
 
-		gpu_filtered_temp = thermal_filter_get(&gpu_filtered);
+		gpu_filtered_temp = thermal_filter_get(TEMP_GPU_DIE);
 		if (thermal_params[TEMP_GPU_DIE].temp_fan_off &&
 			thermal_params[TEMP_GPU_DIE].temp_fan_max) {
 			gpu_filtered_pct = thermal_fan_percent(thermal_params[TEMP_GPU_DIE].temp_fan_off*1000,
@@ -232,6 +328,16 @@ void board_override_fan_control(int fan, int *temp)
 		}
 #endif
 
+		board_get_power_limits(&apu_power_mw, &gpu_power_mw);
+#ifdef CONFIG_FAN_PI
+		/* The legacy percentages above are kept for the log. */
+		if (fan == 0)
+			pi_pct = board_fan_pi_percent(temp, apu_temp_mk,
+						      gpu_temp_mk,
+						      apu_power_mw + gpu_power_mw);
+		pct = pi_pct;
+#endif
+
 		new_rpm = fan_percent_to_rpm(fan, pct);
 		actual_rpm = fan_get_rpm_actual(FAN_CH(fan));
 
@@ -269,13 +375,14 @@ void board_override_fan_control(int fan, int *temp)
 			f75303_get_val_mk(
 				F75303_SENSOR_ID(DT_NODELABEL(apu_f75303)),
 				&temps_mk[2]);
-			CPRINTS("\tThrm\t%d\t%d\t%d\t\t%d\t%d\t\t%d\t%d\t\t%d\t%d\t%d\t%d\t%d\t%d\t%d",
+			CPRINTS("\tThrm\t%d\t%d\t%d\t\t%d\t%d\t\t%d\t%d\t\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t\t%d\t%d\t%d",
 				temps_mk[0], temps_mk[1], temps_mk[2],
 				temp[TEMP_GPU_DIE], temp[TEMP_APU_DIE],
-				thermal_filter_get(&gpu_filtered),
-				thermal_filter_get(&apu_filtered),
+				thermal_filter_get(TEMP_GPU_DIE),
+				thermal_filter_get(TEMP_APU_DIE),
 				pct, gpu_pct, gpu_filtered_pct, apu_pct, apu_filtered_pct,
-				new_rpm, actual_rpm);
+				new_rpm, actual_rpm,
+				apu_power_mw, gpu_power_mw, pi_pct);
 		}
 		fan_set_rpm_mode(fan, 1);
 		fan_set_rpm_target(FAN_CH(fan), new_rpm);
@@ -294,7 +401,7 @@ static int thermallog_cmd(int argc, const char **argv)
 	if (argc >= 2) {
 		if (!strncmp(argv[1], "en", 2)) {
 			log_thermal = true;
-			CPRINTS("\tThrm\tG_VR\tG_RM\tAPU\t\tG_D\tA_D\t\tG_f\tA_f\t\tPCT\tGpct\tGfilt\tApct\tAfilt\tRPM\tFAN");
+			CPRINTS("\tThrm\tG_VR\tG_RM\tAPU\t\tG_D\tA_D\t\tG_f\tA_f\t\tPCT\tGpct\tGfilt\tApct\tAfilt\tRPM\tFAN\t\tAPUW\tGPUW\tPI");
 		} else if (!strncmp(argv[1], "dis", 3)) {
 			log_thermal = false;
 		} else {
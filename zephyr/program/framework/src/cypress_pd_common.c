@@ -43,6 +43,11 @@
 #define PRODUCT_ID	0x0001
 #define VENDOR_ID	0x32ac
 
+/* Retry period while a controller doesn't answer after power on */
+#define CCG_POWER_ON_POLL	(5 * MSEC)
+/* Time for a controller to release its interrupt pin once cleared */
+#define CCG_INT_RECHECK_DELAY	50
+
 /*
  * Unimplemented functions:
  * 1. Control port current 3A/1.5A for GRL test.
@@ -100,6 +105,7 @@ static uint8_t pd_epr_in_progress;
 static void cypd_update_port_state(int controller, int port);
 static void cypd_pdo_reset_deferred(void);
 static void cypd_set_prepare_pdo(int controller, int port);
+static void cypd_shadow_invalidate(int controller, int reg);
 
 int cypd_write_reg_block(int controller, int reg, void *data, int len)
 {
@@ -110,6 +116,7 @@ int cypd_write_reg_block(int controller, int reg, void *data, int len)
 	rv = i2c_write_offset16_block(i2c_port, addr_flags, reg, data, len);
 	if (rv != EC_SUCCESS)
 		CPRINTS("%s failed: ctrl=0x%x, reg=0x%02x", __func__, controller, reg);
+	cypd_shadow_invalidate(controller, reg);
 	return rv;
 }
 
@@ -122,6 +129,7 @@ static int cypd_write_reg16(int controller, int reg, int data)
 	rv = i2c_write_offset16(i2c_port, addr_flags, reg, data, 2);
 	if (rv != EC_SUCCESS)
 		CPRINTS("%s failed: ctrl=0x%x, reg=0x%02x", __func__, controller, reg);
+	cypd_shadow_invalidate(controller, reg);
 	return rv;
 }
 
@@ -134,6 +142,7 @@ int cypd_write_reg8(int controller, int reg, int data)
 	rv = i2c_write_offset16(i2c_port, addr_flags, reg, data, 1);
 	if (rv != EC_SUCCESS)
 		CPRINTS("%s failed: ctrl=0x%x, reg=0x%02x", __func__, controller, reg);
+	cypd_shadow_invalidate(controller, reg);
 	return rv;
 }
 
@@ -173,6 +182,87 @@ static int cypd_read_reg8(int controller, int reg, int *data)
 	return rv;
 }
 
+/*
+ * Shadow of the port status registers, which only change along with a port
+ * event. cypd_read_shadow() serves them from RAM until an interrupt cause
+ * bit from cypd_get_int() or a write to the controller invalidates them.
+ * A miss reads the whole window holding them in one transaction.
+ */
+#define CCG_SHADOW_BASE(port)	CCG_PD_STATUS_REG(port)
+#define CCG_SHADOW_SIZE		(CCG_CURRENT_RDO_REG(0) + 4 - CCG_PD_STATUS_REG(0))
+/* Address and offset bytes that a register read adds on the bus */
+#define CCG_I2C_READ_OVERHEAD	4
+
+static const struct {
+	int offset;
+	int len;
+} cypd_shadow_regs[] = {
+	{ CCG_PD_STATUS_REG(0) - CCG_SHADOW_BASE(0), 4 },
+	{ CCG_TYPE_C_STATUS_REG(0) - CCG_SHADOW_BASE(0), 1 },
+	{ CCG_CURRENT_PDO_REG(0) - CCG_SHADOW_BASE(0), 4 },
+	{ CCG_CURRENT_RDO_REG(0) - CCG_SHADOW_BASE(0), 4 },
+};
+
+static struct {
+	uint8_t data[CCG_SHADOW_SIZE];
+	bool valid;
+} cypd_shadow[PD_CHIP_COUNT][2];
+
+static struct {
+	uint32_t hits;
+	uint32_t misses;
+	/* Bus bytes of the reads served from RAM, less the window reads */
+	int32_t bytes_saved;
+} cypd_shadow_stats;
+
+static void cypd_shadow_invalidate_port(int controller, int port)
+{
+	cypd_shadow[controller][port].valid = false;
+}
+
+static void cypd_shadow_invalidate(int controller, int reg)
+{
+	/* Clearing an interrupt changes nothing we keep */
+	if (reg == CCG_INTR_REG)
+		return;
+
+	cypd_shadow_invalidate_port(controller, 0);
+	cypd_shadow_invalidate_port(controller, 1);
+}
+
+static int cypd_read_shadow(int controller, int port, int reg, void *data,
+			    int len)
+{
+	int offset = reg - CCG_SHADOW_BASE(port);
+	int rv;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cypd_shadow_regs); i++) {
+		if (cypd_shadow_regs[i].offset == offset &&
+		    cypd_shadow_regs[i].len == len)
+			break;
+	}
+	if (i == ARRAY_SIZE(cypd_shadow_regs))
+		return cypd_read_reg_block(controller, reg, data, len);
+
+	if (cypd_shadow[controller][port].valid) {
+		cypd_shadow_stats.hits++;
+		cypd_shadow_stats.bytes_saved += len + CCG_I2C_READ_OVERHEAD;
+	} else {
+		rv = cypd_read_reg_block(controller, CCG_SHADOW_BASE(port),
+					 cypd_shadow[controller][port].data,
+					 CCG_SHADOW_SIZE);
+		if (rv != EC_SUCCESS)
+			return rv;
+		cypd_shadow[controller][port].valid = true;
+		cypd_shadow_stats.misses++;
+		cypd_shadow_stats.bytes_saved -= CCG_SHADOW_SIZE - len;
+	}
+
+	memcpy(data, cypd_shadow[controller][port].data + offset, len);
+	return EC_SUCCESS;
+}
+
 static int cypd_reset(int controller)
 {
 	/*
@@ -188,8 +278,16 @@ int cypd_get_int(int controller, int *intreg)
 	int rv;
 
 	rv = cypd_read_reg8(controller, CCG_INTR_REG, intreg);
-	if (rv != EC_SUCCESS)
+	if (rv != EC_SUCCESS) {
 		CPRINTS("%s failed: ctrl=0x%x, rv=0x%02x", __func__, controller, rv);
+		return rv;
+	}
+
+	/* A device event may be a reset, port events change the port status */
+	if (*intreg & (CCG_DEV_INTR | CCG_PORT0_INTR))
+		cypd_shadow_invalidate_port(controller, 0);
+	if (*intreg & (CCG_DEV_INTR | CCG_PORT1_INTR))
+		cypd_shadow_invalidate_port(controller, 1);
 	return rv;
 }
 
@@ -493,6 +591,15 @@ static void pd1_update_state_deferred(void)
 }
 DECLARE_DEFERRED(pd1_update_state_deferred);
 
+/* Run the state machine of a controller again after delay */
+static void cypd_set_state_timer(int controller, int delay)
+{
+	if (controller == 0)
+		hook_call_deferred(&pd0_update_state_deferred_data, delay);
+	else
+		hook_call_deferred(&pd1_update_state_deferred_data, delay);
+}
+
 static void update_power_state_deferred(void)
 {
 	task_set_event(TASK_ID_CYPD, CCG_EVT_UPDATE_PWRSTAT);
@@ -809,7 +916,7 @@ void cypd_set_typec_profile(int controller, int port)
 	int rdo_max_current = 0;
 	int port_idx = (controller << 1) + port;
 
-	rv = cypd_read_reg_block(controller, CCG_PD_STATUS_REG(port), pd_status_reg, 4);
+	rv = cypd_read_shadow(controller, port, CCG_PD_STATUS_REG(port), pd_status_reg, 4);
 	if (rv != EC_SUCCESS)
 		CPRINTS("CYP5525_PD_STATUS_REG failed");
 
@@ -838,7 +945,7 @@ void cypd_set_typec_profile(int controller, int port)
 			 * resend 1.5A pdo to device
 			 */
 
-			cypd_read_reg_block(controller, CCG_CURRENT_RDO_REG(port), rdo_reg, 4);
+			cypd_read_shadow(controller, port, CCG_CURRENT_RDO_REG(port), rdo_reg, 4);
 			rdo_max_current = (((rdo_reg[1]>>2) + (rdo_reg[2]<<6)) & 0x3FF)*10;
 
 			if ((cypd_port_force_3A(controller, port) && !pd_3a_flag) ||
@@ -1198,7 +1305,7 @@ static void cypd_update_port_state(int controller, int port)
 	uint8_t pd_status_reg[4];
 	uint32_t pdo_reg;
 	uint8_t rdo_reg[4];
-	int typec_status_reg;
+	uint8_t typec_status_reg;
 	int pd_current = 0;
 	int pd_voltage = 0;
 	int rdo_max_current = 0;
@@ -1208,7 +1315,7 @@ static void cypd_update_port_state(int controller, int port)
 	int64_t calculate_ma;
 #endif
 
-	rv = cypd_read_reg_block(controller, CCG_PD_STATUS_REG(port), pd_status_reg, 4);
+	rv = cypd_read_shadow(controller, port, CCG_PD_STATUS_REG(port), pd_status_reg, 4);
 	if (rv != EC_SUCCESS)
 		CPRINTS("CCG_PD_STATUS_REG failed");
 	pd_port_states[port_idx].pd_state =
@@ -1222,7 +1329,7 @@ static void cypd_update_port_state(int controller, int port)
 	if (pd_port_states[port_idx].epr_active != 0xff)
 		pd_port_states[port_idx].epr_active = pd_status_reg[2] & BIT(7) ? 1 : 0;
 
-	rv = cypd_read_reg8(controller, CCG_TYPE_C_STATUS_REG(port), &typec_status_reg);
+	rv = cypd_read_shadow(controller, port, CCG_TYPE_C_STATUS_REG(port), &typec_status_reg, 1);
 	if (rv != EC_SUCCESS)
 		CPRINTS("CCG_TYPE_C_STATUS_REG failed");
 
@@ -1243,7 +1350,7 @@ static void cypd_update_port_state(int controller, int port)
 	update_external_cc_mux(port_idx,pd_port_states[port_idx].c_state == CCG_STATUS_NOTHING ? 0xFF : pd_port_states[port_idx].cc);
 #endif
 
-	rv = cypd_read_reg_block(controller, CCG_CURRENT_PDO_REG(port), &pdo_reg, 4);
+	rv = cypd_read_shadow(controller, port, CCG_CURRENT_PDO_REG(port), &pdo_reg, 4);
 	switch (pdo_reg & PDO_TYPE_MASK) {
 		case PDO_TYPE_FIXED:
 			pd_current = PDO_FIXED_CURRENT(pdo_reg);
@@ -1263,7 +1370,7 @@ static void cypd_update_port_state(int controller, int port)
 		break;
 	}
 
-	cypd_read_reg_block(controller, CCG_CURRENT_RDO_REG(port), rdo_reg, 4);
+	cypd_read_shadow(controller, port, CCG_CURRENT_RDO_REG(port), rdo_reg, 4);
 	rdo_max_current = (((rdo_reg[1]>>2) + (rdo_reg[2]<<6)) & 0x3FF)*10;
 
 	/*
@@ -1608,7 +1715,9 @@ static void cypd_handle_state(int controller)
 	switch (pd_chip_config[controller].state) {
 	case CCG_STATE_POWER_ON:
 		/* poll to see if the controller has booted yet */
+		delay = CCG_POWER_ON_POLL;
 		if (cypd_read_reg8(controller, CCG_DEVICE_MODE, &data) == EC_SUCCESS) {
+			delay = 0;
 			if ((data & 0x03) == 0x00) {
 				CPRINTS("CYPD %d is in bootloader 0x%04x", controller, data);
 				delay = 25*MSEC;
@@ -1621,12 +1730,9 @@ static void cypd_handle_state(int controller)
 				pd_chip_config[controller].state = CCG_STATE_APP_SETUP;
 		}
 		/*try again in a while*/
-		if (delay) {
-			if (controller == 0)
-				hook_call_deferred(&pd0_update_state_deferred_data, delay);
-			else
-				hook_call_deferred(&pd1_update_state_deferred_data, delay);
-		} else
+		if (delay)
+			cypd_set_state_timer(controller, delay);
+		else
 			task_set_event(TASK_ID_CYPD, CCG_EVT_STATE_CTRL_0 << controller);
 		break;
 
@@ -2003,16 +2109,71 @@ void cypd_interrupt(int controller)
 	}
 }
 
+/* CYPD task wakeups and interrupt-to-handled latency, see cypdstats */
+static struct {
+	timestamp_t since;
+	uint32_t wakeups;
+	uint32_t int_count[PD_CHIP_COUNT];
+	uint32_t int_latency_min[PD_CHIP_COUNT];
+	uint32_t int_latency_max[PD_CHIP_COUNT];
+	uint64_t int_latency_total[PD_CHIP_COUNT];
+} cypd_stats;
+
+/* When the pending interrupt of each controller was raised, 0 if none */
+static uint64_t cypd_int_time[PD_CHIP_COUNT];
+
+static void cypd_raise_interrupt(int controller)
+{
+	if (!cypd_int_time[controller])
+		cypd_int_time[controller] = get_time().val;
+	task_set_event(TASK_ID_CYPD, CCG_EVT_INT_CTRL_0 << controller);
+}
+
 void pd0_chip_interrupt(enum gpio_signal signal)
 {
 	if (gpio_pin_get_dt(gpio_get_dt_spec(pd_chip_config[PD_CHIP_0].gpio)) == 0)
-		task_set_event(TASK_ID_CYPD, CCG_EVT_INT_CTRL_0);
+		cypd_raise_interrupt(PD_CHIP_0);
 }
 
 void pd1_chip_interrupt(enum gpio_signal signal)
 {
 	if (gpio_pin_get_dt(gpio_get_dt_spec(pd_chip_config[PD_CHIP_1].gpio)) == 0)
-		task_set_event(TASK_ID_CYPD, CCG_EVT_INT_CTRL_1);
+		cypd_raise_interrupt(PD_CHIP_1);
+}
+
+/*
+ * The interrupt pins are edge triggered. A controller that still has an
+ * interrupt pending after we cleared one, or that raised it while its
+ * interrupt was disabled, leaves the pin low without a new edge.
+ */
+static void cypd_int_recheck_deferred(void)
+{
+	int i;
+
+	for (i = 0; i < PD_CHIP_COUNT; i++) {
+		if (gpio_pin_get_dt(gpio_get_dt_spec(pd_chip_config[i].gpio)) == 0)
+			cypd_raise_interrupt(i);
+	}
+}
+DECLARE_DEFERRED(cypd_int_recheck_deferred);
+
+static void cypd_handle_interrupt(int controller)
+{
+	uint32_t latency = 0;
+
+	if (cypd_int_time[controller]) {
+		latency = get_time().val - cypd_int_time[controller];
+		cypd_int_time[controller] = 0;
+	}
+
+	if (!cypd_stats.int_count[controller]++ ||
+	    latency < cypd_stats.int_latency_min[controller])
+		cypd_stats.int_latency_min[controller] = latency;
+	cypd_stats.int_latency_max[controller] =
+		MAX(cypd_stats.int_latency_max[controller], latency);
+	cypd_stats.int_latency_total[controller] += latency;
+
+	cypd_interrupt(controller);
 }
 
 static void cypd_ucsi_wait_delay_deferred(void)
@@ -2051,8 +2212,15 @@ void cypd_interrupt_handler_task(void *p)
 	}
 
 
+	cypd_stats.since = get_time();
+
+	/*
+	 * Everything below is driven by events: the interrupt pins, host
+	 * UCSI writes and the deferred timers of each controller.
+	 */
 	while (1) {
-		evt = task_wait_event(10*MSEC);
+		evt = task_wait_event(-1);
+		cypd_stats.wakeups++;
 
 		if (firmware_update)
 			continue;
@@ -2071,26 +2239,21 @@ void cypd_interrupt_handler_task(void *p)
 			update_system_power_state(2);
 
 		if (evt & CCG_EVT_INT_CTRL_0)
-			cypd_interrupt(0);
+			cypd_handle_interrupt(0);
 
 		if (evt & CCG_EVT_INT_CTRL_1)
-			cypd_interrupt(1);
+			cypd_handle_interrupt(1);
 
-		if (evt & CCG_EVT_STATE_CTRL_0) {
+		if (evt & CCG_EVT_STATE_CTRL_0)
 			cypd_handle_state(0);
-			task_wait_event_mask(TASK_EVENT_TIMER,10);
-		}
 
-		if (evt & CCG_EVT_STATE_CTRL_1) {
+		if (evt & CCG_EVT_STATE_CTRL_1)
 			cypd_handle_state(1);
-			task_wait_event_mask(TASK_EVENT_TIMER,10);
-		}
 
 		if (evt & CCG_EVT_PDO_INIT_0) {
 			/* update new PDO format to select pdo register */
 			cypd_pdo_init(0, 0, CCG_PD_CMD_SET_TYPEC_3A);
 			cypd_pdo_init(1, 0, CCG_PD_CMD_SET_TYPEC_3A);
-			task_wait_event_mask(TASK_EVENT_TIMER, 10);
 			task_set_event(TASK_ID_CYPD, CCG_EVT_PDO_INIT_1);
 		}
 
@@ -2098,7 +2261,6 @@ void cypd_interrupt_handler_task(void *p)
 			/* update new PDO format to select pdo register */
 			cypd_pdo_init(0, 1, CCG_PD_CMD_SET_TYPEC_3A);
 			cypd_pdo_init(1, 1, CCG_PD_CMD_SET_TYPEC_3A);
-			task_wait_event_mask(TASK_EVENT_TIMER, 10);
 		}
 
 		if (evt & CCG_EVT_DPALT_DISABLE) {
@@ -2125,20 +2287,18 @@ void cypd_interrupt_handler_task(void *p)
 					CCG_EVT_STATE_CTRL_0 | CCG_EVT_STATE_CTRL_1)) {
 			/*
 			 * If we just processed an event or sent some commands
-			 * wait a bit for the pd controller to clear any pending
-			 * interrupt requests
+			 * give the pd controller a bit to clear any pending
+			 * interrupt requests, then look at the pins again
 			 */
-			usleep(50);
+			hook_call_deferred(&cypd_int_recheck_deferred_data,
+					   CCG_INT_RECHECK_DELAY);
 		}
-		if (!ucsi_tunnel_disabled)
-			check_ucsi_event_from_host();
 
-		for (i = 0; i < PD_CHIP_COUNT; i++) {
-			const struct gpio_dt_spec *intr = gpio_get_dt_spec(pd_chip_config[i].gpio);
-			if (gpio_pin_get_dt(intr) == 0) {
-				task_set_event(TASK_ID_CYPD, 1<<i);
-			}
-		}
+		/* UCSI responses arrive with the controller interrupts */
+		if (!ucsi_tunnel_disabled &&
+		    (evt & (CCG_EVT_UCSI_POLL | CCG_EVT_INT_CTRL_0 |
+			    CCG_EVT_INT_CTRL_1)))
+			check_ucsi_event_from_host();
 	}
 }
 
@@ -2262,6 +2422,10 @@ int get_active_charge_pd_port(void)
 void set_pd_fw_update(bool is_update)
 {
 	firmware_update = is_update;
+
+	/* Pick up the interrupts ignored during the update */
+	if (!is_update)
+		hook_call_deferred(&cypd_int_recheck_deferred_data, 0);
 }
 
 void cypd_reinitialize(void)
@@ -2406,6 +2570,45 @@ static int cmd_cypd_get_status(int argc, const char **argv)
 DECLARE_CONSOLE_COMMAND(cypdstatus, cmd_cypd_get_status, "[number]",
 			"Get Cypress PD controller status");
 
+static int cmd_cypd_stats(int argc, const char **argv)
+{
+	int i;
+	uint64_t elapsed;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "reset"))
+			return EC_ERROR_PARAM1;
+		memset(&cypd_stats, 0, sizeof(cypd_stats));
+		memset(&cypd_shadow_stats, 0, sizeof(cypd_shadow_stats));
+		cypd_stats.since = get_time();
+		return EC_SUCCESS;
+	}
+
+	elapsed = get_time().val - cypd_stats.since.val;
+	ccprintf("Wakeups: %u in %llu ms, %u per second\n",
+		 cypd_stats.wakeups, elapsed / MSEC,
+		 elapsed ? (uint32_t)((uint64_t)cypd_stats.wakeups * SECOND /
+				      elapsed) : 0);
+
+	for (i = 0; i < PD_CHIP_COUNT; i++) {
+		uint32_t count = cypd_stats.int_count[i];
+
+		ccprintf("C%d interrupts: %u, latency us min %u avg %u max %u\n",
+			 i, count, cypd_stats.int_latency_min[i],
+			 count ? (uint32_t)(cypd_stats.int_latency_total[i] /
+					    count) : 0,
+			 cypd_stats.int_latency_max[i]);
+	}
+
+	ccprintf("Shadow registers: %u hits, %u misses, %d I2C bytes saved\n",
+		 cypd_shadow_stats.hits, cypd_shadow_stats.misses,
+		 cypd_shadow_stats.bytes_saved);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(cypdstats, cmd_cypd_stats, "[reset]",
+			"Show CYPD task wakeups, interrupt latency and shadow hits");
+
 static int cmd_cypd_control(int argc, const char **argv)
 {
 	int i, enable;
@@ -1,56 +1,71 @@
+/* Copyright 2022 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
 
-#include <zephyr/device.h>
-#include <zephyr/drivers/emul.h>
-#include <zephyr/drivers/i2c.h>
-#include <zephyr/drivers/i2c_emul.h>
-#include <zephyr/logging/log.h>
-#include <zephyr/sys/slist.h>
+#include <zephyr/devicetree.h>
 #include <zephyr/sys/util.h>
 
+#include "biquad_bank.h"
+#include "common.h"
+#include "hooks.h"
+#include "temp_sensor/temp_sensor.h"
 
+#include "temperature_filter.h"
 
-#include <zephyr/sys/util.h>
-#include <zephyr/kernel.h>
-#include <errno.h>
-#include <string.h>
-#include <zephyr/drivers/gpio.h>
+/* Devicetree cells are unsigned, the negative coefficients wrap back. */
+#define COEFF(node_id, i) ((int16_t)DT_PROP_BY_IDX(node_id, filter_coefficients, i))
 
+#define FILTER_COEFF(node_id)                                   \
+	[TEMP_SENSOR_ID(node_id)] = COND_CODE_1(                \
+		DT_NODE_HAS_PROP(node_id, filter_coefficients), \
+		({                                              \
+			.b0 = COEFF(node_id, 0),                \
+			.b1 = COEFF(node_id, 1),                \
+			.b2 = COEFF(node_id, 2),                \
+			.a1 = COEFF(node_id, 3),                \
+			.a2 = COEFF(node_id, 4),                \
+		}),                                             \
+		(BIQUAD_COEFF_PASS))
 
-#include "console.h"
-#include "zephyr_console_shim.h"
-#include "i2c_hid.h"
-#include "hooks.h"
-#include "host_command.h"
-#include "util.h"
-#include "math_util.h"
+static const struct biquad_coeff filter_coeff[TEMP_SENSOR_COUNT] = {
+	DT_FOREACH_CHILD_SEP(TEMP_SENSORS_NODEID, FILTER_COEFF, (, ))
+};
 
-#include "temperature_filter.h"
+BIQUAD_BANK_DEFINE(temp_filter, TEMP_SENSOR_COUNT);
 
+static void thermal_filter_init(void)
+{
+	int i;
 
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++)
+		biquad_bank_set(&temp_filter, i, &filter_coeff[i]);
+}
+DECLARE_HOOK(HOOK_INIT, thermal_filter_init, HOOK_PRIO_DEFAULT);
 
-void thermal_filter_reset(struct biquad *filter)
+void thermal_filter_reset(void)
 {
-	memset(&filter->state, 30 << IN_SCALE, sizeof(filter->state));
+	biquad_bank_reset(&temp_filter);
 }
 
-int thermal_filter_update(struct biquad *filter, int value)
+void thermal_filter_update(void)
 {
-	int out_scaled =
-		filter->coeff[0] * (value << IN_SCALE) +
-		filter->coeff[1] * filter->state[0] +
-		filter->coeff[2] * filter->state[1] -
-		filter->coeff[4] * filter->state[2] -
-		filter->coeff[5] * filter->state[3];
-	int out = out_scaled >> Q_SCALE;
-	/* update delay line */
-	filter->state[1] = filter->state[0];
-	filter->state[3] = filter->state[2];
-	filter->state[0] = value << IN_SCALE;
-	filter->state[2] = out;
-	return out >> IN_SCALE;
+	int temp[TEMP_SENSOR_COUNT];
+	uint32_t valid = 0;
+	int i, t;
+
+	/* Sensors which can't be read keep their filter state. */
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++) {
+		if (temp_sensor_read(i, &t) != EC_SUCCESS)
+			continue;
+		temp[i] = K_TO_C(t);
+		valid |= BIT(i);
+	}
+
+	biquad_bank_update(&temp_filter, temp, valid);
 }
 
-int thermal_filter_get(struct biquad *filter)
+int thermal_filter_get(int sensor)
 {
-	return filter->state[2] >> IN_SCALE;
+	return biquad_bank_get(&temp_filter, sensor);
 }
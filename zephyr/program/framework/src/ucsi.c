@@ -8,6 +8,7 @@
  */
 
 #include <atomic.h>
+#include "board_host_command.h"
 #include "chipset.h"
 #include "config.h"
 #include "customized_shared_memory.h"
@@ -15,6 +16,7 @@
 #include "timer.h"
 #include "ucsi.h"
 #include "hooks.h"
+#include "host_command.h"
 #include "string.h"
 #include "console.h"
 #include "task.h"
@@ -32,6 +34,32 @@
 #define CCI_ERROR_FLAG BIT(30)
 #define CCI_COMPLETE_FLAG BIT(31)
 
+/* How often to look at UCSI_EVENT for hosts that don't send UCSI_NOTIFY */
+#define UCSI_HOST_POLL_INTERVAL (10 * MSEC)
+
+/* CCI, CONTROL and MESSAGE_IN are adjacent, so one read gets all of them */
+struct ucsi_read_block {
+	uint32_t cci;
+	struct ucsi_control_t control;
+	uint8_t message_in[16];
+} __packed;
+BUILD_ASSERT(offsetof(struct ucsi_read_block, message_in) ==
+	     CCG_MESSAGE_IN_REG - CCG_CCI_REG);
+
+/*
+ * Round trip latency of each UCSI command, from writing it to the PD chip
+ * to handing the response to the host. Bucket i counts the commands that
+ * took less than UCSI_LATENCY_BUCKET_MIN << i us, the last one the rest.
+ */
+#define UCSI_LATENCY_BUCKETS 8
+#define UCSI_LATENCY_BUCKET_MIN 250
+#define UCSI_COMMAND_COUNT (UCSI_CMD_GET_ERROR_STATUS + 1)
+
+static uint16_t ucsi_latency_hist[UCSI_COMMAND_COUNT][UCSI_LATENCY_BUCKETS];
+/* Command waiting for its response, UCSI_COMMAND_COUNT if none */
+static uint8_t ucsi_pending_command = UCSI_COMMAND_COUNT;
+static timestamp_t ucsi_command_time;
+
 static struct pd_chip_ucsi_info_t pd_chip_ucsi_info[] = {
 	[PD_CHIP_0] = {
 
@@ -52,13 +80,62 @@ void ucsi_set_debug(bool enable)
 
 timestamp_t ucsi_wait_time;
 
+/* Set once the host notifies us of UCSI_EVENT writes with a host command */
+static bool ucsi_host_notify;
+
+static void ucsi_poll_deferred(void)
+{
+	task_set_event(TASK_ID_CYPD, CCG_EVT_UCSI_POLL);
+
+	/*
+	 * Older BIOSes only write the memmap flag, which raises no interrupt,
+	 * so keep looking at it while the host is running. Suspend, S0ix and
+	 * off need no polling since the flag is ignored there anyway.
+	 */
+	if (!ucsi_host_notify && chipset_in_state(CHIPSET_STATE_ON))
+		hook_call_deferred(&ucsi_poll_deferred_data,
+				   UCSI_HOST_POLL_INTERVAL);
+}
+DECLARE_DEFERRED(ucsi_poll_deferred);
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, ucsi_poll_deferred, HOOK_PRIO_DEFAULT);
+
+static void ucsi_poll_init(void)
+{
+	/*
+	 * After an EC reset or sysjump with the AP already running there is
+	 * no resume hook, and the BIOS may never send EC_CMD_UCSI_NOTIFY.
+	 */
+	if (chipset_in_state(CHIPSET_STATE_ON))
+		hook_call_deferred(&ucsi_poll_deferred_data, 0);
+}
+DECLARE_HOOK(HOOK_INIT, ucsi_poll_init, HOOK_PRIO_DEFAULT);
+
 void ucsi_set_next_poll(uint32_t from_now_us)
 {
 	timestamp_t now = get_time();
 
 	ucsi_wait_time.val = now.val + from_now_us;
+	hook_call_deferred(&ucsi_poll_deferred_data, from_now_us);
 }
 
+static enum ec_status ucsi_notify(struct host_cmd_handler_args *args)
+{
+	ucsi_host_notify = true;
+	task_set_event(TASK_ID_CYPD, CCG_EVT_UCSI_POLL);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_UCSI_NOTIFY, ucsi_notify, EC_VER_MASK(0));
+
+static void ucsi_notify_reset(void)
+{
+	/* The next firmware or OS may not notify us, poll until it does */
+	ucsi_host_notify = false;
+	hook_call_deferred(&ucsi_poll_deferred_data, 0);
+}
+DECLARE_HOOK(HOOK_CHIPSET_RESET, ucsi_notify_reset, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_CHIPSET_SHUTDOWN, ucsi_notify_reset, HOOK_PRIO_DEFAULT);
+
 const char *command_names(uint8_t command)
 {
 	static const char *response_codes[0x14] = {
@@ -89,6 +166,46 @@ const char *command_names(uint8_t command)
 	return "";
 }
 
+/*
+ * Write a command to a PD chip. MESSAGE_OUT has to be in place before
+ * CONTROL is written, as that starts the command, but only the data
+ * length given in CONTROL is used: most commands carry no data and need
+ * a single write.
+ */
+static int ucsi_write_command(int controller, uint8_t *command,
+			      uint8_t *message_out)
+{
+	int len = MIN(command[1], 16);
+	int rv;
+
+	if (len) {
+		rv = cypd_write_reg_block(controller, CCG_MESSAGE_OUT_REG,
+					  message_out, len);
+		if (rv != EC_SUCCESS)
+			return rv;
+	}
+
+	return cypd_write_reg_block(controller, CCG_CONTROL_REG, command, 8);
+}
+
+static void ucsi_record_latency(void)
+{
+	uint32_t latency;
+	int i;
+
+	if (ucsi_pending_command >= UCSI_COMMAND_COUNT)
+		return;
+
+	latency = get_time().val - ucsi_command_time.val;
+	for (i = 0; i < UCSI_LATENCY_BUCKETS - 1; i++) {
+		if (latency < (UCSI_LATENCY_BUCKET_MIN << i))
+			break;
+	}
+	if (ucsi_latency_hist[ucsi_pending_command][i] < UINT16_MAX)
+		ucsi_latency_hist[ucsi_pending_command][i]++;
+	ucsi_pending_command = UCSI_COMMAND_COUNT;
+}
+
 int ucsi_write_tunnel(void)
 {
 	uint8_t *message_out = host_get_memmap(EC_CUSTOMIZED_MEMMAP_UCSI_MESSAGE_OUT);
@@ -156,8 +273,7 @@ int ucsi_write_tunnel(void)
 			i = 0;
 
 		pd_chip_ucsi_info[i].wait_ack = 1;
-		rv = cypd_write_reg_block(i, CCG_MESSAGE_OUT_REG, message_out, 16);
-		rv = cypd_write_reg_block(i, CCG_CONTROL_REG, command, 8);
+		rv = ucsi_write_command(i, command, message_out);
 		break;
 	default:
 		for (i = 0; i < PD_CHIP_COUNT; i++) {
@@ -173,11 +289,7 @@ int ucsi_write_tunnel(void)
 				continue;
 			}
 
-			rv = cypd_write_reg_block(i, CCG_MESSAGE_OUT_REG, message_out, 16);
-			if (rv != EC_SUCCESS)
-				break;
-
-			rv = cypd_write_reg_block(i, CCG_CONTROL_REG, command, 8);
+			rv = ucsi_write_command(i, command, message_out);
 			if (rv != EC_SUCCESS)
 				break;
 
@@ -193,6 +305,11 @@ int ucsi_write_tunnel(void)
 		break;
 	}
 
+	if (rv == EC_SUCCESS) {
+		ucsi_pending_command = *command;
+		ucsi_command_time = get_time();
+	}
+
 	if (ucsi_debug_enable) {
 		CPRINTS("UCSI Write P:%d Cmd 0x%016llx %s",
 			change_connector_indicator,
@@ -265,6 +382,7 @@ static void resend_ucsi_connector_change_event(void)
 
 			pd_chip_ucsi_info[(process_port - 1) >> 1].read_tunnel_complete = 1;
 			read_complete = 1;
+			task_set_event(TASK_ID_CYPD, CCG_EVT_UCSI_POLL);
 
 			s0ix_connector_change_indicator &= ~BIT(process_port);
 		}
@@ -276,6 +394,7 @@ DECLARE_HOOK(HOOK_CHIPSET_RESUME, resend_ucsi_connector_change_event, HOOK_PRIO_
 
 int ucsi_read_tunnel(int controller)
 {
+	struct ucsi_read_block block;
 	int rv;
 
 	if (ucsi_debug_enable && pd_chip_ucsi_info[controller].read_tunnel_complete == 1 &&
@@ -283,11 +402,12 @@ int ucsi_read_tunnel(int controller)
 		CPRINTS("UCSI Read tunnel but previous read still pending");
 	}
 
-	rv = cypd_read_reg_block(controller, CCG_CCI_REG,
-		&pd_chip_ucsi_info[controller].cci, 4);
-
-	if (rv != EC_SUCCESS)
+	rv = cypd_read_reg_block(controller, CCG_CCI_REG, &block, sizeof(block));
+	if (rv != EC_SUCCESS) {
 		CPRINTS("CCI_REG failed");
+		return rv;
+	}
+	pd_chip_ucsi_info[controller].cci = block.cci;
 	/* we need to offset the pd connector number to correct number */
 	if (controller == 1 && (pd_chip_ucsi_info[controller].cci & 0xFE))
 		/*
@@ -297,13 +417,10 @@ int ucsi_read_tunnel(int controller)
 		 */
 		pd_chip_ucsi_info[controller].cci += 0x04;
 
-	/* If data length is non zero, then get data */
+	/* If data length is non zero, then keep data */
 	if (pd_chip_ucsi_info[controller].cci & 0xFF00) {
-		rv = cypd_read_reg_block(controller, CCG_MESSAGE_IN_REG,
-			pd_chip_ucsi_info[controller].message_in, 16);
-
-		if (rv != EC_SUCCESS)
-			CPRINTS("MESSAGE_IN_REG failed");
+		memcpy(pd_chip_ucsi_info[controller].message_in,
+		       block.message_in, 16);
 	} else {
 		memset(pd_chip_ucsi_info[controller].message_in, 0, 16);
 	}
@@ -418,7 +535,8 @@ int ucsi_startup(int controller)
 
 /**
  * Suggested by bios team, we don't use host command frequenctly.
- * So we need to polling the flags to get the ucsi event form host.
+ * So the host writes the UCSI command to the memmap and sets UCSI_EVENT,
+ * then wakes us with EC_CMD_UCSI_NOTIFY, or we poll the flag in S0.
  */
 
 void check_ucsi_event_from_host(void)
@@ -440,6 +558,10 @@ void check_ucsi_event_from_host(void)
 	for (i = 0; i < PD_CHIP_COUNT; i++) {
 		if (pd_chip_ucsi_info[i].cci & CCI_BUSY_FLAG) {
 			ucsi_read_tunnel(i);
+			/* Look again until the busy bit clears */
+			if ((pd_chip_ucsi_info[i].cci & CCI_BUSY_FLAG) &&
+			    chipset_in_state(CHIPSET_STATE_ON))
+				ucsi_set_next_poll(10*MSEC);
 		}
 	}
 
@@ -524,7 +646,47 @@ void check_ucsi_event_from_host(void)
 		if (0 == (*cci & CCI_BUSY_FLAG)) {
 			if (!(*host_get_memmap(EC_CUSTOMIZED_MEMMAP_SYSTEM_FLAGS) & UCSI_EVENT))
 				*host_get_memmap(EC_CUSTOMIZED_MEMMAP_UCSI_COMMAND) = 0;
+
+			/* The command is done, take the next one right away */
+			ucsi_record_latency();
+			ucsi_wait_time.val = 0;
 		}
 		host_set_single_event(EC_HOST_EVENT_UCSI);
 	}
 }
+
+static int cmd_ucsi_stats(int argc, const char **argv)
+{
+	int i, j;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "reset"))
+			return EC_ERROR_PARAM1;
+		memset(ucsi_latency_hist, 0, sizeof(ucsi_latency_hist));
+		return EC_SUCCESS;
+	}
+
+	ccprintf("%-26s", "Round trip, us <");
+	for (i = 0; i < UCSI_LATENCY_BUCKETS - 1; i++)
+		ccprintf("%7d", UCSI_LATENCY_BUCKET_MIN << i);
+	ccprintf("   more\n");
+
+	for (i = 0; i < UCSI_COMMAND_COUNT; i++) {
+		for (j = 0; j < UCSI_LATENCY_BUCKETS; j++) {
+			if (ucsi_latency_hist[i][j])
+				break;
+		}
+		if (j == UCSI_LATENCY_BUCKETS)
+			continue;
+
+		ccprintf("%-26s", command_names(i));
+		for (j = 0; j < UCSI_LATENCY_BUCKETS; j++)
+			ccprintf("%7d", ucsi_latency_hist[i][j]);
+		ccprintf("\n");
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(ucsistats, cmd_ucsi_stats, "[reset]",
+			"Show UCSI command round trip latency histograms");
@@ -703,6 +703,11 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_TEMP_SENSOR
 #endif
 
+#undef CONFIG_BIQUAD_BANK
+#ifdef CONFIG_PLATFORM_EC_BIQUAD_BANK
+#define CONFIG_BIQUAD_BANK
+#endif
+
 #undef CONFIG_TEMP_SENSOR_POWER
 #ifdef CONFIG_PLATFORM_EC_TEMP_SENSOR_POWER
 #define CONFIG_TEMP_SENSOR_POWER
@@ -748,6 +753,11 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_CUSTOM_FAN_CONTROL
 #endif
 
+#undef CONFIG_FAN_PI
+#ifdef CONFIG_PLATFORM_EC_FAN_PI
+#define CONFIG_FAN_PI
+#endif
+
 #undef CONFIG_FAN_RPM_CUSTOM
 #ifdef CONFIG_PLATFORM_EC_FAN_RPM_CUSTOM
 #define CONFIG_FAN_RPM_CUSTOM
@@ -769,6 +779,15 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_I2C_DEBUG_PASSTHRU
 #endif
 
+#undef CONFIG_I2C_STATS
+#undef CONFIG_I2C_STATS_ENTRIES
+#undef CONFIG_I2C_STATS_WINDOW_MS
+#ifdef CONFIG_PLATFORM_EC_I2C_STATS
+#define CONFIG_I2C_STATS
+#define CONFIG_I2C_STATS_ENTRIES CONFIG_PLATFORM_EC_I2C_STATS_ENTRIES
+#define CONFIG_I2C_STATS_WINDOW_MS CONFIG_PLATFORM_EC_I2C_STATS_WINDOW_MS
+#endif
+
 #undef CONFIG_SMBUS_PEC
 #ifdef CONFIG_PLATFORM_EC_SMBUS_PEC
 #define CONFIG_SMBUS_PEC
@@ -779,6 +798,13 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_I2C_NACK_RETRY_COUNT CONFIG_PLATFORM_EC_I2C_NACK_RETRY_COUNT
 #endif
 
+#undef CONFIG_I2C_ASYNC
+#undef CONFIG_I2C_ASYNC_COALESCE_MAX
+#ifdef CONFIG_PLATFORM_EC_I2C_ASYNC
+#define CONFIG_I2C_ASYNC
+#define CONFIG_I2C_ASYNC_COALESCE_MAX CONFIG_PLATFORM_EC_I2C_ASYNC_COALESCE_MAX
+#endif
+
 #undef CONFIG_KEYBOARD_PROTOCOL_8042
 #ifdef CONFIG_PLATFORM_EC_KEYBOARD_PROTOCOL_8042
 #define CONFIG_KEYBOARD_PROTOCOL_8042
@@ -912,6 +938,19 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_KEYBOARD_STRICT_DEBOUNCE
 #endif
 
+#undef CONFIG_KEYBOARD_SCAN_IDLE_SKIP
+#ifdef CONFIG_PLATFORM_EC_KEYBOARD_SCAN_IDLE_SKIP
+#define CONFIG_KEYBOARD_SCAN_IDLE_SKIP
+#endif
+
+#undef CONFIG_KEYBOARD_LATENCY
+#undef CONFIG_KEYBOARD_LATENCY_SAMPLES
+#ifdef CONFIG_PLATFORM_EC_KEYBOARD_LATENCY
+#define CONFIG_KEYBOARD_LATENCY
+#define CONFIG_KEYBOARD_LATENCY_SAMPLES \
+	CONFIG_PLATFORM_EC_KEYBOARD_LATENCY_SAMPLES
+#endif
+
 #undef CONFIG_KEYBOARD_SCANCODE_CALLBACK
 #ifdef CONFIG_PLATFORM_KEYBOARD_SCANCODE_CALLBACK
 #define CONFIG_KEYBOARD_SCANCODE_CALLBACK
@@ -2238,10 +2277,14 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #undef CONFIG_ACCEL_FIFO
 #undef CONFIG_ACCEL_FIFO_SIZE
 #undef CONFIG_ACCEL_FIFO_THRES
+#undef CONFIG_ACCEL_FIFO_PACKED
 #ifdef CONFIG_PLATFORM_EC_ACCEL_FIFO
 #define CONFIG_ACCEL_FIFO
 #define CONFIG_ACCEL_FIFO_SIZE CONFIG_PLATFORM_EC_ACCEL_FIFO_SIZE
 #define CONFIG_ACCEL_FIFO_THRES CONFIG_PLATFORM_EC_ACCEL_FIFO_THRES
+#ifdef CONFIG_PLATFORM_EC_ACCEL_FIFO_PACKED
+#define CONFIG_ACCEL_FIFO_PACKED
+#endif
 #endif /* CONFIG_PLATFORM_EC_ACCEL_FIFO */
 
 #undef CONFIG_BODY_DETECTION
@@ -2578,6 +2621,12 @@ BUILD_ASSERT((DT_NUM_INST_STATUS_OKAY(maxim_max695x)) == 1,
 #define CONFIG_VBOOT_HASH
 #endif
 
+#undef CONFIG_VBOOT_HASH_BURST_US
+#if defined(CONFIG_PLATFORM_EC_VBOOT_HASH_BURST_US) && \
+	(CONFIG_PLATFORM_EC_VBOOT_HASH_BURST_US > 0)
+#define CONFIG_VBOOT_HASH_BURST_US CONFIG_PLATFORM_EC_VBOOT_HASH_BURST_US
+#endif
+
 #undef CONFIG_SHA256_HW_ACCELERATE
 #ifdef CONFIG_PLATFORM_EC_SHA256_HW_ACCELERATE
 #define CONFIG_SHA256_HW_ACCELERATE
@@ -3019,6 +3068,14 @@ BUILD_ASSERT((DT_NUM_INST_STATUS_OKAY(mps_mp2964)) == 1,
 #define CONFIG_CONSOLE_CHANNEL
 #endif
 
+#undef CONFIG_CONSOLE_BINLOG
+#undef CONFIG_CONSOLE_BINLOG_BUF_SIZE
+#ifdef CONFIG_PLATFORM_EC_CONSOLE_BINLOG
+#define CONFIG_CONSOLE_BINLOG
+#define CONFIG_CONSOLE_BINLOG_BUF_SIZE \
+	CONFIG_PLATFORM_EC_CONSOLE_BINLOG_BUF_SIZE
+#endif
+
 #undef CONFIG_USB_PD_DP_HPD_GPIO
 #ifdef CONFIG_PLATFORM_EC_USB_PD_DP_HPD_GPIO
 #define CONFIG_USB_PD_DP_HPD_GPIO
@@ -3065,6 +3122,26 @@ BUILD_ASSERT((DT_NUM_INST_STATUS_OKAY(mps_mp2964)) == 1,
 #define CONFIG_HOSTCMD_DEBUG_MODE CONFIG_PLATFORM_EC_HOSTCMD_DEBUG_MODE
 #endif
 
+#undef CONFIG_HOSTCMD_LOOKUP_HASH
+#undef CONFIG_HOSTCMD_LOOKUP_HASH_SLOTS
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD_LOOKUP_HASH
+#define CONFIG_HOSTCMD_LOOKUP_HASH
+#define CONFIG_HOSTCMD_LOOKUP_HASH_SLOTS \
+	CONFIG_PLATFORM_EC_HOSTCMD_LOOKUP_HASH_SLOTS
+#endif
+
+#undef CONFIG_HOSTCMD_LATENCY
+#undef CONFIG_HOSTCMD_LATENCY_SLOTS
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD_LATENCY
+#define CONFIG_HOSTCMD_LATENCY
+#define CONFIG_HOSTCMD_LATENCY_SLOTS CONFIG_PLATFORM_EC_HOSTCMD_LATENCY_SLOTS
+#endif
+
+#undef CONFIG_HOSTCMD_BATCH
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD_BATCH
+#define CONFIG_HOSTCMD_BATCH
+#endif
+
 #undef CONFIG_AMD_SB_RMI
 #ifdef CONFIG_PLATFORM_EC_AMD_SB_RMI
 #define CONFIG_AMD_SB_RMI
@@ -45,6 +45,17 @@ k_tid_t get_hostcmd_thread(void);
 		.handler = _routine,                                    \
 		.version_mask = _version_mask,                          \
 	}
+
+/**
+ * See include/host_command.h for documentation.
+ */
+#define DECLARE_PRIVATE_HOST_COMMAND(_command, _routine, _version_mask) \
+	static const STRUCT_SECTION_ITERABLE(host_command,                \
+					     _cros_hcmd_##_command) = {   \
+		.command = EC_PRIVATE_HOST_COMMAND_VALUE(_command),       \
+		.handler = _routine,                                      \
+		.version_mask = _version_mask,                            \
+	}
 #else /* !CONFIG_PLATFORM_EC_HOSTCMD */
 
 /*
@@ -54,4 +65,7 @@ k_tid_t get_hostcmd_thread(void);
 #define DECLARE_HOST_COMMAND(command, routine, version_mask) \
 	int __remove_##command = ((int)(routine))
 
+#define DECLARE_PRIVATE_HOST_COMMAND(command, routine, version_mask) \
+	int __remove_##command = ((int)(routine))
+
 #endif /* CONFIG_PLATFORM_EC_HOSTCMD */
@@ -471,6 +471,14 @@ int cprints(enum console_channel channel, const char *format, ...)
 	if (console_channel_is_disabled(channel))
 		return EC_SUCCESS;
 
+#ifdef CONFIG_CONSOLE_BINLOG
+	va_start(args, format);
+	rv = console_binlog_vprints(channel, format, args);
+	va_end(args);
+	if (rv == EC_SUCCESS)
+		return rv;
+#endif
+
 	buff[0] = '[';
 	len = 1;
 
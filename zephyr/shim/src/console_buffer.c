@@ -15,6 +15,8 @@ static uint32_t current_snapshot_idx;
 static uint32_t read_next_idx;
 static uint32_t head_idx;
 static uint32_t tail_idx;
+/* Bytes stored in console_buf since boot, wrapping */
+static uint32_t written;
 
 static inline uint32_t next_idx(uint32_t cur_idx)
 {
@@ -56,6 +58,7 @@ size_t console_buf_notify_chars(const char *s, size_t len)
 
 		console_buf[tail_idx] = *s++;
 		tail_idx = new_tail;
+		written++;
 	}
 	k_mutex_unlock(&console_write_lock);
 	return len;
@@ -141,6 +144,63 @@ int uart_console_read_buffer(uint8_t type, char *dest, uint16_t dest_size,
 	return EC_RES_SUCCESS;
 }
 
+/* Offset of the oldest byte in console_buf, with the mutex held */
+static uint32_t oldest_offset(void)
+{
+	return written - (tail_idx + ARRAY_SIZE(console_buf) - head_idx) %
+				 ARRAY_SIZE(console_buf);
+}
+
+uint32_t uart_console_stream_oldest(void)
+{
+	uint32_t oldest;
+
+	if (k_mutex_lock(&console_write_lock, K_MSEC(100)))
+		return written;
+	oldest = oldest_offset();
+	k_mutex_unlock(&console_write_lock);
+
+	return oldest;
+}
+
+enum ec_status uart_console_read_stream(uint32_t *offset, uint32_t *lost,
+					char *dest, uint16_t dest_size,
+					uint16_t *write_count)
+{
+	uint32_t oldest, idx;
+	uint16_t count = 0;
+
+	if (k_mutex_lock(&console_write_lock, K_MSEC(100)))
+		/* Failed to acquire console buffer mutex */
+		return EC_RES_TIMEOUT;
+
+	/* Offset from before a reboot, the caller has to start over */
+	if ((int32_t)(*offset - written) > 0) {
+		k_mutex_unlock(&console_write_lock);
+		return EC_RES_INVALID_PARAM;
+	}
+
+	oldest = oldest_offset();
+	*lost = 0;
+	if ((int32_t)(*offset - oldest) < 0) {
+		*lost = oldest - *offset;
+		*offset = oldest;
+	}
+
+	/* Copy straight from the circular buffer */
+	idx = (head_idx + (*offset - oldest)) % ARRAY_SIZE(console_buf);
+	while (*offset != written && count < dest_size) {
+		dest[count++] = console_buf[idx];
+		idx = next_idx(idx);
+		(*offset)++;
+	}
+	*write_count = count;
+
+	k_mutex_unlock(&console_write_lock);
+
+	return EC_RES_SUCCESS;
+}
+
 /* ECOS uart buffer, putc is blocking instead. */
 int uart_buffer_full(void)
 {
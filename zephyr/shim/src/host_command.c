@@ -20,6 +20,16 @@ struct host_command *zephyr_find_host_command(int command)
 	return NULL;
 }
 
+const struct host_command *zephyr_get_host_commands(int *count)
+{
+	struct host_command *first;
+
+	STRUCT_SECTION_COUNT(host_command, count);
+	STRUCT_SECTION_GET(host_command, 0, &first);
+
+	return first;
+}
+
 void host_command_main(void)
 {
 	k_thread_priority_set(get_main_thread(),
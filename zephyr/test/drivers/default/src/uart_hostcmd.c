@@ -221,5 +221,50 @@ ZTEST_USER(uart_hostcmd, test_uart_hc_read_recent_v1)
 			  response);
 }
 
+ZTEST_USER(uart_hostcmd, test_uart_hc_stream)
+{
+	uint8_t response[sizeof(struct ec_response_console_stream) +
+			 CONFIG_PLATFORM_EC_HOSTCMD_CONSOLE_BUF_SIZE]
+		__aligned(4);
+	struct ec_response_console_stream *r = (void *)response;
+	struct ec_params_console_stream params = {
+		.flags = EC_CONSOLE_STREAM_OLDEST,
+	};
+	struct host_cmd_handler_args args = BUILD_HOST_COMMAND(
+		EC_PRIVATE_HOST_COMMAND_VALUE(EC_CMD_CONSOLE_STREAM), 0,
+		response, params);
+	char *msg2_start;
+
+	/* The whole buffer ends with messages 1 and 2, no snapshot needed */
+	zassert_equal(EC_RES_SUCCESS, host_command_process(&args));
+	zassert_equal(0, r->lost);
+	zassert_true(r->size >= MSG_LEN(msg1) + MSG_LEN(msg2));
+	msg2_start = r->data + r->size - MSG_LEN(msg2);
+	zassert_mem_equal(msg2, msg2_start, MSG_LEN(msg2),
+			  "expected \"%s\", got \"%.*s\"", msg2, MSG_LEN(msg2),
+			  msg2_start);
+	zassert_mem_equal(msg1, msg2_start - MSG_LEN(msg1), MSG_LEN(msg1));
+
+	/* Continuing from the returned offset gets only the new output */
+	cputs(CC_COMMAND, msg3);
+	params.flags = 0;
+	params.offset = r->next_offset;
+	zassert_equal(EC_RES_SUCCESS, host_command_process(&args));
+	zassert_equal(MSG_LEN(msg3), r->size,
+		      "expected message length %d, got %d", MSG_LEN(msg3),
+		      r->size);
+	zassert_mem_equal(msg3, r->data, MSG_LEN(msg3));
+	zassert_equal(params.offset + MSG_LEN(msg3), r->next_offset);
+
+	/* Then nothing */
+	params.offset = r->next_offset;
+	zassert_equal(EC_RES_SUCCESS, host_command_process(&args));
+	zassert_equal(0, r->size);
+
+	/* Offsets ahead of the output are rejected */
+	params.offset += 1;
+	zassert_equal(EC_RES_INVALID_PARAM, host_command_process(&args));
+}
+
 ZTEST_SUITE(uart_hostcmd, drivers_predicate_post_main, NULL,
 	    setup_snapshots_and_messages, NULL, NULL);